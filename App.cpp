@@ -26,17 +26,29 @@
 #include "App.h"
 
 #include "FileManager.h"
+#include "GLState.h"
 #include "KeyInput.h"
 #include "MouseInput.h"
+#include "Profiler.h"
+#include "RenderThread.h"
 #include "Renderer.h"
+#include "TraceLog.h"
+#include "exceptions.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
 #include <plog/Log.h>
+#include <sstream>
 #include <thread>
 
 namespace SGEng {
 
-App::App(Context &ctx, bool initialize) : ctx(ctx), window(ctx) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "App constructor...";
+App::App(Context &ctx, bool initialize)
+    : ctx(ctx), window(ctx), modelLoader(ctx, window),
+      frameStatistics(ctx.cfg.frameStatsWindow) {
+  SGENG_TRACE(Lifetime) << "App constructor...";
   ctx.app = this;
   if (!ctx.isGLFWInitialized)
     ctx.setup();
@@ -45,7 +57,10 @@ App::App(Context &ctx, bool initialize) : ctx(ctx), window(ctx) {
 }
 
 App::~App() {
-  PLOGV_IF(LOG_DESTRUCTORS) << "App destructor...";
+  SGENG_TRACE(Lifetime) << "App destructor...";
+  // Nothing is left to release when destroy() has been called
+  window.stopRenderThread();
+  modelLoader.destroy();
   ctx.get().app = nullptr;
 }
 
@@ -61,10 +76,12 @@ void App::initialize() {
   if (!ctx.isGLFWInitialized)
     ctx.setup();
   window.initialize();
-  if (!ctx.areKeyInputsInitialized)
-    KeyInput::setup(ctx, window.getRawWindow());
-  if (!ctx.areMouseInputsInitialized)
-    MouseInput::setup(ctx, window.getRawWindow());
+  if (!window.isHeadless()) {
+    if (!ctx.areKeyInputsInitialized)
+      KeyInput::setup(ctx, window.getRawWindow());
+    if (!ctx.areMouseInputsInitialized)
+      MouseInput::setup(ctx, window.getRawWindow());
+  }
 
   _isInitialized = true;
   PLOGV << "App initialized";
@@ -73,45 +90,208 @@ void App::initialize() {
 bool App::isInitialized() const { return _isInitialized; }
 
 void App::destroy() {
+  writeFrameStatsSummary();
+  writeTraceText();
   onDestroy();
+  // Pending loads own meshes with buffers, which are deleted on this thread
+  // once it holds the context again
+  window.stopRenderThread();
+  modelLoader.destroy();
   PLOGV << "App destroyed";
 }
 
 void App::run() {
+  if (window.isHeadless()) {
+    runHeadless();
+    return;
+  }
+
+  Profiler::get().setThreadName("Events");
   std::jthread thr = std::jthread([this] { this->mainLoop(); });
 
   while (window.isActive()) {
     window.waitEvents();
-    window.update();
+    window.processEventThreadCommands();
   }
 }
 
 void App::performFrame(bool poll) {
+  ProfileScope profileScope("App::performFrame");
   _lastTimestamp = _currentTimestamp;
-  _currentTimestamp = glfwGetTime();
+  _currentTimestamp = getTime();
   _frameCount++;
+  double td = _currentTimestamp - _lastTimestamp;
+  frameStatistics.addFrame(td * 1000.0);
+
+  processInputEvents();
+  window.processGameThreadCommands();
+  modelLoader.update();
 
   if (_currentTimestamp - _countResetTimestamp > 1.0) {
-    PLOGD_IF(LOG_FPS) << "FPS: " << _frameCount;
-    if (ctx.get().cfg.showFPS)
-      window.setNeedsToChangeTitle(ctx.get().cfg.windowTitle + " - " +
-                                   std::to_string(_frameCount));
+    PLOGD << "FPS: " << _frameCount;
+    const FrameTimeSummary &frameStats = frameStatistics.update();
+    PLOGD << "Frame time: " << frameStats.min << " ms min, " << frameStats.mean
+          << " ms average, " << frameStats.p50 << " ms p50, " << frameStats.p95
+          << " ms p95, " << frameStats.p99 << " ms p99, " << frameStats.max
+          << " ms max, " << frameStats.hitchCount << " hitches";
+    const auto &glStats = GLState::current().getStats();
+    SGENG_TRACE(GLState) << "GL state calls issued: " << glStats.issuedCalls
+                         << ", skipped: " << glStats.skippedCalls;
+    GLState::current().resetStats();
+    const auto &pacerStats = framePacer.getFrameTimeStats();
+    if (pacerStats.frameCount > 0) {
+      PLOGD << "Paced frame time deviation: " << std::sqrt(pacerStats.variance)
+            << " ms";
+    }
+    framePacer.resetFrameTimeStats();
+    if (inputLatencyStats.eventCount > 0) {
+      PLOGD << "Input latency: " << inputLatencyStats.mean << " ms average, "
+            << inputLatencyStats.max << " ms max";
+    }
+    inputLatencyStats = {};
+    if (RenderThread *renderThread = window.getRenderThread()) {
+      FrameLatencyStats latency = renderThread->takeLatencyStats();
+      if (latency.frameCount > 0) {
+        PLOGD << "Frame latency: " << latency.mean << " ms average, "
+              << latency.max << " ms max";
+      }
+    }
+    if (ctx.get().cfg.showFPS) {
+      std::ostringstream title;
+      title << ctx.get().cfg.windowTitle << " - " << _frameCount << " FPS, "
+            << std::fixed << std::setprecision(1) << frameStats.mean
+            << " ms avg, " << frameStats.p99 << " ms p99, " << frameStats.max
+            << " ms max, " << frameStats.hitchCount << " hitches";
+      window.requestTitle(title.str());
+    }
     _countResetTimestamp += 1.0;
     _frameCount = 0;
   }
 
-  if (window.getRenderer())
-    window.getRenderer()->update();
+  bool doDraw{false};
+  {
+    ProfileScope updateScope("App::update");
+    doDraw = update(_currentTimestamp, td);
+  }
+  if (doDraw) [[likely]] {
+    double alpha = ctx.get().cfg.fixedTimestep ? runFixedUpdates(td) : 1.0;
+    ProfileScope drawScope("App::draw");
+    draw(alpha);
+  }
+
+  // Headless runs measure how fast frames can be rendered, so they are never
+  // paced
+  if (!window.isHeadless())
+    framePacer.endFrame();
+}
+
+// Applies the input events received since the previous frame in the order
+// they happened, so that the state seen by update() depends only on them and
+// not on when the event thread ran
+void App::processInputEvents() {
+  Context &ctx = this->ctx.get();
+  for (auto keyInput : ctx.keyInputs)
+    keyInput->beginFrame();
+  for (auto mouseInput : ctx.mouseInputs)
+    mouseInput->beginFrame();
+
+  InputEvent event;
+  while (ctx.inputEvents.pop(event)) {
+    switch (event.type) {
+    case InputEventType::Key:
+      for (auto keyInput : ctx.keyInputs)
+        keyInput->setKeyState(event.code, event.isDown);
+      break;
+    case InputEventType::MouseButton:
+      for (auto mouseInput : ctx.mouseInputs)
+        mouseInput->setButtonState(event.code, event.isDown);
+      break;
+    }
+
+    // Events received after the frame started are processed with it
+    double latency =
+        std::max(_currentTimestamp - event.timestamp, 0.0) * 1000.0;
+    inputLatencyStats.eventCount++;
+    inputLatencyStats.mean += (latency - inputLatencyStats.mean) /
+                              static_cast<double>(inputLatencyStats.eventCount);
+    inputLatencyStats.max = std::max(inputLatencyStats.max, latency);
+  }
+
+  if (uint64_t dropped = ctx.inputEvents.takeDroppedCount()) {
+    PLOGW << "Input event queue full, dropped " << dropped << " events";
+  }
+}
+
+// Renders the configured number of frames on the calling thread, without
+// processing any window events
+void App::runHeadless() {
+  Profiler::get().setThreadName("Game");
+  assert(window.isInitialized());
+  window.createRenderer();
+  assert(window.getRenderer());
+
+  if (!_startupCalled) {
+    bool doContinue = onStartup();
+    _startupCalled = true;
+    if (!doContinue)
+      return;
+  }
+
+  // Models loaded asynchronously by onStartup() become resident whenever the
+  // jobs and the uploader get to them, so they are waited for before the
+  // measured frames, which would otherwise depend on job system timing
+  while (!modelLoader.isIdle() && window.isActive())
+    performFrame(false);
+
+  unsigned int frameCount = ctx.get().cfg.headlessFrameCount;
+  std::vector<double> frameTimes;
+  frameTimes.reserve(frameCount);
+  frameStatistics = FrameStatistics(ctx.get().cfg.frameStatsWindow);
+  _frameCount = 0;
+  _countResetTimestamp = getTime();
+  _currentTimestamp = _countResetTimestamp;
+
+  for (unsigned int i = 0; i < frameCount && window.isActive(); i++) {
+    auto frameStart = std::chrono::steady_clock::now();
+    performFrame(false);
+    glFinish(); // Count the GPU work of the frame too
+    std::chrono::duration<double, std::milli> frameTime =
+        std::chrono::steady_clock::now() - frameStart;
+    frameTimes.push_back(frameTime.count());
+  }
+
+  std::optional<uint64_t> readbackHash;
+  if (ctx.get().cfg.headlessReadbackHash) {
+    std::vector<uint8_t> pixels;
+    window.getOffscreenFramebuffer().readPixels(pixels);
+    uint64_t hash{14695981039346656037ull}; // FNV-1a
+    for (uint8_t byte : pixels)
+      hash = (hash ^ byte) * 1099511628211ull;
+    readbackHash = hash;
+  }
 
-  if (update(_currentTimestamp, _currentTimestamp - _lastTimestamp)) [[likely]]
-    draw();
+  writeHeadlessReport(frameTimes, readbackHash);
+  if (Profiler::get().isEnabled())
+    writeProfilerTrace();
+  destroy();
 }
 
 Window &App::getWindow() { return window; }
 
+void App::runOnRenderThread(std::function<void()> task) {
+  window.runOnRenderThread(std::move(task));
+}
+
+ModelLoadHandle App::loadModelAsync(const fs::path &path,
+                                    ModelLoader::Callback onResident,
+                                    ModelLoader::Preparation prepare) {
+  return modelLoader.load(path, std::move(onResident), std::move(prepare));
+}
+
 const Window &App::getWindow() const { return window; }
 
 void App::mainLoop() {
+  Profiler::get().setThreadName("Game");
   assert(window.isInitialized());
   assert(window.isActive());
   window.createRenderer();
@@ -124,13 +304,139 @@ void App::mainLoop() {
       return;
   }
 
-  _countResetTimestamp = glfwGetTime();
+  // The swap interval applies to the context current on this thread, so it is
+  // set before the context is handed over to the render thread
+  framePacer.initialize(ctx.get().cfg.framePacingMode,
+                        ctx.get().cfg.targetFPS);
+  if (ctx.get().cfg.pipelinedRendering)
+    window.startRenderThread(ctx.get().cfg.framesInFlight);
+  _countResetTimestamp = getTime();
+  _currentTimestamp = _countResetTimestamp;
 
   while (window.isActive()) {
     performFrame();
   }
 
+  window.stopRenderThread();
   destroy();
 }
 
+// Advances the simulation by as many fixed steps as fit into the accumulated
+// time and returns the interpolation alpha of the remainder
+double App::runFixedUpdates(double td) {
+  const Config &cfg = ctx.get().cfg;
+  double step = 1.0 / std::max(cfg.fixedUpdateRate, 1u);
+  _fixedAccumulator += td;
+
+  unsigned int steps{0};
+  while (_fixedAccumulator >= step && steps < cfg.maxFixedUpdatesPerFrame) {
+    ProfileScope profileScope("App::fixedUpdate");
+    fixedUpdate(_simulationTimestamp, step);
+    _simulationTimestamp += step;
+    _fixedAccumulator -= step;
+    steps++;
+  }
+
+  // After a long stall, catching up with every step would make the following
+  // frames even slower, so the simulation falls behind wall-clock time instead
+  if (_fixedAccumulator >= step) {
+    SGENG_TRACE(FixedUpdate)
+        << "Dropped " << static_cast<unsigned int>(_fixedAccumulator / step)
+        << " fixed updates";
+    _fixedAccumulator = std::fmod(_fixedAccumulator, step);
+  }
+  return _fixedAccumulator / step;
+}
+
+double App::getTime() const {
+  if (ctx.get().isGLFWInitialized)
+    return glfwGetTime();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - _startTime;
+  return elapsed.count();
+}
+
+const FrameTimeSummary &App::getFrameTimeSummary() const {
+  return frameStatistics.getWindowSummary();
+}
+
+FrameTimeSummary App::getTotalFrameTimeSummary() const {
+  return frameStatistics.getTotalSummary();
+}
+
+void App::writeFrameStatsSummary() {
+  const fs::path &path = ctx.get().cfg.frameStatsPath;
+  if (path.empty() || frameStatistics.getTotalSummary().frameCount == 0)
+    return;
+  // Hitches of the frames added since the last update are counted only there
+  frameStatistics.update();
+  try {
+    ctx.get().fileManager->saveTextFile(path,
+                                        frameStatistics.totalSummaryToJSON());
+    PLOGI << "Frame statistics written to " << path;
+  } catch (const FileError &err) {
+    PLOGE << err.what() << " [" << err.getPath() << "]";
+  }
+}
+
+void App::writeTraceText() {
+  TraceLog::get().flush();
+  const fs::path &path = ctx.get().cfg.traceTextPath;
+  if (path.empty() || !fs::exists(ctx.get().cfg.tracePath))
+    return;
+  try {
+    ctx.get().fileManager->saveTextFile(
+        path, TraceLog::decode(ctx.get().cfg.tracePath));
+    PLOGI << "Trace written to " << path;
+  } catch (const FileError &err) {
+    PLOGE << err.what() << " [" << err.getPath() << "]";
+  }
+}
+
+void App::writeProfilerTrace() {
+  const Config &cfg = ctx.get().cfg;
+  std::string trace =
+      Profiler::get().exportChromeTrace(cfg.profilerTraceSeconds);
+  try {
+    ctx.get().fileManager->saveTextFile(cfg.profilerTracePath, trace);
+    PLOGI << "Profiler trace written to " << cfg.profilerTracePath;
+  } catch (const FileError &err) {
+    PLOGE << err.what() << " [" << err.getPath() << "]";
+  }
+}
+
+void App::writeHeadlessReport(const std::vector<double> &frameTimes,
+                              std::optional<uint64_t> readbackHash) {
+  if (frameTimes.empty()) {
+    PLOGW << "Headless run rendered no frames";
+    return;
+  }
+
+  std::ostringstream report;
+  report << "frame,milliseconds\n";
+  for (size_t i = 0; i < frameTimes.size(); i++)
+    report << i << "," << frameTimes[i] << "\n";
+
+  auto [minIt, maxIt] =
+      std::minmax_element(frameTimes.begin(), frameTimes.end());
+  double total = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0);
+  PLOGI << "Headless run: " << frameTimes.size() << " frames, "
+        << total / static_cast<double>(frameTimes.size()) << " ms average, "
+        << *minIt << " ms min, " << *maxIt << " ms max";
+  if (readbackHash) {
+    std::ostringstream hash;
+    hash << std::hex << std::setw(16) << std::setfill('0') << *readbackHash;
+    PLOGI << "Readback hash: " << hash.str();
+    report << "# readback hash: " << hash.str() << "\n";
+  }
+
+  const fs::path &path = ctx.get().cfg.headlessReportPath;
+  try {
+    ctx.get().fileManager->saveTextFile(path, report.str());
+    PLOGI << "Frame timings written to " << path;
+  } catch (const FileError &err) {
+    PLOGE << err.what() << " [" << err.getPath() << "]";
+  }
+}
+
 } // namespace SGEng
@@ -27,7 +27,15 @@
 
 #include "Config.h"
 #include "Context.h"
+#include "FramePacer.h"
+#include "FrameStatistics.h"
+#include "ModelLoader.h"
 #include "Window.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
 
 namespace SGEng {
 
@@ -37,8 +45,15 @@ public:
   virtual ~App();
 
   virtual bool onStartup() = 0;
+  // Called once per frame with the wall-clock time and delta
   virtual bool update(double ts, double td) = 0;
-  virtual void draw() = 0;
+  // Called at the fixed rate when fixedTimestep is enabled, with the
+  // simulation time and the constant step
+  virtual void fixedUpdate(double /*ts*/, double /*td*/) {}
+  // Alpha is the fraction of a fixed step that has elapsed since the last
+  // fixedUpdate, for interpolating between the last two simulation states.
+  // Without a fixed timestep it is always 1.
+  virtual void draw(double alpha) = 0;
   virtual void onDestroy() = 0;
 
   App &withConfig(const Config &config);
@@ -46,10 +61,26 @@ public:
   bool isInitialized() const;
   void destroy();
   void run();
+  void runHeadless();
   void performFrame(bool poll = true);
 
   Window &getWindow();
   const Window &getWindow() const;
+  // Runs OpenGL work on the thread owning the context, needed by everything
+  // creating, changing or destroying GL objects with pipelined rendering
+  void runOnRenderThread(std::function<void()> task);
+  // Loads the model in the background, the callback is called on the game
+  // thread once its meshes are on the GPU and the model has been prepared on
+  // the render thread, see ModelLoader
+  ModelLoadHandle loadModelAsync(const fs::path &path,
+                                 ModelLoader::Callback onResident,
+                                 ModelLoader::Preparation prepare = {});
+  // Frame time statistics of the most recent frames, refreshed at least once
+  // per second, and of the whole run
+  const FrameTimeSummary &getFrameTimeSummary() const;
+  FrameTimeSummary getTotalFrameTimeSummary() const;
+  // Writes a Chrome trace of the recent frames, see Config::profilerEnabled
+  void writeProfilerTrace();
 
 protected:
   // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
@@ -62,9 +93,26 @@ private:
   double _countResetTimestamp{0.0};
   double _lastTimestamp{0.0};
   double _currentTimestamp{0.0};
+  double _fixedAccumulator{0.0};
+  double _simulationTimestamp{0.0};
   unsigned int _frameCount{0};
+  FramePacer framePacer;
+  ModelLoader modelLoader;
+  FrameStatistics frameStatistics;
+  InputLatencyStats inputLatencyStats;
+  std::chrono::steady_clock::time_point _startTime{
+      std::chrono::steady_clock::now()};
 
   void mainLoop();
+  void processInputEvents();
+  void writeFrameStatsSummary();
+  // Flushes the trace of the enabled categories and decodes it to text, see
+  // Config::traceCategories
+  void writeTraceText();
+  double runFixedUpdates(double td);
+  double getTime() const;
+  void writeHeadlessReport(const std::vector<double> &frameTimes,
+                           std::optional<uint64_t> readbackHash);
 };
 
 } // namespace SGEng
@@ -0,0 +1,269 @@
+//===- AsyncLogAppender.cpp -------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "AsyncLogAppender.h"
+
+#include <algorithm>
+#include <csignal>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace SGEng {
+
+namespace {
+
+constexpr size_t maxCrashFlushedAppenders{4};
+constexpr int stderrDescriptor{2};
+
+// NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
+std::array<std::atomic<AsyncLogAppender *>, maxCrashFlushedAppenders>
+    liveAppenders{};
+// Set by the first crash signal, later ones only re-raise
+std::atomic_flag isCrashHandled = ATOMIC_FLAG_INIT;
+// NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
+
+// Line written by the crash handler, which may neither allocate nor format
+// with the standard library. Severity, function, line and message are copied
+// into a buffer allocated up front and written with a single write(2) call.
+class CrashLine {
+public:
+  CrashLine &append(const char *text, size_t maxLength = capacity) {
+    for (size_t i = 0; i < maxLength && text[i] != '\0' && size < capacity;
+         i++)
+      buffer[size++] = text[i];
+    return *this;
+  }
+
+  // Wide characters outside ASCII are replaced, converting them is not
+  // async-signal-safe
+  CrashLine &append(const wchar_t *text, size_t maxLength) {
+    for (size_t i = 0; i < maxLength && text[i] != L'\0' && size < capacity;
+         i++)
+      buffer[size++] = text[i] < 0x80 ? static_cast<char>(text[i]) : '?';
+    return *this;
+  }
+
+  CrashLine &append(size_t number) {
+    std::array<char, 20> digits{};
+    size_t count{0};
+    do {
+      digits[count++] = static_cast<char>('0' + number % 10);
+      number /= 10;
+    } while (number > 0);
+    while (count > 0 && size < capacity)
+      buffer[size++] = digits[--count];
+    return *this;
+  }
+
+  void write() {
+    buffer[size++] = '\n';
+#ifdef _WIN32
+    _write(stderrDescriptor, buffer.data(), static_cast<unsigned int>(size));
+#else
+    for (size_t written{0}; written < size;) {
+      ssize_t result =
+          ::write(stderrDescriptor, buffer.data() + written, size - written);
+      if (result <= 0)
+        break;
+      written += static_cast<size_t>(result);
+    }
+#endif
+    size = 0;
+  }
+
+private:
+  static constexpr size_t capacity{AsyncLogAppender::maxMessageLength +
+                                   AsyncLogAppender::maxFunctionLength + 32};
+  std::array<char, capacity + 1> buffer{}; // With room for the line break
+  size_t size{0};
+};
+
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+CrashLine crashLine;
+
+template <typename Char, size_t Size>
+void copyTruncated(std::array<Char, Size> &destination, const Char *source) {
+  size_t length = std::char_traits<Char>::length(source);
+  size_t copied = std::min(length, Size - 1);
+  std::copy_n(source, copied, destination.begin());
+  destination[copied] = Char{0};
+  if (length > copied && copied >= 3)
+    std::fill_n(destination.begin() + copied - 3, 3, Char{'.'});
+}
+
+// Record replayed to the downstream appenders with the values captured on the
+// logging thread
+class QueuedRecord : public plog::Record {
+public:
+  QueuedRecord(plog::Severity severity, const char *function, size_t line,
+               const char *file, const void *object, int instanceId,
+               const plog::util::Time &time, unsigned int threadId,
+               const plog::util::nchar *message)
+      : plog::Record(severity, function, line, file, object, instanceId),
+        time{time}, threadId{threadId}, function{function}, message{message} {
+  }
+
+  const plog::util::Time &getTime() const override { return time; }
+  unsigned int getTid() const override { return threadId; }
+  const char *getFunc() const override { return function; }
+  const plog::util::nchar *getMessage() const override { return message; }
+
+private:
+  plog::util::Time time;
+  unsigned int threadId;
+  const char *function;
+  const plog::util::nchar *message;
+};
+
+} // namespace
+
+AsyncLogAppender::AsyncLogAppender()
+    : thread{[this](std::stop_token stopToken) { run(stopToken); }} {
+  for (auto &live : liveAppenders) {
+    AsyncLogAppender *expected{nullptr};
+    if (live.compare_exchange_strong(expected, this))
+      break;
+  }
+}
+
+AsyncLogAppender::~AsyncLogAppender() {
+  for (auto &live : liveAppenders) {
+    AsyncLogAppender *expected{this};
+    live.compare_exchange_strong(expected, nullptr);
+  }
+  thread.request_stop();
+  if (thread.joinable())
+    thread.join();
+  drain();
+}
+
+AsyncLogAppender &AsyncLogAppender::addAppender(plog::IAppender *appender) {
+  appenders.push_back(appender);
+  return *this;
+}
+
+void AsyncLogAppender::write(const plog::Record &record) {
+  Entry entry{.time = record.getTime(),
+              .severity = record.getSeverity(),
+              .threadId = record.getTid(),
+              .line = record.getLine(),
+              .file = record.getFile(),
+              .object = record.getObject(),
+              .instanceId = record.getInstanceId()};
+  copyTruncated(entry.function, record.getFunc());
+  copyTruncated(entry.message, record.getMessage());
+
+  if (!entries.push(std::move(entry))) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  // Errors are written right away, as the next thing may be a crash
+  if (record.getSeverity() <= plog::error) {
+    isWakeRequested.store(true, std::memory_order_release);
+    wakeCondition.notify_one();
+  }
+}
+
+void AsyncLogAppender::flush() { drain(); }
+
+uint64_t AsyncLogAppender::takeDroppedCount() {
+  return droppedCount.exchange(0, std::memory_order_relaxed);
+}
+
+void AsyncLogAppender::installCrashHandlers() {
+  for (int signal : {SIGSEGV, SIGILL, SIGFPE, SIGABRT})
+    std::signal(signal, handleCrashSignal);
+}
+
+void AsyncLogAppender::run(std::stop_token stopToken) {
+  while (!stopToken.stop_requested()) {
+    drain();
+    std::unique_lock lock(wakeMutex);
+    wakeCondition.wait_for(lock, stopToken, flushInterval, [this] {
+      return isWakeRequested.exchange(false, std::memory_order_acquire);
+    });
+  }
+}
+
+void AsyncLogAppender::drain() {
+  std::lock_guard lock(drainMutex);
+
+  Entry entry;
+  while (entries.pop(entry)) {
+    QueuedRecord record(entry.severity, entry.function.data(), entry.line,
+                        entry.file, entry.object, entry.instanceId,
+                        entry.time, entry.threadId, entry.message.data());
+    for (plog::IAppender *appender : appenders)
+      appender->write(record);
+  }
+
+  unreportedDroppedCount += takeDroppedCount();
+  if (unreportedDroppedCount > 0) {
+    plog::util::nostringstream message;
+    message << unreportedDroppedCount
+            << PLOG_NSTR(" log records dropped, the queue was full");
+    plog::util::nstring text = message.str();
+    plog::util::Time time{};
+    plog::util::ftime(&time);
+    QueuedRecord record(plog::warning, "AsyncLogAppender", 0, __FILE__,
+                        nullptr, 0, time, plog::util::gettid(), text.c_str());
+    for (plog::IAppender *appender : appenders)
+      appender->write(record);
+    unreportedDroppedCount = 0;
+  }
+}
+
+void AsyncLogAppender::writePendingOnCrash() const {
+  entries.forEachPending([](const Entry &entry) {
+    crashLine.append(plog::severityToString(entry.severity))
+        .append(" [")
+        .append(entry.function.data(), maxFunctionLength)
+        .append("@")
+        .append(entry.line)
+        .append("] ")
+        .append(entry.message.data(), maxMessageLength)
+        .write();
+  });
+}
+
+void AsyncLogAppender::handleCrashSignal(int signal) {
+  // Draining would run the downstream formatters, which allocate and lock, so
+  // only the records still queued are written, as they are
+  if (!isCrashHandled.test_and_set()) {
+    for (auto &live : liveAppenders) {
+      if (AsyncLogAppender *appender = live.load(std::memory_order_acquire))
+        appender->writePendingOnCrash();
+    }
+  }
+  std::signal(signal, SIG_DFL);
+  std::raise(signal);
+}
+
+} // namespace SGEng
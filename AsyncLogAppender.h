@@ -0,0 +1,117 @@
+//===- AsyncLogAppender.h ---------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "MPSCQueue.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <plog/Appenders/IAppender.h>
+#include <plog/Record.h>
+#include <plog/Util.h>
+#include <thread>
+#include <vector>
+
+namespace SGEng {
+
+// plog appender that moves formatting and writing out of the logging thread.
+// write() copies the record into a fixed-size entry of a bounded lock-free
+// queue and returns; a background thread formats the entries and passes them
+// to the appenders added with addAppender(). When the queue is full, records
+// are dropped and counted, and the number of dropped records is reported by
+// the background thread once there is room again.
+//
+// Pending records are written when the appender is destroyed and on flush().
+// Once installCrashHandlers() has been called, crash signals write them to
+// stderr as they were queued, without the downstream formatters.
+class AsyncLogAppender : public plog::IAppender {
+public:
+  static constexpr size_t capacity{1024};
+  // Longer messages are truncated, which bounds the queue to about capacity
+  // times maxMessageLength characters
+  static constexpr size_t maxMessageLength{512};
+  static constexpr size_t maxFunctionLength{64};
+  static constexpr std::chrono::milliseconds flushInterval{10};
+
+  AsyncLogAppender();
+  AsyncLogAppender(const AsyncLogAppender &appender) = delete;
+  AsyncLogAppender &operator=(const AsyncLogAppender &appender) = delete;
+  ~AsyncLogAppender() override;
+
+  // Not thread safe, appenders have to be added before logging starts
+  AsyncLogAppender &addAppender(plog::IAppender *appender);
+
+  // May be called from any thread
+  void write(const plog::Record &record) override;
+  // Writes the pending records on the calling thread
+  void flush();
+  // Returns the number of records dropped since the last call
+  uint64_t takeDroppedCount();
+
+  // Writes the pending records of every live appender on SIGSEGV, SIGILL,
+  // SIGFPE and SIGABRT (which also covers std::terminate) before the default
+  // handler runs
+  static void installCrashHandlers();
+
+private:
+  struct Entry {
+    plog::util::Time time{};
+    plog::Severity severity{plog::none};
+    unsigned int threadId{0};
+    size_t line{0};
+    const char *file{nullptr};
+    const void *object{nullptr};
+    int instanceId{0};
+    std::array<char, maxFunctionLength> function{};
+    std::array<plog::util::nchar, maxMessageLength> message{};
+  };
+
+  MPSCQueue<Entry, capacity> entries;
+  std::atomic<uint64_t> droppedCount{0};
+  uint64_t unreportedDroppedCount{0}; // Guarded by drainMutex
+  std::vector<plog::IAppender *> appenders;
+
+  // Only one thread pops entries at a time
+  std::mutex drainMutex;
+
+  std::mutex wakeMutex;
+  std::condition_variable_any wakeCondition;
+  std::atomic<bool> isWakeRequested{false};
+
+  // Declared last, so that it stops before the state above is destroyed
+  std::jthread thread;
+
+  void run(std::stop_token stopToken);
+  void drain();
+  void writePendingOnCrash() const;
+  static void handleCrashSignal(int signal);
+};
+
+} // namespace SGEng
@@ -0,0 +1,401 @@
+//===- BVH.cpp --------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "BVH.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace SGEng {
+
+BVH::NodeId BVH::insert(const AABB &aabb, size_t userIndex) {
+  NodeId leaf = allocateNode();
+  nodes[leaf].aabb = aabb.fattened(margin);
+  nodes[leaf].userIndex = userIndex;
+  nodes[leaf].height = 0;
+  insertLeaf(leaf);
+  leafCount++;
+  return leaf;
+}
+
+void BVH::remove(NodeId leaf) {
+  assert(nodes[leaf].isLeaf());
+  removeLeaf(leaf);
+  freeNode(leaf);
+  leafCount--;
+}
+
+bool BVH::update(NodeId leaf, const AABB &aabb) {
+  assert(nodes[leaf].isLeaf());
+  const AABB &fatAABB = nodes[leaf].aabb;
+  // Boxes that shrank a lot are reinserted too, so that queries do not keep
+  // returning leaves far away from their objects
+  if (fatAABB.contains(aabb) &&
+      aabb.fattened(4.f * margin).contains(fatAABB))
+    return false;
+
+  removeLeaf(leaf);
+  nodes[leaf].aabb = aabb.fattened(margin);
+  insertLeaf(leaf);
+  return true;
+}
+
+void BVH::setUserIndex(NodeId leaf, size_t userIndex) {
+  nodes[leaf].userIndex = userIndex;
+}
+
+size_t BVH::getUserIndex(NodeId leaf) const { return nodes[leaf].userIndex; }
+
+const AABB &BVH::getFatAABB(NodeId leaf) const { return nodes[leaf].aabb; }
+
+void BVH::clear() {
+  nodes.clear();
+  root = nullNode;
+  freeList = nullNode;
+  leafCount = 0;
+}
+
+size_t BVH::size() const { return leafCount; }
+
+int32_t BVH::getHeight() const {
+  return root == nullNode ? 0 : nodes[root].height;
+}
+
+void BVH::query(const AABB &aabb, std::vector<size_t> &results) const {
+  std::vector<NodeId> stack;
+  if (root != nullNode)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    const Node &node = nodes[stack.back()];
+    stack.pop_back();
+    if (!node.aabb.intersects(aabb))
+      continue;
+    if (node.isLeaf()) {
+      results.push_back(node.userIndex);
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+void BVH::query(const BoundingSphere &sphere,
+                std::vector<size_t> &results) const {
+  std::vector<NodeId> stack;
+  if (root != nullNode)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    const Node &node = nodes[stack.back()];
+    stack.pop_back();
+    if (!sphere.intersects(node.aabb))
+      continue;
+    if (node.isLeaf()) {
+      results.push_back(node.userIndex);
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+void BVH::query(const Frustum &frustum, std::vector<size_t> &results) const {
+  std::vector<NodeId> stack;
+  std::vector<NodeId> subtreeStack;
+  if (root != nullNode)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    NodeId id = stack.back();
+    stack.pop_back();
+    const Node &node = nodes[id];
+    if (!frustum.intersects(node.aabb))
+      continue;
+    if (node.isLeaf()) {
+      results.push_back(node.userIndex);
+    } else if (frustum.contains(node.aabb)) {
+      // Whole subtree is visible, no further plane tests are needed
+      collectLeaves(id, results, subtreeStack);
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+void BVH::query(const Ray &ray, std::vector<size_t> &results) const {
+  std::vector<NodeId> stack;
+  if (root != nullNode)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    const Node &node = nodes[stack.back()];
+    stack.pop_back();
+    if (!node.aabb.intersects(ray))
+      continue;
+    if (node.isLeaf()) {
+      results.push_back(node.userIndex);
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+std::optional<RayHit> BVH::raycast(const Ray &ray) const {
+  std::optional<RayHit> nearestHit;
+  std::vector<NodeId> stack;
+  if (root != nullNode)
+    stack.push_back(root);
+  while (!stack.empty()) {
+    const Node &node = nodes[stack.back()];
+    stack.pop_back();
+    auto distance = node.aabb.intersects(ray);
+    if (!distance || (nearestHit && *distance >= nearestHit->distance))
+      continue;
+    if (node.isLeaf()) {
+      nearestHit = RayHit{.userIndex = node.userIndex, .distance = *distance};
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+  return nearestHit;
+}
+
+BVH::NodeId BVH::allocateNode() {
+  if (freeList == nullNode) {
+    nodes.emplace_back();
+    return static_cast<NodeId>(nodes.size() - 1);
+  }
+  NodeId node = freeList;
+  freeList = nodes[node].parent;
+  nodes[node] = Node{};
+  return node;
+}
+
+void BVH::freeNode(NodeId node) {
+  nodes[node].parent = freeList;
+  nodes[node].height = -1;
+  freeList = node;
+}
+
+void BVH::insertLeaf(NodeId leaf) {
+  if (root == nullNode) {
+    root = leaf;
+    nodes[root].parent = nullNode;
+    return;
+  }
+
+  // Find the sibling whose pairing with the leaf increases the total surface
+  // area of the tree the least
+  AABB leafAABB = nodes[leaf].aabb;
+  NodeId index = root;
+  while (!nodes[index].isLeaf()) {
+    const Node &node = nodes[index];
+    GLfloat area = node.aabb.getSurfaceArea();
+    GLfloat combinedArea = node.aabb.merged(leafAABB).getSurfaceArea();
+    // Cost of creating a new parent for this node and the new leaf
+    GLfloat cost = 2.f * combinedArea;
+    // Minimum cost of pushing the leaf further down the tree
+    GLfloat inheritanceCost = 2.f * (combinedArea - area);
+
+    auto descendCost = [&](NodeId childId) {
+      const Node &child = nodes[childId];
+      GLfloat mergedArea = child.aabb.merged(leafAABB).getSurfaceArea();
+      if (child.isLeaf())
+        return mergedArea + inheritanceCost;
+      return mergedArea - child.aabb.getSurfaceArea() + inheritanceCost;
+    };
+    GLfloat cost1 = descendCost(node.child1);
+    GLfloat cost2 = descendCost(node.child2);
+
+    if (cost < cost1 && cost < cost2)
+      break;
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+
+  NodeId sibling = index;
+  NodeId oldParent = nodes[sibling].parent;
+  NodeId newParent = allocateNode();
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].aabb = leafAABB.merged(nodes[sibling].aabb);
+  nodes[newParent].height = nodes[sibling].height + 1;
+
+  if (oldParent != nullNode) {
+    if (nodes[oldParent].child1 == sibling)
+      nodes[oldParent].child1 = newParent;
+    else
+      nodes[oldParent].child2 = newParent;
+  } else {
+    root = newParent;
+  }
+  nodes[newParent].child1 = sibling;
+  nodes[newParent].child2 = leaf;
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  refitAncestors(nodes[leaf].parent);
+}
+
+void BVH::removeLeaf(NodeId leaf) {
+  if (leaf == root) {
+    root = nullNode;
+    return;
+  }
+
+  NodeId parent = nodes[leaf].parent;
+  NodeId grandParent = nodes[parent].parent;
+  NodeId sibling = nodes[parent].child1 == leaf ? nodes[parent].child2
+                                                : nodes[parent].child1;
+
+  if (grandParent != nullNode) {
+    if (nodes[grandParent].child1 == parent)
+      nodes[grandParent].child1 = sibling;
+    else
+      nodes[grandParent].child2 = sibling;
+    nodes[sibling].parent = grandParent;
+    freeNode(parent);
+    refitAncestors(grandParent);
+  } else {
+    root = sibling;
+    nodes[sibling].parent = nullNode;
+    freeNode(parent);
+  }
+}
+
+// Performs a left or right rotation if node A is imbalanced and returns the
+// new root of its subtree
+BVH::NodeId BVH::balance(NodeId iA) {
+  Node &a = nodes[iA];
+  if (a.isLeaf() || a.height < 2)
+    return iA;
+
+  NodeId iB = a.child1;
+  NodeId iC = a.child2;
+  Node &b = nodes[iB];
+  Node &c = nodes[iC];
+  int32_t imbalance = c.height - b.height;
+
+  auto replaceInParent = [this, iA](NodeId parent, NodeId newChild) {
+    if (parent == nullNode)
+      root = newChild;
+    else if (nodes[parent].child1 == iA)
+      nodes[parent].child1 = newChild;
+    else
+      nodes[parent].child2 = newChild;
+  };
+
+  if (imbalance > 1) { // Rotate C up
+    NodeId iF = c.child1;
+    NodeId iG = c.child2;
+    Node &f = nodes[iF];
+    Node &g = nodes[iG];
+
+    c.child1 = iA;
+    c.parent = a.parent;
+    a.parent = iC;
+    replaceInParent(c.parent, iC);
+
+    if (f.height > g.height) {
+      c.child2 = iF;
+      a.child2 = iG;
+      g.parent = iA;
+      a.aabb = b.aabb.merged(g.aabb);
+      c.aabb = a.aabb.merged(f.aabb);
+      a.height = 1 + std::max(b.height, g.height);
+      c.height = 1 + std::max(a.height, f.height);
+    } else {
+      c.child2 = iG;
+      a.child2 = iF;
+      f.parent = iA;
+      a.aabb = b.aabb.merged(f.aabb);
+      c.aabb = a.aabb.merged(g.aabb);
+      a.height = 1 + std::max(b.height, f.height);
+      c.height = 1 + std::max(a.height, g.height);
+    }
+    return iC;
+  }
+
+  if (imbalance < -1) { // Rotate B up
+    NodeId iD = b.child1;
+    NodeId iE = b.child2;
+    Node &d = nodes[iD];
+    Node &e = nodes[iE];
+
+    b.child1 = iA;
+    b.parent = a.parent;
+    a.parent = iB;
+    replaceInParent(b.parent, iB);
+
+    if (d.height > e.height) {
+      b.child2 = iD;
+      a.child1 = iE;
+      e.parent = iA;
+      a.aabb = c.aabb.merged(e.aabb);
+      b.aabb = a.aabb.merged(d.aabb);
+      a.height = 1 + std::max(c.height, e.height);
+      b.height = 1 + std::max(a.height, d.height);
+    } else {
+      b.child2 = iE;
+      a.child1 = iD;
+      d.parent = iA;
+      a.aabb = c.aabb.merged(d.aabb);
+      b.aabb = a.aabb.merged(e.aabb);
+      a.height = 1 + std::max(c.height, d.height);
+      b.height = 1 + std::max(a.height, e.height);
+    }
+    return iB;
+  }
+
+  return iA;
+}
+
+void BVH::refitAncestors(NodeId node) {
+  while (node != nullNode) {
+    node = balance(node);
+    Node &current = nodes[node];
+    const Node &child1 = nodes[current.child1];
+    const Node &child2 = nodes[current.child2];
+    current.height = 1 + std::max(child1.height, child2.height);
+    current.aabb = child1.aabb.merged(child2.aabb);
+    node = current.parent;
+  }
+}
+
+void BVH::collectLeaves(NodeId node, std::vector<size_t> &results,
+                        std::vector<NodeId> &stack) const {
+  stack.clear();
+  stack.push_back(node);
+  while (!stack.empty()) {
+    const Node &current = nodes[stack.back()];
+    stack.pop_back();
+    if (current.isLeaf()) {
+      results.push_back(current.userIndex);
+    } else {
+      stack.push_back(current.child1);
+      stack.push_back(current.child2);
+    }
+  }
+}
+
+} // namespace SGEng
@@ -0,0 +1,97 @@
+//===- BVH.h ----------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Bounds.h"
+#include "Frustum.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace SGEng {
+
+struct RayHit {
+  size_t userIndex;
+  GLfloat distance;
+};
+
+// Dynamic bounding volume hierarchy over axis-aligned boxes. Leaves store
+// boxes enlarged by a margin, so that objects moving by small amounts do not
+// change the tree at all. New leaves are placed by the surface area heuristic
+// and the tree is kept balanced with rotations, as in Box2D's b2DynamicTree.
+class BVH {
+public:
+  using NodeId = int32_t;
+  static constexpr NodeId nullNode{-1};
+  static constexpr GLfloat margin{0.1f};
+
+  NodeId insert(const AABB &aabb, size_t userIndex);
+  void remove(NodeId leaf);
+  // Returns true if the leaf had to be reinserted
+  bool update(NodeId leaf, const AABB &aabb);
+  void setUserIndex(NodeId leaf, size_t userIndex);
+  size_t getUserIndex(NodeId leaf) const;
+  const AABB &getFatAABB(NodeId leaf) const;
+  void clear();
+  size_t size() const;
+  int32_t getHeight() const;
+
+  // Queries append user indices of leaves whose fat boxes pass the test
+  void query(const AABB &aabb, std::vector<size_t> &results) const;
+  void query(const BoundingSphere &sphere, std::vector<size_t> &results) const;
+  void query(const Frustum &frustum, std::vector<size_t> &results) const;
+  void query(const Ray &ray, std::vector<size_t> &results) const;
+  // Nearest fat box hit by the ray, leaves can refine it with exact geometry
+  std::optional<RayHit> raycast(const Ray &ray) const;
+
+private:
+  struct Node {
+    AABB aabb;
+    NodeId parent{nullNode}; // Next free node when in the free list
+    NodeId child1{nullNode};
+    NodeId child2{nullNode};
+    int32_t height{-1}; // Leaf is 0, free node is -1
+    size_t userIndex{0};
+
+    bool isLeaf() const { return child1 == nullNode; }
+  };
+
+  std::vector<Node> nodes;
+  NodeId root{nullNode};
+  NodeId freeList{nullNode};
+  size_t leafCount{0};
+
+  NodeId allocateNode();
+  void freeNode(NodeId node);
+  void insertLeaf(NodeId leaf);
+  void removeLeaf(NodeId leaf);
+  NodeId balance(NodeId a);
+  void refitAncestors(NodeId node);
+  void collectLeaves(NodeId node, std::vector<size_t> &results,
+                     std::vector<NodeId> &stack) const;
+};
+
+} // namespace SGEng
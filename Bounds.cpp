@@ -0,0 +1,152 @@
+//===- Bounds.cpp -----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "Bounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/vector_relational.hpp>
+#include <glm/vec4.hpp>
+
+namespace SGEng {
+
+vec3gl AABB::getCenter() const { return (min + max) * 0.5f; }
+
+vec3gl AABB::getExtents() const { return (max - min) * 0.5f; }
+
+// Transforms the center and projects the extents on the transformed axes,
+// which gives the tightest box around the transformed box (J. Arvo)
+AABB AABB::transformed(const mat4gl &matrix) const {
+  vec3gl center = vec3gl(matrix * vec4gl(getCenter(), 1.f));
+  vec3gl extents = getExtents();
+  mat3gl absMatrix{glm::abs(vec3gl(matrix[0])), glm::abs(vec3gl(matrix[1])),
+                   glm::abs(vec3gl(matrix[2]))};
+  vec3gl newExtents = absMatrix * extents;
+  return {.min = center - newExtents, .max = center + newExtents};
+}
+
+GLfloat AABB::getSurfaceArea() const {
+  vec3gl size = max - min;
+  return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+AABB AABB::merged(const AABB &aabb) const {
+  return {.min = glm::min(min, aabb.min), .max = glm::max(max, aabb.max)};
+}
+
+AABB AABB::fattened(GLfloat margin) const {
+  return {.min = min - vec3gl(margin), .max = max + vec3gl(margin)};
+}
+
+bool AABB::contains(const AABB &aabb) const {
+  return glm::all(glm::lessThanEqual(min, aabb.min)) &&
+         glm::all(glm::greaterThanEqual(max, aabb.max));
+}
+
+bool AABB::intersects(const AABB &aabb) const {
+  return glm::all(glm::lessThanEqual(min, aabb.max)) &&
+         glm::all(glm::greaterThanEqual(max, aabb.min));
+}
+
+// Slab test, division by a zero direction component gives infinities that
+// compare correctly
+std::optional<GLfloat> AABB::intersects(const Ray &ray) const {
+  vec3gl inverseDirection = 1.f / ray.direction;
+  vec3gl t1 = (min - ray.origin) * inverseDirection;
+  vec3gl t2 = (max - ray.origin) * inverseDirection;
+  vec3gl tMin = glm::min(t1, t2);
+  vec3gl tMax = glm::max(t1, t2);
+  GLfloat enter = std::max({tMin.x, tMin.y, tMin.z, 0.f});
+  GLfloat exit = std::min({tMax.x, tMax.y, tMax.z});
+  if (enter > exit)
+    return std::nullopt;
+  return enter;
+}
+
+BoundingSphere BoundingSphere::transformed(const mat4gl &matrix) const {
+  GLfloat scale = std::max({glm::length(vec3gl(matrix[0])),
+                            glm::length(vec3gl(matrix[1])),
+                            glm::length(vec3gl(matrix[2]))});
+  return {.center = vec3gl(matrix * vec4gl(center, 1.f)),
+          .radius = radius * scale};
+}
+
+bool BoundingSphere::intersects(const AABB &aabb) const {
+  vec3gl closest = glm::clamp(center, aabb.min, aabb.max);
+  vec3gl offset = closest - center;
+  return glm::dot(offset, offset) <= radius * radius;
+}
+
+Bounds Bounds::fromVertices(std::span<const Vertex> vertices) {
+  if (vertices.empty())
+    return {};
+
+  AABB aabb{.min = vertices.front().position,
+            .max = vertices.front().position};
+  for (const auto &vertex : vertices) {
+    aabb.min = glm::min(aabb.min, vertex.position);
+    aabb.max = glm::max(aabb.max, vertex.position);
+  }
+
+  // Centering the sphere on the box is not optimal, but it is cheap and
+  // always contains every vertex
+  vec3gl center = aabb.getCenter();
+  GLfloat radiusSquared{0.f};
+  for (const auto &vertex : vertices) {
+    vec3gl offset = vertex.position - center;
+    radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+  }
+
+  return {.aabb = aabb,
+          .sphere = {.center = center, .radius = std::sqrt(radiusSquared)}};
+}
+
+Bounds Bounds::fromAABB(const AABB &aabb) {
+  return {.aabb = aabb,
+          .sphere = {.center = aabb.getCenter(),
+                     .radius = glm::length(aabb.getExtents())}};
+}
+
+Bounds Bounds::transformed(const mat4gl &matrix) const {
+  return {.aabb = aabb.transformed(matrix),
+          .sphere = sphere.transformed(matrix)};
+}
+
+Bounds Bounds::merged(const Bounds &bounds) const {
+  AABB mergedAABB = aabb.merged(bounds.aabb);
+  vec3gl center = mergedAABB.getCenter();
+  GLfloat radius =
+      std::max(glm::distance(center, sphere.center) + sphere.radius,
+               glm::distance(center, bounds.sphere.center) +
+                   bounds.sphere.radius);
+  // The sphere around the merged box may be tighter than the merged spheres
+  radius = std::min(radius, glm::length(mergedAABB.getExtents()));
+  return {.aabb = mergedAABB, .sphere = {.center = center, .radius = radius}};
+}
+
+} // namespace SGEng
@@ -0,0 +1,80 @@
+//===- Bounds.h -------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Vertex.h"
+#include "types.h"
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <optional>
+#include <span>
+
+namespace SGEng {
+
+struct Ray {
+  vec3gl origin{0.f, 0.f, 0.f};
+  vec3gl direction{0.f, 0.f, -1.f};
+};
+
+struct AABB {
+  vec3gl min{0.f, 0.f, 0.f};
+  vec3gl max{0.f, 0.f, 0.f};
+
+  vec3gl getCenter() const;
+  vec3gl getExtents() const;
+  GLfloat getSurfaceArea() const;
+  AABB transformed(const mat4gl &matrix) const;
+  AABB merged(const AABB &aabb) const;
+  AABB fattened(GLfloat margin) const;
+  bool contains(const AABB &aabb) const;
+  bool intersects(const AABB &aabb) const;
+  // Distance along the ray to the first intersection, 0 if the ray starts
+  // inside the box
+  std::optional<GLfloat> intersects(const Ray &ray) const;
+};
+
+struct BoundingSphere {
+  vec3gl center{0.f, 0.f, 0.f};
+  GLfloat radius{0.f};
+
+  BoundingSphere transformed(const mat4gl &matrix) const;
+  bool intersects(const AABB &aabb) const;
+};
+
+// Conservative bounding volumes of a set of vertices. Both are kept, since the
+// box fits most meshes tighter while the sphere is cheaper to test.
+struct Bounds {
+  AABB aabb;
+  BoundingSphere sphere;
+
+  static Bounds fromVertices(std::span<const Vertex> vertices);
+  static Bounds fromAABB(const AABB &aabb);
+
+  Bounds transformed(const mat4gl &matrix) const;
+  Bounds merged(const Bounds &bounds) const;
+};
+
+} // namespace SGEng
@@ -75,4 +75,156 @@ Config &Config::withResourcesDirectory(const fs::path &path) {
   return *this;
 }
 
+Config &Config::withRenderingMode(RenderingMode renderingMode) {
+  this->renderingMode = renderingMode;
+  return *this;
+}
+
+Config &Config::withOcclusionCulling(bool occlusionCulling) {
+  this->occlusionCulling = occlusionCulling;
+  return *this;
+}
+
+Config &Config::withPipelinedRendering(bool pipelinedRendering) {
+  this->pipelinedRendering = pipelinedRendering;
+  return *this;
+}
+
+Config &Config::withFramesInFlight(unsigned int framesInFlight) {
+  this->framesInFlight = framesInFlight;
+  return *this;
+}
+
+Config &Config::withFramePacingMode(FramePacingMode framePacingMode) {
+  this->framePacingMode = framePacingMode;
+  return *this;
+}
+
+Config &Config::withTargetFPS(unsigned int targetFPS) {
+  this->targetFPS = targetFPS;
+  return *this;
+}
+
+Config &Config::withFixedTimestep(bool fixedTimestep) {
+  this->fixedTimestep = fixedTimestep;
+  return *this;
+}
+
+Config &Config::withFixedUpdateRate(unsigned int fixedUpdateRate) {
+  this->fixedUpdateRate = fixedUpdateRate;
+  return *this;
+}
+
+Config &
+Config::withMaxFixedUpdatesPerFrame(unsigned int maxFixedUpdatesPerFrame) {
+  this->maxFixedUpdatesPerFrame = maxFixedUpdatesPerFrame;
+  return *this;
+}
+
+Config &Config::withJobWorkerCount(unsigned int jobWorkerCount) {
+  this->jobWorkerCount = jobWorkerCount;
+  return *this;
+}
+
+Config &Config::withUploadBytesPerFrame(unsigned int uploadBytesPerFrame) {
+  this->uploadBytesPerFrame = uploadBytesPerFrame;
+  return *this;
+}
+
+Config &Config::withWeldVertices(bool weldVertices) {
+  this->weldVertices = weldVertices;
+  return *this;
+}
+
+Config &Config::withWeldEpsilon(float weldEpsilon) {
+  this->weldEpsilon = weldEpsilon;
+  return *this;
+}
+
+Config &Config::withOptimizeVertexCache(bool optimizeVertexCache) {
+  this->optimizeVertexCache = optimizeVertexCache;
+  return *this;
+}
+
+Config &Config::withOptimizeOverdraw(bool optimizeOverdraw) {
+  this->optimizeOverdraw = optimizeOverdraw;
+  return *this;
+}
+
+Config &Config::withOptimizeVertexFetch(bool optimizeVertexFetch) {
+  this->optimizeVertexFetch = optimizeVertexFetch;
+  return *this;
+}
+
+Config &Config::withPackVertices(bool packVertices) {
+  this->packVertices = packVertices;
+  return *this;
+}
+
+Config &Config::withFrameStatsWindow(unsigned int frameStatsWindow) {
+  this->frameStatsWindow = frameStatsWindow;
+  return *this;
+}
+
+Config &Config::withFrameStatsPath(const fs::path &path) {
+  frameStatsPath = path;
+  return *this;
+}
+
+Config &Config::withProfilerEnabled(bool profilerEnabled) {
+  this->profilerEnabled = profilerEnabled;
+  return *this;
+}
+
+Config &Config::withProfilerTraceSeconds(double profilerTraceSeconds) {
+  this->profilerTraceSeconds = profilerTraceSeconds;
+  return *this;
+}
+
+Config &Config::withProfilerTracePath(const fs::path &path) {
+  profilerTracePath = path;
+  return *this;
+}
+
+Config &
+Config::withTraceCategories(const std::vector<std::string> &categories) {
+  traceCategories = categories;
+  return *this;
+}
+
+Config &Config::withTracePath(const fs::path &path) {
+  tracePath = path;
+  return *this;
+}
+
+Config &Config::withTraceTextPath(const fs::path &path) {
+  traceTextPath = path;
+  return *this;
+}
+
+Config &Config::withHeadless(bool headless) {
+  this->headless = headless;
+  return *this;
+}
+
+Config &Config::withHeadlessBackend(HeadlessBackend headlessBackend) {
+  this->headlessBackend = headlessBackend;
+  return *this;
+}
+
+Config &Config::withHeadlessFrameCount(unsigned int headlessFrameCount) {
+  this->headlessFrameCount = headlessFrameCount;
+  return *this;
+}
+
+Config &Config::withHeadlessReadbackHash(bool headlessReadbackHash) {
+  this->headlessReadbackHash = headlessReadbackHash;
+  return *this;
+}
+
+Config &Config::withHeadlessReportPath(const fs::path &path) {
+  headlessReportPath = path;
+  return *this;
+}
+
 } // namespace SGEng
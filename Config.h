@@ -30,11 +30,30 @@
 #include <glm/vec4.hpp>
 #include <plog/Severity.h>
 #include <string>
+#include <vector>
 
 namespace SGEng {
 
 namespace fs = std::filesystem;
 
+enum class RenderingMode {
+  Direct,    // One draw call per mesh per model
+  Instanced, // One instanced draw call per mesh shared between models
+  Indirect,  // One multi-draw-indirect call over a shared geometry arena
+};
+
+enum class FramePacingMode {
+  Unlimited,     // Frames are produced as fast as possible
+  VSync,         // Swaps wait for the vertical blank
+  AdaptiveVSync, // Like vsync, but late frames are swapped immediately
+  FixedFPS,      // Frames are paced to the target FPS without vsync
+};
+
+enum class HeadlessBackend {
+  EGL,          // Surfaceless EGL context, needs no display server (Linux)
+  HiddenWindow, // Invisible GLFW window
+};
+
 struct Config {
   Config &withWindowWidth(int windowWidth);
   Config &withWindowHeight(int windowHeight);
@@ -45,6 +64,36 @@ struct Config {
   Config &withShowFPS(bool showFPS);
   Config &withStartWindowMaximized(bool startWindowMaximized);
   Config &withResourcesDirectory(const fs::path &path);
+  Config &withRenderingMode(RenderingMode renderingMode);
+  Config &withOcclusionCulling(bool occlusionCulling);
+  Config &withPipelinedRendering(bool pipelinedRendering);
+  Config &withFramesInFlight(unsigned int framesInFlight);
+  Config &withFramePacingMode(FramePacingMode framePacingMode);
+  Config &withTargetFPS(unsigned int targetFPS);
+  Config &withFixedTimestep(bool fixedTimestep);
+  Config &withFixedUpdateRate(unsigned int fixedUpdateRate);
+  Config &withMaxFixedUpdatesPerFrame(unsigned int maxFixedUpdatesPerFrame);
+  Config &withJobWorkerCount(unsigned int jobWorkerCount);
+  Config &withUploadBytesPerFrame(unsigned int uploadBytesPerFrame);
+  Config &withWeldVertices(bool weldVertices);
+  Config &withWeldEpsilon(float weldEpsilon);
+  Config &withOptimizeVertexCache(bool optimizeVertexCache);
+  Config &withOptimizeOverdraw(bool optimizeOverdraw);
+  Config &withOptimizeVertexFetch(bool optimizeVertexFetch);
+  Config &withPackVertices(bool packVertices);
+  Config &withFrameStatsWindow(unsigned int frameStatsWindow);
+  Config &withFrameStatsPath(const fs::path &path);
+  Config &withProfilerEnabled(bool profilerEnabled);
+  Config &withProfilerTraceSeconds(double profilerTraceSeconds);
+  Config &withProfilerTracePath(const fs::path &path);
+  Config &withTraceCategories(const std::vector<std::string> &categories);
+  Config &withTracePath(const fs::path &path);
+  Config &withTraceTextPath(const fs::path &path);
+  Config &withHeadless(bool headless);
+  Config &withHeadlessBackend(HeadlessBackend headlessBackend);
+  Config &withHeadlessFrameCount(unsigned int headlessFrameCount);
+  Config &withHeadlessReadbackHash(bool headlessReadbackHash);
+  Config &withHeadlessReportPath(const fs::path &path);
 
   int windowWidth{defaultWindowWidth};
   int windowHeight{defaultWindowHeight};
@@ -57,6 +106,57 @@ struct Config {
   bool showFPS{defaultShowFPS};
   bool startWindowMaximized{defaultStartWindowMaximized};
   fs::path resourcesDirectory{defaultResourcesDirectory};
+  RenderingMode renderingMode{RenderingMode::Direct};
+  // Hi-Z occlusion culling of indirect draws, renders through an offscreen
+  // framebuffer so that the depth of the previous frame can be sampled
+  bool occlusionCulling{false};
+  // Pipelined rendering draws frames on a separate render thread, while the
+  // game thread simulates up to framesInFlight frames ahead
+  bool pipelinedRendering{false};
+  unsigned int framesInFlight{defaultFramesInFlight};
+  FramePacingMode framePacingMode{FramePacingMode::VSync};
+  unsigned int targetFPS{defaultTargetFPS};
+  // Fixed timestep runs App::fixedUpdate at fixedUpdateRate Hz, independently
+  // of the frame rate, with at most maxFixedUpdatesPerFrame steps per frame
+  bool fixedTimestep{false};
+  unsigned int fixedUpdateRate{defaultFixedUpdateRate};
+  unsigned int maxFixedUpdatesPerFrame{defaultMaxFixedUpdatesPerFrame};
+  // Worker threads of the job system, zero uses all but one hardware thread
+  unsigned int jobWorkerCount{0};
+  // Bytes of asynchronously loaded meshes copied to the GPU per frame, zero
+  // uploads every loaded mesh at once
+  unsigned int uploadBytesPerFrame{defaultUploadBytesPerFrame};
+  // Mesh optimization passes run when a model is imported, before it is
+  // cooked, see MeshOptimizationOptions
+  bool weldVertices{true};
+  float weldEpsilon{defaultWeldEpsilon};
+  bool optimizeVertexCache{true};
+  bool optimizeOverdraw{true};
+  bool optimizeVertexFetch{true};
+  bool packVertices{true};
+  // Frame time percentiles are computed over the last frameStatsWindow
+  // frames, a summary of the whole run is written to frameStatsPath on exit
+  // unless it is empty
+  unsigned int frameStatsWindow{defaultFrameStatsWindow};
+  fs::path frameStatsPath{defaultFrameStatsPath};
+  // Profiler recording, a Chrome trace of the last profilerTraceSeconds is
+  // written to profilerTracePath on request and after headless runs
+  bool profilerEnabled{false};
+  double profilerTraceSeconds{defaultProfilerTraceSeconds};
+  fs::path profilerTracePath{defaultProfilerTracePath};
+  // Names of the trace categories enabled at startup, see TraceCategory. Their
+  // records go to the binary tracePath, which is also decoded to traceTextPath
+  // on exit unless it is empty.
+  std::vector<std::string> traceCategories;
+  fs::path tracePath{defaultTracePath};
+  fs::path traceTextPath;
+  // Headless mode renders a fixed number of frames into an offscreen
+  // framebuffer and reports frame timings instead of opening a window
+  bool headless{false};
+  HeadlessBackend headlessBackend{HeadlessBackend::EGL};
+  unsigned int headlessFrameCount{defaultHeadlessFrameCount};
+  bool headlessReadbackHash{false};
+  fs::path headlessReportPath{defaultHeadlessReportPath};
 };
 
 } // namespace SGEng
\ No newline at end of file
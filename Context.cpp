@@ -26,7 +26,11 @@
 #include "Context.h"
 
 #include "FileManager.h"
+#include "GLState.h"
 #include "IFileManager.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "TraceLog.h"
 #include "exceptions.h"
 #include <plog/Log.h>
 
@@ -52,19 +56,28 @@ void defaultDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
 }
 
 Context::Context(bool setup) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Context constructor...";
+  SGENG_TRACE(Lifetime) << "Context constructor...";
   if (setup)
     this->setup();
 }
 
 Context::~Context() {
-  PLOGV_IF(LOG_DESTRUCTORS) << "Context destructor...";
+  SGENG_TRACE(Lifetime) << "Context destructor...";
   if (isGLFWInitialized)
     terminate();
 }
 
 Context &SGEng::Context::withConfig(const Config &config) {
   logger.setLogLevel(config.logLevel);
+  Profiler::get().setEnabled(config.profilerEnabled);
+  TraceLog::disableAll();
+  for (const std::string &name : config.traceCategories) {
+    if (auto category = TraceLog::parseCategory(name))
+      TraceLog::setEnabled(*category, true);
+    else
+      PLOGW << "Unknown trace category " << name;
+  }
+  TraceLog::get().setOutputPath(config.tracePath);
   cfg = config;
   return *this;
 }
@@ -84,10 +97,23 @@ void Context::loadConfig(const fs::path &path) {
   }
 }
 
+JobSystem &Context::getJobSystem() {
+  if (!jobSystem)
+    jobSystem = std::make_unique<JobSystem>(cfg.jobWorkerCount);
+  return *jobSystem;
+}
+
 void Context::setup() {
+  getJobSystem();
   PLOGV << "GLFW setup...";
   if (!isGLFWInitialized) {
     if (glfwInit() == GLFW_FALSE) {
+      // A surfaceless headless context does not need GLFW at all, which is
+      // the case on machines without a display server
+      if (cfg.headless) {
+        PLOGW << "Failed to initialize GLFW, continuing headless";
+        return;
+      }
       throw GLFWInitializationError("Failed to initialize GLFW");
     }
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, OPENGL_MAJOR);
@@ -110,9 +136,9 @@ void Context::terminate() {
   }
 }
 
-void Context::initializeGL() {
+void Context::initializeGL(GLADloadfunc loader) {
   PLOGV << "Initializing OpenGL...";
-  if (!gladLoadGL(glfwGetProcAddress)) {
+  if (!gladLoadGL(loader)) {
     throw GLInitializationError("Failed to initialize OpenGL context");
   };
 
@@ -126,9 +152,7 @@ void Context::initializeGL() {
   glViewport(0, 0, static_cast<int>(cfg.windowWidth),
              static_cast<int>(cfg.windowHeight));
   glEnable(GL_DEPTH_TEST);
-
-  if (DISABLE_SWAP_INTERVAL)
-    glfwSwapInterval(0);
+  GLState::current().invalidate();
 
   isGLInitialized = true;
   PLOGV << "OpenGL initialized";
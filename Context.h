@@ -28,6 +28,7 @@
 #include "Config.h"
 #include "FileManager.h"
 #include "IFileManager.h"
+#include "InputEventQueue.h"
 #include "LoggerState.h"
 #include <GLFW/glfw3.h>
 #include <glad/gl.h>
@@ -39,6 +40,7 @@ class KeyInput;
 class MouseInput;
 class App;
 class Window;
+class JobSystem;
 
 void defaultDebugMessage(GLenum source, GLenum type, GLuint id, GLenum severity,
                          GLsizei length, const GLchar *message,
@@ -64,6 +66,9 @@ struct Context {
   std::vector<KeyInput *> keyInputs;
   bool areMouseInputsInitialized{false};
   std::vector<MouseInput *> mouseInputs;
+  // Filled by the key and mouse callbacks on the thread processing window
+  // events, drained by the game thread at the start of every frame
+  InputEventQueue inputEvents;
 
   Config cfg;
   Context &withConfig(const Config &config);
@@ -71,6 +76,11 @@ struct Context {
 
   std::unique_ptr<IFileManager> fileManager{std::make_unique<FileManager>()};
 
+  // Created by setup(), or by the first call to getJobSystem(), with the
+  // configured number of workers
+  std::unique_ptr<JobSystem> jobSystem;
+  JobSystem &getJobSystem();
+
   App *app{nullptr}; // Needed for GLFW callbacks - especially for window
                      // refresh callback that needs to call App.performFrame()
                      // method.
@@ -78,7 +88,7 @@ struct Context {
 
   void setup();
   void terminate();
-  void initializeGL();
+  void initializeGL(GLADloadfunc loader = glfwGetProcAddress);
   bool isInitialized();
 };
 
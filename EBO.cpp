@@ -25,20 +25,23 @@
 //===----------------------------------------------------------------------===//
 #include "EBO.h"
 
+#include "TraceLog.h"
 #include "constants.h"
-#include <plog/Log.h>
 #include <utility>
 
 namespace SGEng {
 
 EBO::EBO(const GLuint *indices, size_t size) { initialize(indices, size); }
 
-EBO::EBO(EBO &&ebo) noexcept : id(ebo.id) { ebo.id = 0; }
+EBO::EBO(EBO &&ebo) noexcept : id(ebo.id), indexType(ebo.indexType) {
+  ebo.id = 0;
+}
 
 EBO &EBO::operator=(EBO &&ebo) noexcept {
   if (this != &ebo) {
     tryDestroy();
     std::swap(id, ebo.id);
+    std::swap(indexType, ebo.indexType);
   }
   return *this;
 }
@@ -49,7 +52,7 @@ bool EBO::isInitialized() const { return id != 0; }
 
 void EBO::initialize(const GLuint *indices, size_t size) {
   tryDestroy();
-  PLOGV_IF(LOG_BUFFERS) << "EBO initialization...";
+  SGENG_TRACE(Buffers) << "EBO initialization...";
   glCreateBuffers(1, &id);
   set(indices, size);
 }
@@ -61,7 +64,10 @@ EBO &EBO::initializedWith(const GLuint *indices, size_t size) {
 
 GLuint EBO::getId() const { return id; }
 
+GLenum EBO::getIndexType() const { return indexType; }
+
 void EBO::set(const GLuint *indices, size_t size) {
+  indexType = GL_UNSIGNED_INT;
   glNamedBufferData(id, static_cast<GLsizeiptr>(size * sizeof(GLuint)), indices,
                     GL_STATIC_DRAW);
 }
@@ -74,7 +80,7 @@ void EBO::tryDestroy() {
 void EBO::destroy() {
   glDeleteBuffers(1, &id);
   id = 0;
-  PLOGV_IF(LOG_BUFFERS) << "EBO destroyed";
+  SGENG_TRACE(Buffers) << "EBO destroyed";
 }
 
 #if __cplusplus >= 202002L
@@ -82,7 +88,7 @@ EBO::EBO(std::span<GLuint> indices) { initialize(indices); }
 
 void EBO::initialize(std::span<GLuint> indices) {
   tryDestroy();
-  PLOGV_IF(LOG_BUFFERS) << "EBO initialization...";
+  SGENG_TRACE(Buffers) << "EBO initialization...";
   glCreateBuffers(1, &id);
   set(indices);
 }
@@ -92,9 +98,31 @@ EBO &EBO::initializeWith(std::span<GLuint> indices) {
   return *this;
 }
 void EBO::set(std::span<GLuint> indices) {
+  indexType = GL_UNSIGNED_INT;
   glNamedBufferData(id, static_cast<GLsizeiptr>(indices.size_bytes()),
                     indices.data(), GL_STATIC_DRAW);
 }
+
+EBO::EBO(IndexSpan indices) { initialize(indices); }
+
+void EBO::initialize(IndexSpan indices) {
+  tryDestroy();
+  SGENG_TRACE(Buffers) << "EBO initialization...";
+  glCreateBuffers(1, &id);
+  set(indices);
+}
+
+void EBO::set(IndexSpan indices) {
+  indexType = indices.type;
+  glNamedBufferData(id, static_cast<GLsizeiptr>(indices.size_bytes()),
+                    indices.data, GL_STATIC_DRAW);
+}
+
+void EBO::setSubData(IndexSpan indices, size_t offset) {
+  glNamedBufferSubData(
+      id, static_cast<GLintptr>(offset * IndexSpan::getIndexSize(indices.type)),
+      static_cast<GLsizeiptr>(indices.size_bytes()), indices.data);
+}
 #endif
 
 } // namespace SGEng
@@ -28,6 +28,7 @@
 #include <glad/gl.h>
 
 #if __cplusplus >= 202002L
+#include "IndexSpan.h"
 #include <span>
 #endif
 
@@ -47,6 +48,8 @@ public:
   void initialize(const GLuint *indices, size_t size);
   EBO &initializedWith(const GLuint *indices, size_t size);
   GLuint getId() const;
+  // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, as the buffer was last filled
+  GLenum getIndexType() const;
   void set(const GLuint *indices, size_t size);
   void tryDestroy();
   void destroy();
@@ -56,10 +59,17 @@ public:
   void initialize(std::span<GLuint> indices);
   EBO &initializeWith(std::span<GLuint> indices);
   void set(std::span<GLuint> indices);
+  // Indices of either type, null data only allocates the buffer
+  EBO(IndexSpan indices);
+  void initialize(IndexSpan indices);
+  void set(IndexSpan indices);
+  // The offset counts indices of the type of the span
+  void setSubData(IndexSpan indices, size_t offset);
 #endif
 
 private:
   GLuint id{0};
+  GLenum indexType{GL_UNSIGNED_INT};
 };
 
 } // namespace SGEng
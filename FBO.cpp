@@ -0,0 +1,129 @@
+//===- FBO.cpp --------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "FBO.h"
+
+#include "TraceLog.h"
+#include "constants.h"
+#include "exceptions.h"
+#include <string>
+#include <utility>
+
+namespace SGEng {
+
+FBO::FBO(GLsizei width, GLsizei height) { initialize(width, height); }
+
+FBO::FBO(FBO &&fbo) noexcept
+    : id{fbo.id}, colorTexture{fbo.colorTexture},
+      depthTexture{fbo.depthTexture}, width{fbo.width}, height{fbo.height} {
+  fbo.id = 0;
+  fbo.colorTexture = 0;
+  fbo.depthTexture = 0;
+  fbo.width = 0;
+  fbo.height = 0;
+}
+
+FBO &FBO::operator=(FBO &&fbo) noexcept {
+  if (this != &fbo) {
+    tryDestroy();
+    std::swap(id, fbo.id);
+    std::swap(colorTexture, fbo.colorTexture);
+    std::swap(depthTexture, fbo.depthTexture);
+    std::swap(width, fbo.width);
+    std::swap(height, fbo.height);
+  }
+  return *this;
+}
+
+FBO::~FBO() { tryDestroy(); }
+
+bool FBO::isInitialized() const { return id != 0; }
+
+void FBO::initialize(GLsizei width, GLsizei height) {
+  tryDestroy();
+  SGENG_TRACE(Buffers) << "FBO initialization...";
+  glCreateTextures(GL_TEXTURE_2D, 1, &colorTexture);
+  glTextureStorage2D(colorTexture, 1, GL_RGBA8, width, height);
+  glCreateTextures(GL_TEXTURE_2D, 1, &depthTexture);
+  glTextureStorage2D(depthTexture, 1, GL_DEPTH_COMPONENT32F, width, height);
+
+  glCreateFramebuffers(1, &id);
+  glNamedFramebufferTexture(id, GL_COLOR_ATTACHMENT0, colorTexture, 0);
+  glNamedFramebufferTexture(id, GL_DEPTH_ATTACHMENT, depthTexture, 0);
+  this->width = width;
+  this->height = height;
+
+  GLenum status = glCheckNamedFramebufferStatus(id, GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    destroy();
+    throw GLInitializationError("Framebuffer incomplete, status: " +
+                                std::to_string(status));
+  }
+}
+
+GLuint FBO::getId() const { return id; }
+
+GLuint FBO::getColorTexture() const { return colorTexture; }
+
+GLuint FBO::getDepthTexture() const { return depthTexture; }
+
+GLsizei FBO::getWidth() const { return width; }
+
+GLsizei FBO::getHeight() const { return height; }
+
+void FBO::bind() const { glBindFramebuffer(GL_FRAMEBUFFER, id); }
+
+void FBO::unbind() const { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+
+void FBO::readPixels(std::vector<uint8_t> &pixels) const {
+  pixels.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 4);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glGetTextureImage(colorTexture, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                    static_cast<GLsizei>(pixels.size()), pixels.data());
+}
+
+void FBO::blitToDefaultFramebuffer() const {
+  glBlitNamedFramebuffer(id, 0, 0, 0, width, height, 0, 0, width, height,
+                         GL_COLOR_BUFFER_BIT, GL_NEAREST);
+}
+
+void FBO::tryDestroy() {
+  if (isInitialized())
+    destroy();
+}
+
+void FBO::destroy() {
+  glDeleteFramebuffers(1, &id);
+  glDeleteTextures(1, &colorTexture);
+  glDeleteTextures(1, &depthTexture);
+  id = 0;
+  colorTexture = 0;
+  depthTexture = 0;
+  width = 0;
+  height = 0;
+  SGENG_TRACE(Buffers) << "FBO destroyed";
+}
+
+} // namespace SGEng
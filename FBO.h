@@ -0,0 +1,70 @@
+//===- FBO.h ----------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <glad/gl.h>
+#include <vector>
+
+namespace SGEng {
+
+// Framebuffer with an RGBA8 color texture and a 32-bit float depth texture.
+// Textures rather than renderbuffers are used, so that both attachments can be
+// sampled by later passes.
+class FBO {
+public:
+  FBO() = default;
+  FBO(GLsizei width, GLsizei height);
+  FBO(const FBO &fbo) = delete;
+  FBO &operator=(const FBO &fbo) = delete;
+  FBO(FBO &&fbo) noexcept;
+  FBO &operator=(FBO &&fbo) noexcept;
+  ~FBO();
+
+  bool isInitialized() const;
+  void initialize(GLsizei width, GLsizei height);
+  GLuint getId() const;
+  GLuint getColorTexture() const;
+  GLuint getDepthTexture() const;
+  GLsizei getWidth() const;
+  GLsizei getHeight() const;
+  void bind() const;
+  void unbind() const;
+  void readPixels(std::vector<uint8_t> &pixels) const;
+  // Copies the color attachment to the default framebuffer
+  void blitToDefaultFramebuffer() const;
+  void tryDestroy();
+  void destroy();
+
+private:
+  GLuint id{0};
+  GLuint colorTexture{0};
+  GLuint depthTexture{0};
+  GLsizei width{0};
+  GLsizei height{0};
+};
+
+} // namespace SGEng
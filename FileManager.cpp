@@ -26,6 +26,7 @@
 #include "FileManager.h"
 
 #include "Config.h"
+#include "TraceLog.h"
 #include "config_parsing.h"
 #include "exceptions.h"
 #include <fstream>
@@ -36,7 +37,7 @@ namespace SGEng {
 using namespace std::string_literals;
 
 std::string FileManager::loadTextFile(const fs::path &path) {
-  PLOGV_IF(LOG_FILE_OPERATIONS) << "Loading contents of " << path;
+  SGENG_TRACE(FileOperations) << "Loading contents of " << path;
   std::ifstream fin(path);
   if (!fin.is_open()) {
     throw FileError{"File could not be opened", path};
@@ -47,8 +48,17 @@ std::string FileManager::loadTextFile(const fs::path &path) {
                         (std::istreambuf_iterator<char>()));
 }
 
+void FileManager::saveTextFile(const fs::path &path, std::string_view content) {
+  SGENG_TRACE(FileOperations) << "Saving contents to " << path;
+  std::ofstream fout(path);
+  if (!fout.is_open()) {
+    throw FileError{"File could not be opened", path};
+  }
+  fout << content;
+}
+
 Config FileManager::loadConfig(const fs::path &configPath) {
-  PLOGV_IF(LOG_FILE_OPERATIONS) << "Loading config...";
+  SGENG_TRACE(FileOperations) << "Loading config...";
 
   if (!fs::exists(configPath))
     throw FileDoesNotExistError("Config file not found", configPath);
@@ -62,7 +72,7 @@ Config FileManager::loadConfig(const fs::path &configPath) {
 
   Config cfg = parseConfig(tbl);
 
-  PLOGV_IF(LOG_FILE_OPERATIONS) << "Config loaded";
+  SGENG_TRACE(FileOperations) << "Config loaded";
   PLOGI << "Log level: " << cfg.logLevel;
 
   return cfg;
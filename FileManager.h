@@ -35,6 +35,7 @@ namespace fs = std::filesystem;
 class FileManager : public IFileManager {
 public:
   [[nodiscard]] std::string loadTextFile(const fs::path &path) override;
+  void saveTextFile(const fs::path &path, std::string_view content) override;
   [[nodiscard]] Config
   loadConfig(const fs::path &configPath = defaultConfigPath) override;
 };
@@ -0,0 +1,64 @@
+//===- FrameData.h ----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "types.h"
+#include <cstddef>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace SGEng {
+
+// Scene state shared by every shader through the `FrameData` uniform block.
+// The layout has to match the std140 block declared in the shaders, which is
+// why every vec3 is paired with a scalar filling the rest of its 16 bytes.
+struct LightData {
+  vec3gl position;
+  GLfloat strength;
+  vec3gl diffuseColor;
+  GLfloat diffuseCoefficient;
+  vec3gl specularColor;
+  GLfloat specularCoefficient;
+  vec3gl ambientColor;
+  GLfloat ambientCoefficient;
+};
+
+struct FrameData {
+  mat4gl view;
+  mat4gl projection;
+  mat4gl viewProjection;
+  vec3gl cameraPosition;
+  GLfloat _padding0;
+  LightData light;
+};
+
+static_assert(offsetof(FrameData, cameraPosition) == 192,
+              "FrameData must match std140");
+static_assert(offsetof(FrameData, light) == 208,
+              "FrameData must match std140");
+static_assert(sizeof(FrameData) == 272, "FrameData must match std140");
+
+} // namespace SGEng
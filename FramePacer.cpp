@@ -0,0 +1,178 @@
+//===- FramePacer.cpp -------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "FramePacer.h"
+
+#include "TraceLog.h"
+#include "constants.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cmath>
+#include <plog/Log.h>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+namespace SGEng {
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+  if (waitableTimer)
+    CloseHandle(waitableTimer);
+#endif
+}
+
+void FramePacer::initialize(FramePacingMode mode, unsigned int targetFPS) {
+  this->mode = mode;
+  targetFrameTime = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / std::max(targetFPS, 1u)));
+  hasEndedFrame = false;
+  resetFrameTimeStats();
+
+  if (!glfwGetCurrentContext())
+    return;
+  int swapInterval{0};
+  switch (mode) {
+  case FramePacingMode::VSync:
+    swapInterval = 1;
+    break;
+  case FramePacingMode::AdaptiveVSync:
+    // Negative intervals swap immediately when a frame misses the vertical
+    // blank instead of waiting for the next one
+    if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+        glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+      swapInterval = -1;
+    } else {
+      PLOGW << "Adaptive vsync unsupported, falling back to vsync";
+      swapInterval = 1;
+    }
+    break;
+  case FramePacingMode::FixedFPS:
+  case FramePacingMode::Unlimited:
+    swapInterval = 0;
+    break;
+  }
+  glfwSwapInterval(swapInterval);
+  SGENG_TRACE(FramePacing) << "Swap interval set to " << swapInterval;
+}
+
+FramePacingMode FramePacer::getMode() const { return mode; }
+
+void FramePacer::endFrame() {
+  if (mode == FramePacingMode::FixedFPS) {
+    if (!hasEndedFrame)
+      nextDeadline = Clock::now();
+    nextDeadline += targetFrameTime;
+    Clock::time_point now = Clock::now();
+    if (now < nextDeadline)
+      sleepUntil(nextDeadline);
+    else
+      // Start a new cadence rather than rendering a burst of frames to
+      // catch up with the missed deadlines
+      nextDeadline = now;
+  }
+
+  Clock::time_point now = Clock::now();
+  if (hasEndedFrame)
+    recordFrameTime(
+        std::chrono::duration<double, std::milli>(now - lastFrameEnd).count());
+  lastFrameEnd = now;
+  hasEndedFrame = true;
+}
+
+const FrameTimeStats &FramePacer::getFrameTimeStats() const { return stats; }
+
+void FramePacer::resetFrameTimeStats() {
+  stats = FrameTimeStats();
+  frameTimeM2 = 0.0;
+}
+
+void FramePacer::sleepUntil(Clock::time_point deadline) {
+  using Seconds = std::chrono::duration<double>;
+  while (Seconds(deadline - Clock::now()).count() > sleepEstimate) {
+    Clock::time_point start = Clock::now();
+    sleepOnce();
+    double observed = Seconds(Clock::now() - start).count();
+
+    sleepCount++;
+    double delta = observed - sleepMean;
+    sleepMean += delta / static_cast<double>(sleepCount);
+    sleepM2 += delta * (observed - sleepMean);
+    double stddev =
+        std::sqrt(sleepM2 / static_cast<double>(sleepCount - 1));
+    sleepEstimate = sleepMean + stddev;
+  }
+
+  // The remaining time is shorter than a sleep is likely to take. Yielding
+  // here could hand the core to another thread for a whole time slice.
+  while (Clock::now() < deadline) {
+  }
+}
+
+void FramePacer::sleepOnce() {
+#ifdef _WIN32
+  // The default timer resolution of Windows makes sleeps last up to 15.6 ms,
+  // high resolution waitable timers are not affected by it
+  if (!waitableTimer)
+    waitableTimer = CreateWaitableTimerExW(
+        nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+        TIMER_ALL_ACCESS);
+  if (waitableTimer) {
+    LARGE_INTEGER dueTime;
+    dueTime.QuadPart = -10000; // 1 ms, relative, in 100 ns units
+    SetWaitableTimerEx(waitableTimer, &dueTime, 0, nullptr, nullptr, nullptr,
+                       0);
+    WaitForSingleObject(waitableTimer, INFINITE);
+    return;
+  }
+#endif
+  std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void FramePacer::recordFrameTime(double milliseconds) {
+  stats.frameCount++;
+  if (stats.frameCount == 1) {
+    stats.min = milliseconds;
+    stats.max = milliseconds;
+  } else {
+    stats.min = std::min(stats.min, milliseconds);
+    stats.max = std::max(stats.max, milliseconds);
+  }
+  double delta = milliseconds - stats.mean;
+  stats.mean += delta / static_cast<double>(stats.frameCount);
+  frameTimeM2 += delta * (milliseconds - stats.mean);
+  stats.variance = stats.frameCount > 1
+                       ? frameTimeM2 / static_cast<double>(stats.frameCount - 1)
+                       : 0.0;
+}
+
+} // namespace SGEng
@@ -0,0 +1,91 @@
+//===- FramePacer.h ---------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Config.h"
+#include <chrono>
+#include <cstdint>
+
+namespace SGEng {
+
+// Frame times of the frames ended since the last reset, in milliseconds
+struct FrameTimeStats {
+  uint64_t frameCount{0};
+  double mean{0.0};
+  double variance{0.0};
+  double min{0.0};
+  double max{0.0};
+};
+
+// Limits the rate at which the game loop produces frames. The vsync modes
+// leave the waiting to the swap chain, the fixed mode sleeps until the
+// deadline of every frame: in short OS sleeps while the remaining time is
+// larger than the estimated oversleep, then by spinning on the clock.
+class FramePacer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  FramePacer() = default;
+  FramePacer(const FramePacer &pacer) = delete;
+  FramePacer &operator=(const FramePacer &pacer) = delete;
+  ~FramePacer();
+
+  // Sets the swap interval of the current GLFW context, if there is one
+  void initialize(FramePacingMode mode, unsigned int targetFPS);
+  FramePacingMode getMode() const;
+  // Waits for the deadline of the frame in the fixed FPS mode and records the
+  // time since the previous frame ended
+  void endFrame();
+  const FrameTimeStats &getFrameTimeStats() const;
+  void resetFrameTimeStats();
+
+private:
+  FramePacingMode mode{FramePacingMode::Unlimited};
+  Clock::duration targetFrameTime{};
+  Clock::time_point nextDeadline{};
+  Clock::time_point lastFrameEnd{};
+  bool hasEndedFrame{false};
+
+  // Running mean and variance of OS sleep durations (Welford), the estimate
+  // is the mean plus one standard deviation
+  double sleepEstimate{0.005};
+  double sleepMean{0.005};
+  double sleepM2{0.0};
+  uint64_t sleepCount{1};
+
+  FrameTimeStats stats;
+  double frameTimeM2{0.0};
+
+#ifdef _WIN32
+  void *waitableTimer{nullptr};
+#endif
+
+  void sleepUntil(Clock::time_point deadline);
+  void sleepOnce();
+  void recordFrameTime(double milliseconds);
+};
+
+} // namespace SGEng
@@ -0,0 +1,56 @@
+//===- FrameSnapshot.cpp ----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "FrameSnapshot.h"
+
+#include "Mesh.h"
+
+namespace SGEng {
+
+void FrameSnapshot::clear() { modelCount = 0; }
+
+ModelSnapshot &FrameSnapshot::addModel(const Model &model) {
+  if (modelCount == models.size())
+    models.emplace_back();
+  ModelSnapshot &snapshot = models[modelCount++];
+  snapshot.modelMatrix = model.modelMatrix;
+  snapshot.normalMatrix = model.normalMatrix;
+  snapshot.material = model.material;
+  snapshot.bounds = model.bounds.aabb;
+  snapshot.meshes = model.meshes;
+  return snapshot;
+}
+
+std::span<const ModelSnapshot> FrameSnapshot::getModels() const {
+  return {models.data(), modelCount};
+}
+
+void FrameSnapshot::releaseMeshes() {
+  for (auto &model : models)
+    model.meshes.clear();
+  releasedMeshes.clear();
+}
+
+} // namespace SGEng
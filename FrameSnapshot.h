@@ -0,0 +1,84 @@
+//===- FrameSnapshot.h ------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Bounds.h"
+#include "FrameData.h"
+#include "Model.h"
+#include "types.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace SGEng {
+
+struct Mesh;
+
+// Copy of everything the renderer needs to draw a visible model. Uniforms are
+// copied with their locations, so that the render thread can upload the values
+// captured by the game thread.
+struct ModelSnapshot {
+  UniformMat4 modelMatrix;
+  UniformMat3 normalMatrix;
+  MaterialUniforms material;
+  AABB bounds;
+  // Shared ownership keeps meshes of removed models alive while a snapshot
+  // referencing them is still waiting to be rendered. The references are
+  // dropped by releaseMeshes() on the thread owning the context.
+  std::vector<std::shared_ptr<Mesh>> meshes;
+};
+
+// Immutable state of one frame, captured from a scene after culling. Storage
+// of a snapshot is reused by the next capture into it, so that capturing does
+// not allocate once the scene stops growing.
+class FrameSnapshot {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  void clear();
+  ModelSnapshot &addModel(const Model &model);
+  std::span<const ModelSnapshot> getModels() const;
+  // Drops the meshes referenced by the snapshot once it has been rendered,
+  // which deletes the buffers of meshes that are not used anymore. Has to be
+  // called with the context current, before the slot is captured into again.
+  void releaseMeshes();
+
+  // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
+  uint64_t frameIndex{0};
+  Clock::time_point captureTime{};
+  FrameData frameData{};
+  // Meshes of models removed from the scene before the capture
+  std::vector<std::shared_ptr<Mesh>> releasedMeshes;
+  // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+private:
+  std::vector<ModelSnapshot> models;
+  size_t modelCount{0};
+};
+
+} // namespace SGEng
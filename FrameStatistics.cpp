@@ -0,0 +1,151 @@
+//===- FrameStatistics.cpp --------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+namespace SGEng {
+
+namespace {
+
+// Nearest-rank percentile of sorted values
+double percentileOf(const std::vector<double> &sorted, double percentile) {
+  auto rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+} // namespace
+
+FrameStatistics::FrameStatistics(size_t windowSize)
+    : window(std::max<size_t>(windowSize, 1)), histogram(bucketCount) {}
+
+void FrameStatistics::addFrame(double milliseconds) {
+  // Hitches are counted before the frames they are found in leave the window
+  if (framesSinceUpdate == window.size())
+    update();
+
+  window[windowNext] = milliseconds;
+  windowNext = (windowNext + 1) % window.size();
+  windowCount = std::min(windowCount + 1, window.size());
+  framesSinceUpdate++;
+
+  auto bucket = static_cast<size_t>(std::max(milliseconds, 0.0) / bucketWidth);
+  histogram[std::min(bucket, bucketCount - 1)]++;
+  totalMin = totalFrames == 0 ? milliseconds : std::min(totalMin, milliseconds);
+  totalMax = std::max(totalMax, milliseconds);
+  totalSum += milliseconds;
+  totalFrames++;
+}
+
+const FrameTimeSummary &FrameStatistics::update() {
+  if (windowCount == 0)
+    return windowSummary;
+
+  sortBuffer.assign(window.begin(),
+                    window.begin() + static_cast<ptrdiff_t>(windowCount));
+  std::sort(sortBuffer.begin(), sortBuffer.end());
+
+  windowSummary.frameCount = windowCount;
+  windowSummary.min = sortBuffer.front();
+  windowSummary.max = sortBuffer.back();
+  windowSummary.mean =
+      std::accumulate(sortBuffer.begin(), sortBuffer.end(), 0.0) /
+      static_cast<double>(windowCount);
+  windowSummary.p50 = percentileOf(sortBuffer, 50.0);
+  windowSummary.p95 = percentileOf(sortBuffer, 95.0);
+  windowSummary.p99 = percentileOf(sortBuffer, 99.0);
+
+  double hitchThreshold = hitchFactor * windowSummary.p50;
+  windowSummary.hitchCount = static_cast<uint64_t>(
+      sortBuffer.end() - std::upper_bound(sortBuffer.begin(), sortBuffer.end(),
+                                          hitchThreshold));
+
+  // The newest frames precede windowNext in the ring
+  for (size_t i = 1; i <= framesSinceUpdate; i++) {
+    size_t index = (windowNext + window.size() - i) % window.size();
+    if (window[index] > hitchThreshold)
+      totalHitches++;
+  }
+  framesSinceUpdate = 0;
+
+  return windowSummary;
+}
+
+const FrameTimeSummary &FrameStatistics::getWindowSummary() const {
+  return windowSummary;
+}
+
+FrameTimeSummary FrameStatistics::getTotalSummary() const {
+  if (totalFrames == 0)
+    return {};
+  return {.frameCount = totalFrames,
+          .min = totalMin,
+          .mean = totalSum / static_cast<double>(totalFrames),
+          .p50 = histogramPercentile(50.0),
+          .p95 = histogramPercentile(95.0),
+          .p99 = histogramPercentile(99.0),
+          .max = totalMax,
+          .hitchCount = totalHitches};
+}
+
+std::string FrameStatistics::totalSummaryToJSON() const {
+  FrameTimeSummary summary = getTotalSummary();
+  std::ostringstream json;
+  json << "{\n"
+       << "  \"frames\": " << summary.frameCount << ",\n"
+       << "  \"min_ms\": " << summary.min << ",\n"
+       << "  \"mean_ms\": " << summary.mean << ",\n"
+       << "  \"p50_ms\": " << summary.p50 << ",\n"
+       << "  \"p95_ms\": " << summary.p95 << ",\n"
+       << "  \"p99_ms\": " << summary.p99 << ",\n"
+       << "  \"max_ms\": " << summary.max << ",\n"
+       << "  \"hitches\": " << summary.hitchCount << ",\n"
+       << "  \"hitch_factor\": " << hitchFactor << "\n"
+       << "}\n";
+  return json.str();
+}
+
+// Upper edge of the bucket holding the nearest-rank percentile, clamped to
+// the measured extremes
+double FrameStatistics::histogramPercentile(double percentile) const {
+  auto rank = static_cast<uint64_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(totalFrames)));
+  rank = std::clamp<uint64_t>(rank, 1, totalFrames);
+  uint64_t seen{0};
+  for (size_t bucket = 0; bucket < bucketCount; bucket++) {
+    seen += histogram[bucket];
+    if (seen >= rank)
+      return std::clamp(static_cast<double>(bucket + 1) * bucketWidth,
+                        totalMin, totalMax);
+  }
+  return totalMax;
+}
+
+} // namespace SGEng
@@ -0,0 +1,89 @@
+//===- FrameStatistics.h ----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SGEng {
+
+// Frame time distribution, in milliseconds. A hitch is a frame taking longer
+// than hitchFactor times the median frame time.
+struct FrameTimeSummary {
+  uint64_t frameCount{0};
+  double min{0.0};
+  double mean{0.0};
+  double p50{0.0};
+  double p95{0.0};
+  double p99{0.0};
+  double max{0.0};
+  uint64_t hitchCount{0};
+};
+
+// Frame times of a rolling window of the most recent frames, summarized
+// exactly, and of the whole run, summarized from a histogram with 0.1 ms
+// buckets. Percentiles expose stutter that averages and FPS counts hide.
+class FrameStatistics {
+public:
+  static constexpr double hitchFactor{2.0};
+  static constexpr double bucketWidth{0.1};
+  static constexpr size_t bucketCount{10000}; // Up to 1 s, the last one is open
+
+  explicit FrameStatistics(size_t windowSize);
+
+  void addFrame(double milliseconds);
+  // Summarizes the window and counts the hitches among the frames added since
+  // the previous call, measured against the median of the window. Called by
+  // addFrame() too, whenever the whole window is new.
+  const FrameTimeSummary &update();
+  const FrameTimeSummary &getWindowSummary() const;
+  // Its hitch count covers the frames up to the last update()
+  FrameTimeSummary getTotalSummary() const;
+  // Summary of the whole run as a JSON object
+  std::string totalSummaryToJSON() const;
+
+private:
+  std::vector<double> window;
+  size_t windowNext{0};
+  size_t windowCount{0};
+  size_t framesSinceUpdate{0};
+  std::vector<double> sortBuffer;
+  FrameTimeSummary windowSummary;
+
+  std::vector<uint32_t> histogram;
+  uint64_t totalFrames{0};
+  double totalMin{0.0};
+  double totalMax{0.0};
+  double totalSum{0.0};
+  uint64_t totalHitches{0};
+
+  double histogramPercentile(double percentile) const;
+};
+
+} // namespace SGEng
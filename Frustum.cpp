@@ -0,0 +1,168 @@
+//===- Frustum.cpp ----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "Frustum.h"
+
+#include <cassert>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat4x4.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SGENG_FRUSTUM_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace SGEng {
+
+void AABBBatch::clear() {
+  centerX.clear();
+  centerY.clear();
+  centerZ.clear();
+  extentX.clear();
+  extentY.clear();
+  extentZ.clear();
+}
+
+void AABBBatch::push(const AABB &aabb) {
+  vec3gl center = aabb.getCenter();
+  vec3gl extents = aabb.getExtents();
+  centerX.push_back(center.x);
+  centerY.push_back(center.y);
+  centerZ.push_back(center.z);
+  extentX.push_back(extents.x);
+  extentY.push_back(extents.y);
+  extentZ.push_back(extents.z);
+}
+
+size_t AABBBatch::size() const { return centerX.size(); }
+
+Frustum Frustum::fromMatrix(const mat4gl &viewProjection) {
+  mat4gl m = glm::transpose(viewProjection); // Rows become columns
+  Frustum frustum;
+  frustum.planes = {m[3] + m[0], m[3] - m[0], m[3] + m[1],
+                    m[3] - m[1], m[3] + m[2], m[3] - m[2]};
+  for (auto &plane : frustum.planes)
+    plane /= glm::length(vec3gl(plane));
+  return frustum;
+}
+
+bool Frustum::contains(const AABB &aabb) const {
+  vec3gl center = aabb.getCenter();
+  vec3gl extents = aabb.getExtents();
+  for (const auto &plane : planes) {
+    vec3gl normal{plane};
+    GLfloat distance = glm::dot(normal, center) + plane.w;
+    GLfloat radius = glm::dot(glm::abs(normal), extents);
+    if (distance - radius < 0.f)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects(const AABB &aabb) const {
+  vec3gl center = aabb.getCenter();
+  vec3gl extents = aabb.getExtents();
+  for (const auto &plane : planes) {
+    vec3gl normal{plane};
+    GLfloat distance = glm::dot(normal, center) + plane.w;
+    GLfloat radius = glm::dot(glm::abs(normal), extents);
+    if (distance + radius < 0.f)
+      return false;
+  }
+  return true;
+}
+
+bool Frustum::intersects(const BoundingSphere &sphere) const {
+  for (const auto &plane : planes) {
+    if (glm::dot(vec3gl(plane), sphere.center) + plane.w < -sphere.radius)
+      return false;
+  }
+  return true;
+}
+
+size_t Frustum::intersects(const AABBBatch &batch,
+                           std::span<uint8_t> visible) const {
+  return intersects(batch, 0, batch.size(), visible);
+}
+
+size_t Frustum::intersects(const AABBBatch &batch, size_t first, size_t last,
+                           std::span<uint8_t> visible) const {
+  assert(last <= batch.size() && visible.size() >= last);
+  size_t count = last;
+  size_t visibleCount{0};
+  size_t i{first};
+
+#ifdef SGENG_FRUSTUM_SSE2
+  // Four boxes are tested against one plane at a time
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  for (; i + 4 <= count; i += 4) {
+    __m128 cx = _mm_loadu_ps(&batch.centerX[i]);
+    __m128 cy = _mm_loadu_ps(&batch.centerY[i]);
+    __m128 cz = _mm_loadu_ps(&batch.centerZ[i]);
+    __m128 ex = _mm_loadu_ps(&batch.extentX[i]);
+    __m128 ey = _mm_loadu_ps(&batch.extentY[i]);
+    __m128 ez = _mm_loadu_ps(&batch.extentZ[i]);
+    __m128 outside = zero;
+    for (const auto &plane : planes) {
+      __m128 nx = _mm_set1_ps(plane.x);
+      __m128 ny = _mm_set1_ps(plane.y);
+      __m128 nz = _mm_set1_ps(plane.z);
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+          _mm_add_ps(_mm_mul_ps(nz, cz), _mm_set1_ps(plane.w)));
+      __m128 radius = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, signMask), ex),
+                     _mm_mul_ps(_mm_and_ps(ny, signMask), ey)),
+          _mm_mul_ps(_mm_and_ps(nz, signMask), ez));
+      outside =
+          _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+    }
+    int outsideMask = _mm_movemask_ps(outside);
+    for (size_t lane = 0; lane < 4; lane++) {
+      uint8_t isVisible = (outsideMask & (1 << lane)) == 0 ? 1 : 0;
+      visible[i + lane] = isVisible;
+      visibleCount += isVisible;
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    AABB aabb{.min = {batch.centerX[i] - batch.extentX[i],
+                      batch.centerY[i] - batch.extentY[i],
+                      batch.centerZ[i] - batch.extentZ[i]},
+              .max = {batch.centerX[i] + batch.extentX[i],
+                      batch.centerY[i] + batch.extentY[i],
+                      batch.centerZ[i] + batch.extentZ[i]}};
+    uint8_t isVisible = intersects(aabb) ? 1 : 0;
+    visible[i] = isVisible;
+    visibleCount += isVisible;
+  }
+  return visibleCount;
+}
+
+} // namespace SGEng
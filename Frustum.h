@@ -0,0 +1,76 @@
+//===- Frustum.h ------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Bounds.h"
+#include "types.h"
+#include <array>
+#include <cstdint>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+namespace SGEng {
+
+// Boxes stored as a structure of arrays, so that the batched frustum test can
+// load the same component of several boxes with a single instruction
+struct AABBBatch {
+  std::vector<GLfloat> centerX;
+  std::vector<GLfloat> centerY;
+  std::vector<GLfloat> centerZ;
+  std::vector<GLfloat> extentX;
+  std::vector<GLfloat> extentY;
+  std::vector<GLfloat> extentZ;
+
+  void clear();
+  void push(const AABB &aabb);
+  size_t size() const;
+};
+
+class Frustum {
+public:
+  Frustum() = default;
+
+  // Extracts the planes of the clip space volume of the given matrix
+  // (Gribb, Hartmann)
+  static Frustum fromMatrix(const mat4gl &viewProjection);
+
+  bool contains(const AABB &aabb) const;
+  bool intersects(const AABB &aabb) const;
+  bool intersects(const BoundingSphere &sphere) const;
+  // Sets visibility of every box in the batch to 1 or 0 and returns the
+  // number of visible boxes
+  size_t intersects(const AABBBatch &batch, std::span<uint8_t> visible) const;
+  // Same for the boxes in [first, last), visible is indexed like the batch
+  size_t intersects(const AABBBatch &batch, size_t first, size_t last,
+                    std::span<uint8_t> visible) const;
+
+private:
+  // Normals point inside, a point p is inside a plane if dot(n, p) + w >= 0
+  std::array<vec4gl, 6> planes{};
+};
+
+} // namespace SGEng
@@ -0,0 +1,148 @@
+//===- GLState.cpp ----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "GLState.h"
+
+#include "TraceLog.h"
+#include "constants.h"
+#include <cassert>
+#include <cstring>
+#include <plog/Log.h>
+
+namespace SGEng {
+
+GLState &GLState::current() {
+  thread_local GLState state;
+  return state;
+}
+
+void GLState::useProgram(GLuint program) {
+  if (countCall(this->program != program)) {
+    glUseProgram(program);
+    this->program = program;
+  }
+}
+
+// Programs are switched lazily - the next useProgram() call replaces the
+// released one, so unbinding it would only add a redundant call. The shadow
+// copy forgets it all the same, so the next useProgram() binds it again
+// instead of relying on a binding its user gave up.
+void GLState::releaseProgram(GLuint program) {
+  if (this->program == program)
+    this->program = 0;
+}
+
+void GLState::forgetProgram(GLuint program) {
+  if (this->program == program) {
+    glUseProgram(0);
+    this->program = 0;
+  }
+  std::erase_if(uniformValues, [program](const auto &entry) {
+    return static_cast<GLuint>(entry.first >> 32) == program;
+  });
+}
+
+void GLState::bindVertexArray(GLuint vao) {
+  if (countCall(this->vao != vao)) {
+    glBindVertexArray(vao);
+    this->vao = vao;
+  }
+}
+
+void GLState::releaseVertexArray(GLuint vao) {
+  if (this->vao == vao)
+    this->vao = 0;
+}
+
+void GLState::forgetVertexArray(GLuint vao) {
+  if (this->vao == vao) {
+    glBindVertexArray(0);
+    this->vao = 0;
+  }
+}
+
+void GLState::setFaceCulling(bool enable) {
+  if (countCall(faceCulling != enable)) {
+    if (enable)
+      glEnable(GL_CULL_FACE);
+    else
+      glDisable(GL_CULL_FACE);
+    faceCulling = enable;
+  }
+}
+
+bool GLState::needsUniformUpload(GLint location, const void *value,
+                                 size_t size) {
+  if (!contextCurrent)
+    return false;
+  if (location == -1)
+    return countCall(false);
+  if (program == 0) {
+    // glUniform* would land in whichever program the driver still has bound,
+    // the value stays cached in the uniform and is uploaded by its next use()
+    if (!unboundUploadReported) {
+      PLOGW << "Uniform upload without a used program skipped";
+      unboundUploadReported = true;
+    }
+    assert(!"Uniform upload without a used program");
+    return countCall(false);
+  }
+
+  uint64_t key = (static_cast<uint64_t>(program) << 32) |
+                 static_cast<uint32_t>(location);
+  auto [it, inserted] = uniformValues.try_emplace(key);
+  if (!inserted && std::memcmp(it->second.data(), value, size) == 0)
+    return countCall(false);
+  std::memcpy(it->second.data(), value, size);
+  return countCall(true);
+}
+
+void GLState::setContextCurrent(bool isCurrent) {
+  contextCurrent = isCurrent;
+}
+
+bool GLState::isContextCurrent() const { return contextCurrent; }
+
+void GLState::invalidate() {
+  SGENG_TRACE(GLState) << "GL state invalidated";
+  program = 0;
+  vao = 0;
+  faceCulling = false;
+  uniformValues.clear();
+}
+
+const GLStateStats &GLState::getStats() const { return stats; }
+
+void GLState::resetStats() { stats = {}; }
+
+bool GLState::countCall(bool issued) {
+  if (issued)
+    stats.issuedCalls++;
+  else
+    stats.skippedCalls++;
+  return issued;
+}
+
+} // namespace SGEng
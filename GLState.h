@@ -0,0 +1,95 @@
+//===- GLState.h ------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glad/gl.h>
+#include <unordered_map>
+
+namespace SGEng {
+
+struct GLStateStats {
+  size_t issuedCalls{0};
+  size_t skippedCalls{0};
+};
+
+// Shadow copy of the OpenGL state changed by the engine. Program, VAO, face
+// culling and uniform changes all go through it, so calls that would leave the
+// driver state unchanged are never issued.
+class GLState {
+public:
+  // OpenGL state belongs to a context, which is current on a single thread
+  static GLState &current();
+
+  void useProgram(GLuint program);
+  void releaseProgram(GLuint program);
+  void forgetProgram(GLuint program);
+  void bindVertexArray(GLuint vao);
+  void releaseVertexArray(GLuint vao);
+  void forgetVertexArray(GLuint vao);
+  void setFaceCulling(bool enable);
+
+  // Threads start with the context assumed current. A thread that hands its
+  // context over to another one clears the flag, after which uniform values
+  // set on it are only stored, to be uploaded by the thread owning the
+  // context.
+  void setContextCurrent(bool isCurrent);
+  bool isContextCurrent() const;
+
+  // Returns true if the value has to be uploaded to the uniform at the given
+  // location of the currently used program, never when no program is used
+  template <typename T>
+  bool needsUniformUpload(GLint location, const T &value);
+
+  // Resets the shadow copy to the defaults of a freshly created context
+  void invalidate();
+  const GLStateStats &getStats() const;
+  void resetStats();
+
+private:
+  using UniformValue = std::array<std::byte, 64>;
+
+  GLuint program{0};
+  GLuint vao{0};
+  bool faceCulling{false};
+  bool contextCurrent{true};
+  bool unboundUploadReported{false};
+  std::unordered_map<uint64_t, UniformValue> uniformValues;
+  GLStateStats stats;
+
+  bool needsUniformUpload(GLint location, const void *value, size_t size);
+  bool countCall(bool issued);
+};
+
+template <typename T>
+bool GLState::needsUniformUpload(GLint location, const T &value) {
+  static_assert(sizeof(T) <= sizeof(UniformValue), "Uniform value too large");
+  return needsUniformUpload(location, &value, sizeof(T));
+}
+
+} // namespace SGEng
@@ -0,0 +1,278 @@
+//===- GeometryArena.cpp ----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "GeometryArena.h"
+
+#include "TraceLog.h"
+#include "constants.h"
+#include "vertex_compression.h"
+#include <algorithm>
+
+namespace SGEng {
+
+namespace {
+
+// Position of the index type in GeometryArena::indexTypes
+size_t getIndexTypeIndex(GLenum indexType) {
+  return indexType == GL_UNSIGNED_SHORT ? 0 : 1;
+}
+
+} // namespace
+
+GeometryArena::Allocation::Allocation(Allocation &&allocation) noexcept
+    : arena{std::move(allocation.arena)},
+      vertexFormat{allocation.vertexFormat},
+      indexType{allocation.indexType}, firstVertex{allocation.firstVertex},
+      vertexCount{allocation.vertexCount}, firstIndex{allocation.firstIndex},
+      indexCount{allocation.indexCount} {
+  allocation.arena.reset();
+}
+
+GeometryArena::Allocation &
+GeometryArena::Allocation::operator=(Allocation &&allocation) noexcept {
+  if (this != &allocation) {
+    release();
+    arena = std::move(allocation.arena);
+    vertexFormat = allocation.vertexFormat;
+    indexType = allocation.indexType;
+    firstVertex = allocation.firstVertex;
+    vertexCount = allocation.vertexCount;
+    firstIndex = allocation.firstIndex;
+    indexCount = allocation.indexCount;
+    allocation.arena.reset();
+  }
+  return *this;
+}
+
+GeometryArena::Allocation::~Allocation() { release(); }
+
+bool GeometryArena::Allocation::isValid() const { return !arena.expired(); }
+
+VertexFormat GeometryArena::Allocation::getVertexFormat() const {
+  return vertexFormat;
+}
+
+GLenum GeometryArena::Allocation::getIndexType() const { return indexType; }
+
+GLint GeometryArena::Allocation::getBaseVertex() const {
+  return static_cast<GLint>(firstVertex);
+}
+
+GLuint GeometryArena::Allocation::getFirstIndex() const { return firstIndex; }
+
+GLuint GeometryArena::Allocation::getIndexCount() const { return indexCount; }
+
+void GeometryArena::Allocation::release() {
+  if (auto owner = arena.lock())
+    owner->free(*this);
+  arena.reset();
+}
+
+GeometryArena::GeometryArena(size_t vertexCapacity, size_t indexCapacity)
+    : initialVertexCapacity{vertexCapacity},
+      initialIndexCapacity{indexCapacity} {
+  SGENG_TRACE(Buffers) << "Geometry arena initialization...";
+}
+
+GeometryArena::Allocation
+GeometryArena::allocate(VertexSpan vertices, IndexSpan indices) {
+  VertexPool &vertexPool = getVertexPool(vertices.format);
+  auto firstVertex = vertexPool.ranges.allocate(vertices.size());
+  if (!firstVertex) {
+    growVertexStorage(vertices.format,
+                      vertexPool.ranges.getCapacity() + vertices.size());
+    firstVertex = vertexPool.ranges.allocate(vertices.size());
+  }
+  IndexPool &indexPool = getIndexPool(indices.type);
+  auto firstIndex = indexPool.ranges.allocate(indices.size());
+  if (!firstIndex) {
+    growIndexStorage(indices.type,
+                     indexPool.ranges.getCapacity() + indices.size());
+    firstIndex = indexPool.ranges.allocate(indices.size());
+  }
+
+  vertexPool.vbo.setSubData(vertices, firstVertex.value());
+  indexPool.ebo.setSubData(indices, firstIndex.value());
+
+  Allocation allocation;
+  allocation.arena = weak_from_this();
+  allocation.vertexFormat = vertices.format;
+  allocation.indexType = indices.type;
+  allocation.firstVertex = static_cast<GLuint>(firstVertex.value());
+  allocation.vertexCount = static_cast<GLuint>(vertices.size());
+  allocation.firstIndex = static_cast<GLuint>(firstIndex.value());
+  allocation.indexCount = static_cast<GLuint>(indices.size());
+  SGENG_TRACE(Buffers) << "Geometry arena allocated " << vertices.size()
+                       << " vertices and " << indices.size() << " indices";
+  return allocation;
+}
+
+const VAO &GeometryArena::getVAO(VertexFormat vertexFormat,
+                                 GLenum indexType) const {
+  return vaos[getVAOIndex(vertexFormat, indexType)];
+}
+
+size_t GeometryArena::getVertexCapacity(VertexFormat vertexFormat) const {
+  return getVertexPool(vertexFormat).ranges.getCapacity();
+}
+
+size_t GeometryArena::getIndexCapacity(GLenum indexType) const {
+  return getIndexPool(indexType).ranges.getCapacity();
+}
+
+GeometryArena::VertexPool &
+GeometryArena::getVertexPool(VertexFormat vertexFormat) {
+  return vertexPools[static_cast<size_t>(vertexFormat)];
+}
+
+const GeometryArena::VertexPool &
+GeometryArena::getVertexPool(VertexFormat vertexFormat) const {
+  return vertexPools[static_cast<size_t>(vertexFormat)];
+}
+
+GeometryArena::IndexPool &GeometryArena::getIndexPool(GLenum indexType) {
+  return indexPools[getIndexTypeIndex(indexType)];
+}
+
+const GeometryArena::IndexPool &
+GeometryArena::getIndexPool(GLenum indexType) const {
+  return indexPools[getIndexTypeIndex(indexType)];
+}
+
+size_t GeometryArena::getVAOIndex(VertexFormat vertexFormat,
+                                  GLenum indexType) {
+  return static_cast<size_t>(vertexFormat) * indexTypeCount +
+         getIndexTypeIndex(indexType);
+}
+
+void GeometryArena::free(const Allocation &allocation) {
+  getVertexPool(allocation.vertexFormat)
+      .ranges.free(allocation.firstVertex, allocation.vertexCount);
+  getIndexPool(allocation.indexType)
+      .ranges.free(allocation.firstIndex, allocation.indexCount);
+}
+
+void GeometryArena::growVertexStorage(VertexFormat vertexFormat,
+                                      size_t minCapacity) {
+  VertexPool &vertexPool = getVertexPool(vertexFormat);
+  size_t oldCapacity = vertexPool.ranges.getCapacity();
+  size_t newCapacity =
+      std::max({minCapacity, oldCapacity * 2, initialVertexCapacity});
+  VBO newVbo;
+  newVbo.initialize(VertexSpan(vertexFormat, nullptr, newCapacity));
+  if (oldCapacity > 0)
+    glCopyNamedBufferSubData(
+        vertexPool.vbo.getId(), newVbo.getId(), 0, 0,
+        static_cast<GLsizeiptr>(oldCapacity *
+                                VertexSpan::getVertexSize(vertexFormat)));
+  vertexPool.vbo = std::move(newVbo);
+  vertexPool.ranges.grow(newCapacity);
+  for (GLenum indexType : indexTypes)
+    if (getIndexPool(indexType).ebo.isInitialized())
+      link(vertexFormat, indexType);
+  SGENG_TRACE(Buffers) << "Geometry arena vertex storage grown to "
+                       << newCapacity;
+}
+
+void GeometryArena::growIndexStorage(GLenum indexType, size_t minCapacity) {
+  IndexPool &indexPool = getIndexPool(indexType);
+  size_t oldCapacity = indexPool.ranges.getCapacity();
+  size_t newCapacity =
+      std::max({minCapacity, oldCapacity * 2, initialIndexCapacity});
+  EBO newEbo;
+  newEbo.initialize(IndexSpan(indexType, nullptr, newCapacity));
+  if (oldCapacity > 0)
+    glCopyNamedBufferSubData(
+        indexPool.ebo.getId(), newEbo.getId(), 0, 0,
+        static_cast<GLsizeiptr>(oldCapacity *
+                                IndexSpan::getIndexSize(indexType)));
+  indexPool.ebo = std::move(newEbo);
+  indexPool.ranges.grow(newCapacity);
+  for (VertexFormat vertexFormat : vertexFormats)
+    if (getVertexPool(vertexFormat).vbo.isInitialized())
+      link(vertexFormat, indexType);
+  SGENG_TRACE(Buffers) << "Geometry arena index storage grown to "
+                       << newCapacity;
+}
+
+void GeometryArena::link(VertexFormat vertexFormat, GLenum indexType) {
+  vaos[getVAOIndex(vertexFormat, indexType)]
+      .withVBO(getVertexPool(vertexFormat).vbo.getId(),
+               getVertexLayout(vertexFormat))
+      .linkEBO(getIndexPool(indexType).ebo.getId());
+}
+
+GeometryArena::RangeAllocator::RangeAllocator(size_t capacity)
+    : capacity{capacity} {
+  if (capacity > 0)
+    freeRanges[0] = capacity;
+}
+
+std::optional<size_t> GeometryArena::RangeAllocator::allocate(size_t count) {
+  // First fit keeps the allocator simple and the storage reasonably packed,
+  // since meshes are added rarely compared to how often they are drawn
+  for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+    auto [offset, freeCount] = *it;
+    if (freeCount >= count) {
+      freeRanges.erase(it);
+      if (freeCount > count)
+        freeRanges[offset + count] = freeCount - count;
+      return offset;
+    }
+  }
+  return std::nullopt;
+}
+
+void GeometryArena::RangeAllocator::free(size_t offset, size_t count) {
+  if (count == 0)
+    return;
+
+  auto [it, inserted] = freeRanges.emplace(offset, count);
+  // Merge with the following range
+  auto next = std::next(it);
+  if (next != freeRanges.end() && it->first + it->second == next->first) {
+    it->second += next->second;
+    freeRanges.erase(next);
+  }
+  // Merge with the preceding range
+  if (it != freeRanges.begin()) {
+    auto prev = std::prev(it);
+    if (prev->first + prev->second == it->first) {
+      prev->second += it->second;
+      freeRanges.erase(it);
+    }
+  }
+}
+
+void GeometryArena::RangeAllocator::grow(size_t newCapacity) {
+  if (newCapacity > capacity) {
+    free(capacity, newCapacity - capacity);
+    capacity = newCapacity;
+  }
+}
+
+size_t GeometryArena::RangeAllocator::getCapacity() const { return capacity; }
+
+} // namespace SGEng
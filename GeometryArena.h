@@ -0,0 +1,154 @@
+//===- GeometryArena.h ------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "EBO.h"
+#include "IndexSpan.h"
+#include "VAO.h"
+#include "VBO.h"
+#include "Vertex.h"
+#include "VertexSpan.h"
+#include <array>
+#include <glad/gl.h>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+
+namespace SGEng {
+
+// Layout mandated by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+  GLuint count;
+  GLuint instanceCount;
+  GLuint firstIndex;
+  GLint baseVertex;
+  GLuint baseInstance;
+};
+
+// Shared vertex and index storage for many meshes, so that all of them can be
+// drawn with a few multi-draw-indirect calls. Vertices are stored as they are
+// in one pool per VertexFormat and indices in one pool per index type, with a
+// VAO for every combination of the two. Space is handed out in ranges of
+// vertices and indices and returned to the arena when the owning allocation
+// is destroyed.
+class GeometryArena : public std::enable_shared_from_this<GeometryArena> {
+public:
+  class Allocation {
+  public:
+    Allocation() = default;
+    Allocation(const Allocation &allocation) = delete;
+    Allocation &operator=(const Allocation &allocation) = delete;
+    Allocation(Allocation &&allocation) noexcept;
+    Allocation &operator=(Allocation &&allocation) noexcept;
+    ~Allocation();
+
+    bool isValid() const;
+    VertexFormat getVertexFormat() const;
+    GLenum getIndexType() const;
+    GLint getBaseVertex() const;
+    GLuint getFirstIndex() const;
+    GLuint getIndexCount() const;
+    void release();
+
+  private:
+    friend class GeometryArena;
+
+    std::weak_ptr<GeometryArena> arena;
+    VertexFormat vertexFormat{VertexFormat::Float};
+    GLenum indexType{GL_UNSIGNED_INT};
+    GLuint firstVertex{0};
+    GLuint vertexCount{0};
+    GLuint firstIndex{0};
+    GLuint indexCount{0};
+  };
+
+  // The storage of a vertex format or index type is created by its first
+  // allocation
+  GeometryArena(size_t vertexCapacity = defaultVertexCapacity,
+                size_t indexCapacity = defaultIndexCapacity);
+  GeometryArena(const GeometryArena &arena) = delete;
+  GeometryArena &operator=(const GeometryArena &arena) = delete;
+
+  Allocation allocate(VertexSpan vertices, IndexSpan indices);
+  // Draws the meshes whose vertices and indices have the given format and type
+  const VAO &getVAO(VertexFormat vertexFormat, GLenum indexType) const;
+  size_t getVertexCapacity(VertexFormat vertexFormat) const;
+  size_t getIndexCapacity(GLenum indexType) const;
+
+  constexpr static size_t defaultVertexCapacity{1U << 16U};
+  constexpr static size_t defaultIndexCapacity{1U << 18U};
+
+private:
+  class RangeAllocator {
+  public:
+    RangeAllocator(size_t capacity);
+
+    std::optional<size_t> allocate(size_t count);
+    void free(size_t offset, size_t count);
+    void grow(size_t newCapacity);
+    size_t getCapacity() const;
+
+  private:
+    size_t capacity;
+    std::map<size_t, size_t> freeRanges; // Offset -> count
+  };
+
+  struct VertexPool {
+    VBO vbo;
+    RangeAllocator ranges{0};
+  };
+
+  struct IndexPool {
+    EBO ebo;
+    RangeAllocator ranges{0};
+  };
+
+  constexpr static size_t vertexFormatCount{2};
+  constexpr static size_t indexTypeCount{2};
+  constexpr static std::array<VertexFormat, vertexFormatCount> vertexFormats{
+      VertexFormat::Float, VertexFormat::Packed};
+  constexpr static std::array<GLenum, indexTypeCount> indexTypes{
+      GL_UNSIGNED_SHORT, GL_UNSIGNED_INT};
+
+  size_t initialVertexCapacity;
+  size_t initialIndexCapacity;
+  std::array<VertexPool, vertexFormatCount> vertexPools;
+  std::array<IndexPool, indexTypeCount> indexPools;
+  std::array<VAO, vertexFormatCount * indexTypeCount> vaos;
+
+  VertexPool &getVertexPool(VertexFormat vertexFormat);
+  const VertexPool &getVertexPool(VertexFormat vertexFormat) const;
+  IndexPool &getIndexPool(GLenum indexType);
+  const IndexPool &getIndexPool(GLenum indexType) const;
+  static size_t getVAOIndex(VertexFormat vertexFormat, GLenum indexType);
+  void free(const Allocation &allocation);
+  void growVertexStorage(VertexFormat vertexFormat, size_t minCapacity);
+  void growIndexStorage(GLenum indexType, size_t minCapacity);
+  void link(VertexFormat vertexFormat, GLenum indexType);
+};
+
+} // namespace SGEng
@@ -0,0 +1,212 @@
+//===- HeadlessContext.cpp --------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "HeadlessContext.h"
+
+#include "constants.h"
+#include "exceptions.h"
+#include <plog/Log.h>
+
+#ifdef SGENG_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+namespace SGEng {
+
+namespace {
+
+#ifdef SGENG_HEADLESS_EGL
+GLADapiproc eglLoader(const char *name) {
+  return reinterpret_cast<GLADapiproc>(eglGetProcAddress(name));
+}
+#endif
+
+} // namespace
+
+HeadlessContext::~HeadlessContext() { destroy(); }
+
+bool HeadlessContext::isInitialized() const { return _isInitialized; }
+
+void HeadlessContext::initialize(HeadlessBackend backend) {
+  PLOGV << "Initializing headless context...";
+  if (isInitialized())
+    throw GLInitializationError("Headless context is already initialized");
+
+  if (backend == HeadlessBackend::EGL) {
+#ifdef SGENG_HEADLESS_EGL
+    try {
+      initializeEGL();
+      this->backend = HeadlessBackend::EGL;
+      _isInitialized = true;
+      PLOGI << "Headless context initialized (EGL, surfaceless)";
+      return;
+    } catch (const GLInitializationError &err) {
+      PLOGW << err.what() << ", falling back to a hidden window";
+      destroy();
+    }
+#else
+    PLOGW << "EGL backend unavailable on this platform, falling back to a "
+             "hidden window";
+#endif
+  }
+
+  initializeHiddenWindow();
+  this->backend = HeadlessBackend::HiddenWindow;
+  _isInitialized = true;
+  PLOGI << "Headless context initialized (hidden window)";
+}
+
+void HeadlessContext::makeCurrent() {
+#ifdef SGENG_HEADLESS_EGL
+  if (backend == HeadlessBackend::EGL) {
+    eglMakeCurrent(static_cast<EGLDisplay>(eglDisplay), EGL_NO_SURFACE,
+                   EGL_NO_SURFACE, static_cast<EGLContext>(eglContext));
+    return;
+  }
+#endif
+  glfwMakeContextCurrent(hiddenWindow);
+}
+
+void HeadlessContext::releaseCurrent() {
+#ifdef SGENG_HEADLESS_EGL
+  if (backend == HeadlessBackend::EGL) {
+    eglMakeCurrent(static_cast<EGLDisplay>(eglDisplay), EGL_NO_SURFACE,
+                   EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    return;
+  }
+#endif
+  glfwMakeContextCurrent(nullptr);
+}
+
+// Releases whatever was created, also after a failed initialization
+void HeadlessContext::destroy() {
+#ifdef SGENG_HEADLESS_EGL
+  if (eglDisplay) {
+    auto display = static_cast<EGLDisplay>(eglDisplay);
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (eglContext)
+      eglDestroyContext(display, static_cast<EGLContext>(eglContext));
+    eglTerminate(display);
+    eglDisplay = nullptr;
+    eglContext = nullptr;
+  }
+#endif
+  if (hiddenWindow) {
+    glfwDestroyWindow(hiddenWindow);
+    hiddenWindow = nullptr;
+  }
+  if (isInitialized()) {
+    _isInitialized = false;
+    PLOGV << "Headless context destroyed";
+  }
+}
+
+HeadlessBackend HeadlessContext::getBackend() const { return backend; }
+
+GLADloadfunc HeadlessContext::getLoader() const {
+#ifdef SGENG_HEADLESS_EGL
+  if (backend == HeadlessBackend::EGL)
+    return eglLoader;
+#endif
+  return glfwGetProcAddress;
+}
+
+void HeadlessContext::initializeEGL() {
+#ifdef SGENG_HEADLESS_EGL
+  EGLDisplay display = EGL_NO_DISPLAY;
+  // Prefer the surfaceless platform, which never talks to a display server
+  auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+      eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (getPlatformDisplay)
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                 EGL_DEFAULT_DISPLAY, nullptr);
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+  if (display == EGL_NO_DISPLAY)
+    throw GLInitializationError("Failed to get an EGL display");
+
+  EGLint major{0};
+  EGLint minor{0};
+  if (eglInitialize(display, &major, &minor) == EGL_FALSE)
+    throw GLInitializationError("Failed to initialize EGL");
+  eglDisplay = display;
+  PLOGV << "EGL " << major << "." << minor << " initialized";
+
+  if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE)
+    throw GLInitializationError("EGL does not support desktop OpenGL");
+
+  const EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                                     EGL_NONE};
+  EGLConfig config{nullptr};
+  EGLint configCount{0};
+  eglChooseConfig(display, configAttributes, &config, 1, &configCount);
+  if (configCount == 0)
+    config = nullptr; // EGL_KHR_no_config_context
+
+  // Software rasterizers may lag behind the requested version, so older minor
+  // versions are tried down to the oldest one the engine supports (4.5)
+  EGLContext context = EGL_NO_CONTEXT;
+  for (EGLint minorVersion = OPENGL_MINOR;
+       context == EGL_NO_CONTEXT && minorVersion >= 5; minorVersion--) {
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION,
+        OPENGL_MAJOR,
+        EGL_CONTEXT_MINOR_VERSION,
+        minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK,
+        EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#ifdef _DEBUG
+        EGL_CONTEXT_OPENGL_DEBUG,
+        EGL_TRUE,
+#endif // _DEBUG
+        EGL_NONE};
+    context =
+        eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+  }
+  if (context == EGL_NO_CONTEXT)
+    throw GLInitializationError("Failed to create an EGL context");
+  eglContext = context;
+
+  // Needs EGL_KHR_surfaceless_context
+  if (eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) ==
+      EGL_FALSE)
+    throw GLInitializationError("Failed to make the EGL context current");
+#else
+  throw GLInitializationError("EGL support not compiled in");
+#endif
+}
+
+void HeadlessContext::initializeHiddenWindow() {
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  hiddenWindow = glfwCreateWindow(1, 1, defaultWindowTitle.data(), nullptr,
+                                  nullptr);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+  if (!hiddenWindow)
+    throw WindowInitializationError("Failed to create a hidden window");
+  glfwMakeContextCurrent(hiddenWindow);
+}
+
+} // namespace SGEng
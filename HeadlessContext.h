@@ -0,0 +1,72 @@
+//===- HeadlessContext.h ----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Config.h"
+#include <GLFW/glfw3.h>
+#include <glad/gl.h>
+
+#if defined(__linux__) && !defined(SGENG_NO_EGL)
+#define SGENG_HEADLESS_EGL
+#endif
+
+namespace SGEng {
+
+// OpenGL context that is not tied to a visible window. The EGL backend creates
+// a surfaceless context, which works without a display server and with Mesa's
+// software rasterizer (llvmpipe) on machines without a GPU. The hidden window
+// backend needs a display, but works on every platform supported by GLFW.
+// Neither backend has a usable default framebuffer, so rendering has to go to
+// a framebuffer object.
+class HeadlessContext {
+public:
+  HeadlessContext() = default;
+  HeadlessContext(const HeadlessContext &headlessContext) = delete;
+  HeadlessContext &operator=(const HeadlessContext &headlessContext) = delete;
+  ~HeadlessContext();
+
+  bool isInitialized() const;
+  void initialize(HeadlessBackend backend);
+  void makeCurrent();
+  void releaseCurrent();
+  void destroy();
+  HeadlessBackend getBackend() const;
+  GLADloadfunc getLoader() const;
+
+private:
+  bool _isInitialized{false};
+  HeadlessBackend backend{HeadlessBackend::EGL};
+  GLFWwindow *hiddenWindow{nullptr};
+  // EGLDisplay and EGLContext are opaque pointers, EGL headers are not
+  // included here to keep them out of the rest of the engine
+  void *eglDisplay{nullptr};
+  void *eglContext{nullptr};
+
+  void initializeEGL();
+  void initializeHiddenWindow();
+};
+
+} // namespace SGEng
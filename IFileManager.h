@@ -28,6 +28,7 @@
 #include "constants.h"
 #include <filesystem>
 #include <string>
+#include <string_view>
 
 namespace SGEng {
 
@@ -38,6 +39,7 @@ struct Config;
 class IFileManager {
 public:
   [[nodiscard]] virtual std::string loadTextFile(const fs::path &path) = 0;
+  virtual void saveTextFile(const fs::path &path, std::string_view content) = 0;
   [[nodiscard]] virtual Config
   loadConfig(const fs::path &configPath = defaultConfigPath) = 0;
 };
@@ -35,15 +35,20 @@ IRenderer::IRenderer(Context &ctx, Window &window) : ctx{ctx}, window{window} {}
 void IRenderer::setNeedsToResize() { needsToResize = true; }
 
 void IRenderer::resize() {
+  window.get().resizeOffscreenFramebuffer();
   auto dims = window.get().getDimensions();
   glViewport(0, 0, static_cast<GLsizei>(dims.x), static_cast<GLsizei>(dims.y));
 }
 
+MeshUploader &IRenderer::getMeshUploader() { return meshUploader; }
+
 void IRenderer::update() {
   if (needsToResize) {
     resize();
     needsToResize = false;
   }
+  meshUploader.setBytesPerFrame(ctx.get().cfg.uploadBytesPerFrame);
+  meshUploader.process();
 }
 
 } // namespace SGEng
@@ -26,11 +26,13 @@
 #pragma once
 
 #include "Context.h"
+#include "MeshUploader.h"
 
 namespace SGEng {
 
 struct Scene;
 struct Context;
+class FrameSnapshot;
 class Window;
 
 class IRenderer {
@@ -39,9 +41,17 @@ public:
 
   void setNeedsToResize();
   void resize();
+  // Streams asynchronously loaded meshes to the GPU, see ModelLoader
+  MeshUploader &getMeshUploader();
 
+  // Called every frame on the thread owning the context, before rendering
   virtual void update();
   virtual void render(const Scene &scene) = 0;
+  // Pipelined rendering: the frame is captured on the game thread, and the
+  // snapshot is rendered on the thread owning the context
+  virtual void captureFrame(const Scene &scene, FrameSnapshot &snapshot) = 0;
+  virtual void renderFrame(const Scene &scene,
+                           const FrameSnapshot &snapshot) = 0;
 
 protected:
   // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
@@ -50,6 +60,7 @@ protected:
   // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
 private:
   bool needsToResize{false};
+  MeshUploader meshUploader;
 };
 
 } // namespace SGEng
\ No newline at end of file
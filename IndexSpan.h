@@ -0,0 +1,69 @@
+//===- IndexSpan.h ----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <glad/gl.h>
+#include <span>
+
+namespace SGEng {
+
+// Indices stored either as GL_UNSIGNED_SHORT or as GL_UNSIGNED_INT, the two
+// widths meshes are drawn with. Meshes addressing fewer than 65536 vertices
+// use 16-bit indices, halving the index memory and bandwidth.
+struct IndexSpan {
+  GLenum type{GL_UNSIGNED_INT};
+  const void *data{nullptr};
+  size_t count{0};
+
+  IndexSpan() = default;
+  IndexSpan(GLenum type, const void *data, size_t count)
+      : type{type}, data{data}, count{count} {}
+  IndexSpan(std::span<const GLuint> indices)
+      : type{GL_UNSIGNED_INT}, data{indices.data()}, count{indices.size()} {}
+  IndexSpan(std::span<const GLushort> indices)
+      : type{GL_UNSIGNED_SHORT}, data{indices.data()},
+        count{indices.size()} {}
+
+  static size_t getIndexSize(GLenum type) {
+    return type == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  }
+
+  size_t size() const { return count; }
+  size_t size_bytes() const { return count * getIndexSize(type); }
+  bool empty() const { return count == 0; }
+  std::span<const std::byte> bytes() const {
+    return {static_cast<const std::byte *>(data), size_bytes()};
+  }
+
+  GLuint operator[](size_t i) const {
+    if (type == GL_UNSIGNED_SHORT)
+      return static_cast<const GLushort *>(data)[i];
+    return static_cast<const GLuint *>(data)[i];
+  }
+};
+
+} // namespace SGEng
@@ -0,0 +1,54 @@
+//===- InputEventQueue.cpp --------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "InputEventQueue.h"
+
+namespace SGEng {
+
+bool InputEventQueue::push(const InputEvent &event) {
+  size_t currentTail = tail.load(std::memory_order_relaxed);
+  if (currentTail - head.load(std::memory_order_acquire) == capacity) {
+    droppedCount.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  events[currentTail & (capacity - 1)] = event;
+  tail.store(currentTail + 1, std::memory_order_release);
+  return true;
+}
+
+bool InputEventQueue::pop(InputEvent &event) {
+  size_t currentHead = head.load(std::memory_order_relaxed);
+  if (currentHead == tail.load(std::memory_order_acquire))
+    return false;
+  event = events[currentHead & (capacity - 1)];
+  head.store(currentHead + 1, std::memory_order_release);
+  return true;
+}
+
+uint64_t InputEventQueue::takeDroppedCount() {
+  return droppedCount.exchange(0, std::memory_order_relaxed);
+}
+
+} // namespace SGEng
@@ -0,0 +1,83 @@
+//===- InputEventQueue.h ----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace SGEng {
+
+enum class InputEventType : uint8_t { Key, MouseButton };
+
+struct InputEvent {
+  InputEventType type{InputEventType::Key};
+  bool isDown{false};
+  int code{0}; // GLFW key or mouse button
+  double timestamp{0.0}; // glfwGetTime() when the event was received
+};
+
+// Time from receiving input events to processing them at the start of a
+// frame, for the events processed since the last reset, in milliseconds
+struct InputLatencyStats {
+  uint64_t eventCount{0};
+  double mean{0.0};
+  double max{0.0};
+};
+
+// Bounded single-producer single-consumer ring buffer of input events. The
+// producer is the thread processing GLFW events, the consumer is the game
+// thread draining the queue at the start of every frame. Neither side ever
+// blocks: a push into a full queue drops the event and counts it.
+class InputEventQueue {
+public:
+  static constexpr size_t capacity{1024};
+  static_assert((capacity & (capacity - 1)) == 0,
+                "Capacity has to be a power of two");
+
+  InputEventQueue() = default;
+  InputEventQueue(const InputEventQueue &queue) = delete;
+  InputEventQueue &operator=(const InputEventQueue &queue) = delete;
+
+  // Producer side
+  bool push(const InputEvent &event);
+
+  // Consumer side
+  bool pop(InputEvent &event);
+  // Returns the number of events dropped since the last call
+  uint64_t takeDroppedCount();
+
+private:
+  // Written by the consumer, read by the producer and the other way around,
+  // so each index gets a cache line of its own
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+  alignas(64) std::atomic<uint64_t> droppedCount{0};
+  std::array<InputEvent, capacity> events{};
+};
+
+} // namespace SGEng
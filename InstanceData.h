@@ -0,0 +1,52 @@
+//===- InstanceData.h -------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "types.h"
+#include <glm/mat3x4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+namespace SGEng {
+
+// Per-instance data read by the instanced vertex shader from a shader storage
+// buffer. The layout has to match the std430 `Instance` struct declared in
+// shaders/basic/instanced.vert.
+struct InstanceData {
+  mat4gl modelMatrix;
+  mat3x4gl normalMatrix; // std430 pads every mat3 column to a vec4
+  vec3gl color;
+  GLuint shininess;
+  // Position quantization of the mesh, the identity for float vertices
+  vec3gl positionScale;
+  GLfloat _padding0;
+  vec3gl positionOffset;
+  GLfloat _padding1;
+};
+
+static_assert(sizeof(InstanceData) == 160, "InstanceData must match std430");
+
+} // namespace SGEng
@@ -0,0 +1,247 @@
+//===- JobSystem.cpp --------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "JobSystem.h"
+
+#include "Profiler.h"
+#include "TraceLog.h"
+#include "constants.h"
+#include <cassert>
+#include <string>
+
+namespace SGEng {
+
+struct Job {
+  std::function<void()> task;
+  // Dependencies not done yet, plus one held while the job is being scheduled
+  std::atomic<size_t> pendingDependencies{1};
+  std::atomic<bool> done{false};
+  std::exception_ptr exception;
+  std::mutex continuationsMutex;
+  std::vector<std::shared_ptr<Job>> continuations;
+};
+
+namespace {
+
+// Identifies the queue of a worker thread, so that the jobs it spawns are
+// pushed to its own deque
+thread_local const JobSystem *currentJobSystem{nullptr};
+thread_local size_t currentWorkerQueue{0};
+
+} // namespace
+
+JobHandle::JobHandle(std::shared_ptr<Job> job) : job{std::move(job)} {}
+
+bool JobHandle::isValid() const { return job != nullptr; }
+
+bool JobHandle::isDone() const {
+  return !job || job->done.load();
+}
+
+JobSystem::JobSystem(unsigned int workerCount) {
+  if (workerCount == 0)
+    workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+  for (unsigned int i = 0; i <= workerCount; i++)
+    queues.push_back(std::make_unique<Queue>());
+  workers.reserve(workerCount);
+  for (unsigned int i = 0; i < workerCount; i++)
+    workers.emplace_back([this, i](std::stop_token stopToken) {
+      workerLoop(stopToken, i);
+    });
+  SGENG_TRACE(Jobs) << "Job system started with " << workerCount
+                    << " workers";
+}
+
+JobSystem::~JobSystem() {
+  // Workers must be joined before the members they use are destroyed
+  for (auto &worker : workers)
+    worker.request_stop();
+  workers.clear();
+  SGENG_TRACE(Jobs) << "Job system stopped";
+}
+
+unsigned int JobSystem::getWorkerCount() const {
+  return static_cast<unsigned int>(workers.size());
+}
+
+JobHandle JobSystem::schedule(std::function<void()> task,
+                              std::span<const JobHandle> dependencies) {
+  auto job = std::make_shared<Job>();
+  job->task = std::move(task);
+  job->pendingDependencies.store(dependencies.size() + 1,
+                                 std::memory_order_relaxed);
+
+  for (const auto &dependency : dependencies) {
+    if (dependency.isValid()) {
+      std::lock_guard lock(dependency.job->continuationsMutex);
+      if (!dependency.job->done.load(std::memory_order_acquire)) {
+        dependency.job->continuations.push_back(job);
+        continue;
+      }
+    }
+    job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  JobHandle handle(job);
+  if (job->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    enqueue(std::move(job));
+  return handle;
+}
+
+JobHandle JobSystem::then(const JobHandle &job, std::function<void()> task) {
+  return schedule(std::move(task), std::span(&job, 1));
+}
+
+void JobSystem::wait(const JobHandle &job) { wait(std::span(&job, 1)); }
+
+void JobSystem::wait(std::span<const JobHandle> jobs) {
+  for (const auto &job : jobs)
+    waitUntilDone(job);
+  for (const auto &job : jobs)
+    if (job.isValid() && job.job->exception)
+      std::rethrow_exception(job.job->exception);
+}
+
+size_t JobSystem::currentQueueIndex() const {
+  return currentJobSystem == this ? currentWorkerQueue : workers.size();
+}
+
+void JobSystem::enqueue(std::shared_ptr<Job> job) {
+  Queue &queue = *queues[currentQueueIndex()];
+  {
+    std::lock_guard lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  queuedJobs.fetch_add(1, std::memory_order_release);
+  // Sleeping threads check the count under the mutex, so taking it here
+  // guarantees that the notification is not lost
+  { std::lock_guard lock(sleepMutex); }
+  sleepCondition.notify_one();
+}
+
+std::shared_ptr<Job> JobSystem::pop(size_t queueIndex) {
+  Queue &queue = *queues[queueIndex];
+  std::lock_guard lock(queue.mutex);
+  if (queue.jobs.empty())
+    return nullptr;
+  std::shared_ptr<Job> job;
+  // The shared queue is not owned by a single thread, so it is kept FIFO
+  if (queueIndex == workers.size()) {
+    job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+  } else {
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+  }
+  queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+  return job;
+}
+
+std::shared_ptr<Job> JobSystem::steal(size_t queueIndex) {
+  for (size_t i = 1; i < queues.size(); i++) {
+    Queue &queue = *queues[(queueIndex + i) % queues.size()];
+    std::lock_guard lock(queue.mutex);
+    if (queue.jobs.empty())
+      continue;
+    auto job = std::move(queue.jobs.front());
+    queue.jobs.pop_front();
+    queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+  return nullptr;
+}
+
+bool JobSystem::runOne(size_t queueIndex) {
+  if (queuedJobs.load(std::memory_order_acquire) == 0)
+    return false;
+  auto job = pop(queueIndex);
+  if (!job)
+    job = steal(queueIndex);
+  if (!job)
+    return false;
+  execute(*job);
+  return true;
+}
+
+void JobSystem::execute(Job &job) {
+  try {
+    job.task();
+  } catch (...) {
+    job.exception = std::current_exception();
+  }
+  job.task = nullptr;
+
+  std::vector<std::shared_ptr<Job>> continuations;
+  {
+    std::lock_guard lock(job.continuationsMutex);
+    job.done.store(true);
+    continuations.swap(job.continuations);
+  }
+  for (auto &continuation : continuations)
+    if (continuation->pendingDependencies.fetch_sub(
+            1, std::memory_order_acq_rel) == 1)
+      enqueue(std::move(continuation));
+
+  // Sequentially consistent with the waiter, which registers itself before
+  // checking whether the job is done
+  if (waitingThreads.load() > 0) {
+    { std::lock_guard lock(sleepMutex); }
+    sleepCondition.notify_all();
+  }
+}
+
+void JobSystem::waitUntilDone(const JobHandle &job) {
+  size_t queueIndex = currentQueueIndex();
+  while (!job.isDone()) {
+    if (runOne(queueIndex))
+      continue;
+    waitingThreads.fetch_add(1);
+    {
+      std::unique_lock lock(sleepMutex);
+      sleepCondition.wait(lock, [&] {
+        return job.isDone() ||
+               queuedJobs.load(std::memory_order_acquire) > 0;
+      });
+    }
+    waitingThreads.fetch_sub(1);
+  }
+}
+
+void JobSystem::workerLoop(std::stop_token stopToken, size_t queueIndex) {
+  Profiler::get().setThreadName("Job worker " + std::to_string(queueIndex));
+  currentJobSystem = this;
+  currentWorkerQueue = queueIndex;
+  while (!stopToken.stop_requested()) {
+    if (runOne(queueIndex))
+      continue;
+    std::unique_lock lock(sleepMutex);
+    sleepCondition.wait(lock, stopToken, [&] {
+      return queuedJobs.load(std::memory_order_acquire) > 0;
+    });
+  }
+}
+
+} // namespace SGEng
@@ -0,0 +1,147 @@
+//===- JobSystem.h ----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace SGEng {
+
+struct Job;
+
+// Handle to a scheduled job, which can be waited for or used as a dependency
+// of other jobs
+class JobHandle {
+public:
+  JobHandle() = default;
+
+  bool isValid() const;
+  bool isDone() const;
+
+private:
+  friend class JobSystem;
+
+  std::shared_ptr<Job> job;
+
+  explicit JobHandle(std::shared_ptr<Job> job);
+};
+
+// Work-stealing task scheduler. Every worker thread owns a deque of jobs: it
+// pushes and pops jobs at the back, so that recently spawned and still cached
+// work runs first, while idle workers steal from the front of other deques.
+// Threads that are not workers push to a shared deque and, while waiting for a
+// job, execute other jobs instead of blocking.
+class JobSystem {
+public:
+  // Zero workers means one less than the hardware concurrency, as the thread
+  // waiting for the jobs works too
+  explicit JobSystem(unsigned int workerCount = 0);
+  JobSystem(const JobSystem &jobSystem) = delete;
+  JobSystem &operator=(const JobSystem &jobSystem) = delete;
+  ~JobSystem();
+
+  unsigned int getWorkerCount() const;
+  // Runs the task once all of the dependencies are done
+  JobHandle schedule(std::function<void()> task,
+                     std::span<const JobHandle> dependencies = {});
+  JobHandle then(const JobHandle &job, std::function<void()> task);
+  // Executes other jobs until the given ones are done, then rethrows the
+  // first exception thrown by any of them
+  void wait(const JobHandle &job);
+  void wait(std::span<const JobHandle> jobs);
+  // Calls function(first, last) for consecutive chunks of [begin, end) of at
+  // most grainSize elements in parallel and returns when all are done
+  template <typename Function>
+  void parallelFor(size_t begin, size_t end, size_t grainSize,
+                   Function &&function);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::shared_ptr<Job>> jobs;
+  };
+
+  // One queue per worker, followed by the queue shared by other threads
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::jthread> workers;
+  std::atomic<size_t> queuedJobs{0};
+  std::atomic<size_t> waitingThreads{0};
+  std::mutex sleepMutex;
+  std::condition_variable_any sleepCondition;
+
+  size_t currentQueueIndex() const;
+  void enqueue(std::shared_ptr<Job> job);
+  std::shared_ptr<Job> pop(size_t queueIndex);
+  std::shared_ptr<Job> steal(size_t queueIndex);
+  bool runOne(size_t queueIndex);
+  void execute(Job &job);
+  void waitUntilDone(const JobHandle &job);
+  void workerLoop(std::stop_token stopToken, size_t queueIndex);
+};
+
+template <typename Function>
+void JobSystem::parallelFor(size_t begin, size_t end, size_t grainSize,
+                            Function &&function) {
+  if (begin >= end)
+    return;
+  grainSize = std::max<size_t>(grainSize, 1);
+  if (end - begin <= grainSize || workers.empty()) {
+    function(begin, end);
+    return;
+  }
+
+  std::vector<JobHandle> chunks;
+  chunks.reserve((end - begin) / grainSize);
+  for (size_t first = begin + grainSize; first < end; first += grainSize) {
+    size_t last = std::min(first + grainSize, end);
+    chunks.push_back(
+        schedule([&function, first, last] { function(first, last); }));
+  }
+
+  // The calling thread takes the first chunk itself, the other chunks still
+  // reference the function, so they are waited for even if it throws
+  std::exception_ptr exception;
+  try {
+    function(begin, begin + grainSize);
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  wait(chunks);
+  if (exception)
+    std::rethrow_exception(exception);
+}
+
+} // namespace SGEng
@@ -26,14 +26,13 @@
 #include "KeyInput.h"
 
 #include "Context.h"
+#include "TraceLog.h"
 #include <plog/Log.h>
 
 namespace SGEng {
 
-using namespace std::string_literals;
-
 KeyInput::KeyInput(Context &ctx, std::vector<int> keys) : ctx(ctx) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "KeyInput constructor...";
+  SGENG_TRACE(Lifetime) << "KeyInput constructor...";
   for (auto key : keys) {
     this->keys[key] = {};
   }
@@ -42,12 +41,12 @@ KeyInput::KeyInput(Context &ctx, std::vector<int> keys) : ctx(ctx) {
 
 KeyInput::KeyInput(const KeyInput &keyInput)
     : ctx(keyInput.ctx), keys(keyInput.keys) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "KeyInput copy constructor...";
+  SGENG_TRACE(Lifetime) << "KeyInput copy constructor...";
   ctx.get().keyInputs.push_back(this);
 }
 
 KeyInput &KeyInput::operator=(const KeyInput &keyInput) {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "KeyInput copy assignment...";
+  SGENG_TRACE(Lifetime) << "KeyInput copy assignment...";
   if (&ctx.get() != &keyInput.ctx.get()) {
     // Remove current key input from old context
     auto &_keyInputs = ctx.get().keyInputs;
@@ -63,12 +62,12 @@ KeyInput &KeyInput::operator=(const KeyInput &keyInput) {
 
 KeyInput::KeyInput(KeyInput &&keyInput) noexcept
     : ctx(keyInput.ctx), keys(keyInput.keys) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "KeyInput move constructor...";
+  SGENG_TRACE(Lifetime) << "KeyInput move constructor...";
   ctx.get().keyInputs.push_back(this);
 }
 
 KeyInput &KeyInput::operator=(KeyInput &&keyInput) noexcept {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "KeyInput move assignment...";
+  SGENG_TRACE(Lifetime) << "KeyInput move assignment...";
   if (this != &keyInput) {
     if (&ctx.get() != &keyInput.ctx.get()) {
       // Remove current key input from old context
@@ -102,9 +101,8 @@ bool KeyInput::isKeyDown(int key) const {
 
 bool KeyInput::isKeyClicked(int key) const {
   auto it = keys.find(key);
-  if (it != keys.end() && it->second.press && !it->second.longPress) {
-    it->second.longPress = true;
-    return true;
+  if (it != keys.end()) {
+    return it->second.clicked;
   }
   return false;
 }
@@ -115,23 +113,34 @@ void KeyInput::setup(Context &ctx, GLFWwindow *window) {
   PLOGV << "Key Input setup complete";
 }
 
+void KeyInput::beginFrame() {
+  for (auto &[key, state] : keys) {
+    state.clicked = false;
+  }
+}
+
 void KeyInput::setKeyState(int key, bool isDown) {
   auto it = keys.find(key);
   if (it != keys.end()) {
-    PLOGV_IF(LOG_KEY_PRESS)
-        << "Key "s + std::to_string(key) + (isDown ? " pressed" : " released");
-    it->second.longPress = isDown && it->second.press;
+    SGENG_TRACE(Input) << "Key " << key
+                       << (isDown ? " pressed" : " released");
+    if (isDown && !it->second.press)
+      it->second.clicked = true;
     it->second.press = isDown;
   }
 }
 
 void KeyInput::callback(GLFWwindow *window, int key, int scancode, int action,
                         int mods) {
+  // Repeats do not change the state of a key
+  if (action == GLFW_REPEAT)
+    return;
   auto ctx = reinterpret_cast<Context *>(glfwGetWindowUserPointer(window));
   assert(ctx);
-  for (auto keyInput : ctx->keyInputs) {
-    keyInput->setKeyState(key, action != GLFW_RELEASE);
-  }
+  ctx->inputEvents.push({.type = InputEventType::Key,
+                         .isDown = action == GLFW_PRESS,
+                         .code = key,
+                         .timestamp = glfwGetTime()});
 }
 
 } // namespace SGEng
\ No newline at end of file
@@ -34,9 +34,13 @@ namespace SGEng {
 
 struct Context;
 
+// State of a key in the current frame, derived only from the input events
+// drained at its start
 struct KeyState {
   bool press = false;
-  mutable bool longPress = false;
+  // Pressed at least once since the previous frame, also when it was released
+  // again before this one
+  bool clicked = false;
 };
 
 class KeyInput {
@@ -51,14 +55,17 @@ public:
   bool isKeyDown(int key) const;
   bool isKeyClicked(int key) const;
 
+  // Called by the game thread, before and while draining the input events of
+  // a frame
+  void beginFrame();
+  void setKeyState(int key, bool isDown);
+
   static void setup(Context &ctx, GLFWwindow *window);
 
 private:
   std::reference_wrapper<Context> ctx;
   std::map<int, KeyState> keys;
 
-  void setKeyState(int key, bool isDown);
-
   static void callback(GLFWwindow *window, int key, int scancode, int action,
                        int mods);
 };
@@ -25,6 +25,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "AsyncLogAppender.h"
 #include "constants.h"
 #include <plog/Appenders/ColorConsoleAppender.h>
 #include <plog/Appenders/RollingFileAppender.h>
@@ -40,8 +41,11 @@ template <int instanceId = PLOG_DEFAULT_INSTANCE_ID> class LoggerState {
 public:
   LoggerState(plog::Severity logLevel = defaultLogLevel,
               const fs::path &logPath = defaultLogPath) {
-    if (!_appended)
-      logger.addAppender(&consoleAppender).addAppender(&fileAppender);
+    if (!_appended) {
+      logger.addAppender(&appenders.asyncAppender);
+      AsyncLogAppender::installCrashHandlers();
+      _appended = true;
+    }
 
     setLogLevel(logLevel);
     setLogFilePath(logPath);
@@ -52,16 +56,32 @@ public:
   void setLogLevel(plog::Severity logLevel) { logger.setMaxSeverity(logLevel); }
 
   void setLogFilePath(const fs::path &path) {
-    fileAppender.setFileName(path.c_str());
+    appenders.fileAppender.setFileName(path.c_str());
   }
 
+  // Writes the records still queued for the console and the log file
+  void flush() { appenders.asyncAppender.flush(); }
+
 private:
   plog::Logger<instanceId> &logger{plog::init(defaultLogLevel)};
 
+  // Records are formatted and written on the thread of the asynchronous
+  // appender, which is destroyed first, so that it can still write the
+  // pending records
+  struct Appenders {
+    plog::RollingFileAppender<plog::TxtFormatter> fileAppender{
+        defaultLogPath.c_str()};
+    plog::ColorConsoleAppender<plog::TxtFormatter> consoleAppender{};
+    AsyncLogAppender asyncAppender{};
+
+    Appenders() {
+      asyncAppender.addAppender(&consoleAppender).addAppender(&fileAppender);
+    }
+  };
+
   // NOLINTBEGIN(cppcoreguidelines-avoid-non-const-global-variables)
   static bool _appended;
-  static plog::RollingFileAppender<plog::TxtFormatter> fileAppender;
-  static plog::ColorConsoleAppender<plog::TxtFormatter> consoleAppender;
+  static Appenders appenders;
   // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
 };
 
@@ -69,12 +89,8 @@ private:
 template <int instanceId> bool LoggerState<instanceId>::_appended{false};
 
 template <int instanceId>
-plog::RollingFileAppender<plog::TxtFormatter>
-    LoggerState<instanceId>::fileAppender{defaultLogPath.c_str()};
-
-template <int instanceId>
-plog::ColorConsoleAppender<plog::TxtFormatter>
-    LoggerState<instanceId>::consoleAppender{};
+typename LoggerState<instanceId>::Appenders
+    LoggerState<instanceId>::appenders{};
 // NOLINTEND(cppcoreguidelines-avoid-non-const-global-variables)
 
 } // namespace SGEng
\ No newline at end of file
@@ -0,0 +1,112 @@
+//===- MPSCQueue.h ----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace SGEng {
+
+// Bounded lock-free multi-producer single-consumer queue. Every cell carries
+// a sequence number telling producers and the consumer whose turn it is, so
+// that producers only contend on the tail index and the consumer never waits
+// for a producer that has not finished writing a later cell (D. Vyukov's
+// bounded queue, with the consumer side simplified for a single thread).
+template <typename T, size_t Capacity> class MPSCQueue {
+public:
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity has to be a power of two");
+
+  MPSCQueue() {
+    for (size_t i = 0; i < Capacity; i++)
+      cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  MPSCQueue(const MPSCQueue &queue) = delete;
+  MPSCQueue &operator=(const MPSCQueue &queue) = delete;
+
+  // May be called from any thread, returns false when the queue is full
+  bool push(T value) {
+    size_t position = tail.load(std::memory_order_relaxed);
+    while (true) {
+      Cell &cell = cells[position & (Capacity - 1)];
+      size_t sequence = cell.sequence.load(std::memory_order_acquire);
+      auto difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (difference == 0) {
+        if (tail.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed))
+          break;
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = tail.load(std::memory_order_relaxed);
+      }
+    }
+    Cell &cell = cells[position & (Capacity - 1)];
+    cell.value = std::move(value);
+    cell.sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Only called from the consuming thread
+  bool pop(T &value) {
+    Cell &cell = cells[head & (Capacity - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != head + 1)
+      return false;
+    value = std::move(cell.value);
+    cell.sequence.store(head + Capacity, std::memory_order_release);
+    head++;
+    return true;
+  }
+
+  // Visits the values pushed but not popped yet, oldest first, without
+  // removing them. Neither blocks nor allocates, so that it may be called from
+  // a signal handler, but a value popped and pushed again concurrently may be
+  // seen half overwritten.
+  template <typename Visitor> void forEachPending(Visitor visit) const {
+    for (size_t position = head; position != head + Capacity; position++) {
+      const Cell &cell = cells[position & (Capacity - 1)];
+      if (cell.sequence.load(std::memory_order_acquire) != position + 1)
+        return;
+      visit(cell.value);
+    }
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::array<Cell, Capacity> cells;
+  alignas(64) std::atomic<size_t> tail{0};
+  alignas(64) size_t head{0};
+};
+
+} // namespace SGEng
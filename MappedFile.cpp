@@ -0,0 +1,122 @@
+//===- MappedFile.cpp -------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "MappedFile.h"
+
+#include "exceptions.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace SGEng {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const fs::path &path) {
+  fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                           nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                           nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE) {
+    fileHandle = nullptr;
+    throw FileError{"File could not be opened", path};
+  }
+  LARGE_INTEGER fileSize{};
+  if (!GetFileSizeEx(fileHandle, &fileSize)) {
+    CloseHandle(fileHandle);
+    fileHandle = nullptr;
+    throw FileError{"File size could not be read", path};
+  }
+  size = static_cast<size_t>(fileSize.QuadPart);
+  // Empty files cannot be mapped
+  if (size == 0)
+    return;
+
+  mappingHandle =
+      CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mappingHandle)
+    data = static_cast<const std::byte *>(
+        MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+  if (!data) {
+    if (mappingHandle)
+      CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+    throw FileError{"File could not be mapped", path};
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (data)
+    UnmapViewOfFile(data);
+  if (mappingHandle)
+    CloseHandle(mappingHandle);
+  if (fileHandle)
+    CloseHandle(fileHandle);
+}
+
+#else
+
+MappedFile::MappedFile(const fs::path &path) {
+  fileDescriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fileDescriptor < 0)
+    throw FileError{"File could not be opened", path};
+  struct stat status {};
+  if (fstat(fileDescriptor, &status) != 0) {
+    close(fileDescriptor);
+    throw FileError{"File size could not be read", path};
+  }
+  size = static_cast<size_t>(status.st_size);
+  // Empty files cannot be mapped
+  if (size == 0)
+    return;
+
+  void *mapping =
+      mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+  if (mapping == MAP_FAILED) {
+    close(fileDescriptor);
+    throw FileError{"File could not be mapped", path};
+  }
+  data = static_cast<const std::byte *>(mapping);
+}
+
+MappedFile::~MappedFile() {
+  if (data)
+    munmap(const_cast<std::byte *>(data), size);
+  if (fileDescriptor >= 0)
+    close(fileDescriptor);
+}
+
+#endif
+
+std::span<const std::byte> MappedFile::getData() const { return {data, size}; }
+
+} // namespace SGEng
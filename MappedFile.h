@@ -0,0 +1,60 @@
+//===- MappedFile.h ---------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace SGEng {
+
+namespace fs = std::filesystem;
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on
+// first access and shared with its file cache, so nothing is copied until the
+// data is used.
+class MappedFile {
+public:
+  // Throws FileError when the file cannot be opened or mapped
+  explicit MappedFile(const fs::path &path);
+  MappedFile(const MappedFile &file) = delete;
+  MappedFile &operator=(const MappedFile &file) = delete;
+  ~MappedFile();
+
+  std::span<const std::byte> getData() const;
+
+private:
+  const std::byte *data{nullptr};
+  size_t size{0};
+#ifdef _WIN32
+  void *fileHandle{nullptr};
+  void *mappingHandle{nullptr};
+#else
+  int fileDescriptor{-1};
+#endif
+};
+
+} // namespace SGEng
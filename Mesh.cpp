@@ -26,21 +26,76 @@
 #include "Mesh.h"
 
 #include "utils.h"
+#include "vertex_compression.h"
 #include <array>
+#include <limits>
 
 namespace SGEng {
 
 Mesh::Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices)
     : vertices{std::move(vertices)}, indices{std::move(indices)} {
+  compactIndices();
+  computeBounds();
   initialize();
 }
 
+VertexSpan Mesh::getVertices() const {
+  if (mappedFile)
+    return mappedVertices;
+  if (!packedVertices.empty())
+    return {packedVertices, positionQuantization};
+  return std::span<const Vertex>(vertices);
+}
+
+IndexSpan Mesh::getIndices() const {
+  if (mappedFile)
+    return mappedIndices;
+  if (!shortIndices.empty())
+    return std::span<const GLushort>(shortIndices);
+  return std::span<const GLuint>(indices);
+}
+
+void Mesh::compactIndices() {
+  if (mappedFile || indices.empty() ||
+      getVertices().size() > std::numeric_limits<GLushort>::max())
+    return;
+  shortIndices.assign(indices.begin(), indices.end());
+  indices.clear();
+  indices.shrink_to_fit();
+}
+
+void Mesh::packVertices() {
+  if (mappedFile || vertices.empty())
+    return;
+  positionQuantization = getPositionQuantization(vertices);
+  packedVertices = SGEng::packVertices(vertices, positionQuantization);
+  vertices.clear();
+  vertices.shrink_to_fit();
+}
+
 void Mesh::initialize() {
-  vbo.initialize(std::span{vertices});
-  ebo.initialize(indices);
-  DataLayout layout{{0, memberLayout(&Vertex::position)},
-                    {1, memberLayout(&Vertex::normal)}};
-  vao.withVBO(vbo.getId(), layout).linkEBO(ebo.getId());
+  vbo.initialize(getVertices());
+  ebo.initialize(getIndices());
+  linkVertexArray();
+}
+
+void Mesh::linkVertexArray() {
+  vao.withVBO(vbo.getId(), getVertexLayout(getVertices().format))
+      .linkEBO(ebo.getId());
+}
+
+void Mesh::computeBounds() {
+  VertexSpan meshVertices = getVertices();
+  if (meshVertices.format == VertexFormat::Float) {
+    bounds = Bounds::fromVertices(std::span(
+        static_cast<const Vertex *>(meshVertices.data), meshVertices.size()));
+    return;
+  }
+  std::vector<Vertex> unpackedVertices;
+  unpackedVertices.reserve(meshVertices.size());
+  for (size_t i = 0; i < meshVertices.size(); i++)
+    unpackedVertices.push_back(meshVertices[i]);
+  bounds = Bounds::fromVertices(unpackedVertices);
 }
 
 } // namespace SGEng
\ No newline at end of file
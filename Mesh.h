@@ -25,11 +25,18 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "Bounds.h"
 #include "EBO.h"
+#include "GeometryArena.h"
+#include "IndexSpan.h"
+#include "MappedFile.h"
 #include "VAO.h"
 #include "VBO.h"
 #include "Vertex.h"
+#include "VertexSpan.h"
 #include <glad/gl.h>
+#include <memory>
+#include <span>
 #include <vector>
 
 namespace SGEng {
@@ -38,16 +45,46 @@ struct Mesh {
 public:
   std::vector<Vertex> vertices;
   std::vector<GLuint> indices;
+  // Replaces indices once compactIndices() found that all of the vertices can
+  // be addressed with 16 bits
+  std::vector<GLushort> shortIndices;
+  // Replaces vertices once packVertices() quantized them, with positions
+  // mapped back to model space by positionQuantization
+  std::vector<PackedVertex> packedVertices;
+  PositionQuantization positionQuantization;
+  // Meshes loaded from a cooked file leave vertices and indices empty and
+  // refer to the memory mapping of the file instead, see getVertices()
+  std::shared_ptr<const MappedFile> mappedFile;
+  VertexSpan mappedVertices;
+  IndexSpan mappedIndices;
   VAO vao;
   VBO vbo;
   EBO ebo;
+  // Placement in the renderer's shared geometry arena, filled in lazily the
+  // first time the mesh is drawn in the indirect rendering mode
+  mutable GeometryArena::Allocation arenaAllocation;
+
+  Bounds bounds; // In model space
 
   bool enableFaceCulling{true};
 
   Mesh() = default;
   Mesh(std::vector<Vertex> vertices, std::vector<GLuint> indices);
 
+  // Vertices and indices, wherever and however they are stored
+  VertexSpan getVertices() const;
+  IndexSpan getIndices() const;
+  // Moves indices to shortIndices when there are fewer than 65536 vertices
+  void compactIndices();
+  // Moves vertices to packedVertices, quantizing the positions within the
+  // bounding box of the mesh
+  void packVertices();
+
+  // Uploads the vertices and indices and links the vertex array
   void initialize();
+  // Links the vertex array to already filled buffers, see MeshUploader
+  void linkVertexArray();
+  void computeBounds();
 };
 
 } // namespace SGEng
\ No newline at end of file
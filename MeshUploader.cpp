@@ -0,0 +1,193 @@
+//===- MeshUploader.cpp -----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "MeshUploader.h"
+
+#include "Mesh.h"
+#include "Profiler.h"
+#include "TraceLog.h"
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <utility>
+
+namespace SGEng {
+
+MeshUploader::~MeshUploader() { destroy(); }
+
+void MeshUploader::enqueue(std::vector<std::shared_ptr<Mesh>> meshes,
+                           std::function<void()> onResident) {
+  std::lock_guard lock(enqueuedMutex);
+  enqueuedBatches.push_back(
+      {.meshes = std::move(meshes), .onResident = std::move(onResident)});
+}
+
+void MeshUploader::setBytesPerFrame(size_t bytesPerFrame) {
+  if (bytesPerFrame == this->bytesPerFrame)
+    return;
+  this->bytesPerFrame = bytesPerFrame;
+  // Recreated with the new size on the next upload
+  destroyStagingBuffer();
+}
+
+void MeshUploader::process() {
+  takeEnqueuedBatches();
+  if (batches.empty())
+    return;
+
+  ProfileScope profileScope("MeshUploader::process");
+  if (bytesPerFrame == 0) {
+    uploadImmediately();
+    return;
+  }
+  if (stagingBuffer == 0)
+    createStagingBuffer();
+
+  GLsync &fence = fences[stagingHalf];
+  if (fence) {
+    // The copies out of this half of the staging buffer are still executing
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED) {
+      SGENG_TRACE(Buffers) << "Staging buffer busy, mesh upload skipped";
+      return;
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+  size_t budget = bytesPerFrame;
+  size_t stagingOffset = stagingHalf * stagingHalfSize;
+  while (!batches.empty() && uploadSlice(batches.front(), budget,
+                                         stagingOffset)) {
+    Batch batch = std::move(batches.front());
+    batches.pop_front();
+    if (batch.onResident)
+      batch.onResident();
+  }
+  if (budget < bytesPerFrame) {
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    stagingHalf ^= 1;
+  }
+}
+
+void MeshUploader::destroy() {
+  destroyStagingBuffer();
+  batches.clear();
+  std::lock_guard lock(enqueuedMutex);
+  enqueuedBatches.clear();
+}
+
+void MeshUploader::takeEnqueuedBatches() {
+  std::lock_guard lock(enqueuedMutex);
+  while (!enqueuedBatches.empty()) {
+    batches.push_back(std::move(enqueuedBatches.front()));
+    enqueuedBatches.pop_front();
+  }
+}
+
+void MeshUploader::uploadImmediately() {
+  while (!batches.empty()) {
+    Batch batch = std::move(batches.front());
+    batches.pop_front();
+    for (auto &mesh : batch.meshes)
+      mesh->initialize();
+    if (batch.onResident)
+      batch.onResident();
+  }
+}
+
+bool MeshUploader::uploadSlice(Batch &batch, size_t &budget,
+                               size_t &stagingOffset) {
+  for (; batch.meshIndex < batch.meshes.size(); batch.meshIndex++) {
+    if (budget == 0)
+      return false;
+
+    Mesh &mesh = *batch.meshes[batch.meshIndex];
+    VertexSpan vertices = mesh.getVertices();
+    IndexSpan indices = mesh.getIndices();
+    auto vertexBytes = vertices.bytes();
+    auto indexBytes = indices.bytes();
+    if (batch.uploadedBytes == 0) {
+      mesh.vbo.initialize(VertexSpan(vertices.format, nullptr,
+                                     vertices.size(), vertices.quantization));
+      mesh.ebo.initialize(IndexSpan(indices.type, nullptr, indices.size()));
+    }
+
+    size_t meshBytes = vertexBytes.size() + indexBytes.size();
+    while (batch.uploadedBytes < meshBytes) {
+      if (budget == 0)
+        return false;
+      bool isVertexData = batch.uploadedBytes < vertexBytes.size();
+      size_t targetOffset = isVertexData
+                                ? batch.uploadedBytes
+                                : batch.uploadedBytes - vertexBytes.size();
+      auto source = (isVertexData ? vertexBytes : indexBytes)
+                        .subspan(targetOffset);
+      GLuint target = isVertexData ? mesh.vbo.getId() : mesh.ebo.getId();
+      size_t size = std::min(source.size(), budget);
+      std::memcpy(stagingData + stagingOffset, source.data(), size);
+      glCopyNamedBufferSubData(stagingBuffer, target,
+                               static_cast<GLintptr>(stagingOffset),
+                               static_cast<GLintptr>(targetOffset),
+                               static_cast<GLsizeiptr>(size));
+      batch.uploadedBytes += size;
+      stagingOffset += size;
+      budget -= size;
+    }
+
+    mesh.linkVertexArray();
+    batch.uploadedBytes = 0;
+    SGENG_TRACE(Buffers) << "Mesh uploaded, " << meshBytes << " bytes";
+  }
+  return true;
+}
+
+void MeshUploader::createStagingBuffer() {
+  constexpr GLbitfield flags =
+      GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  stagingHalfSize = bytesPerFrame;
+  auto size = static_cast<GLsizeiptr>(2 * stagingHalfSize);
+  glCreateBuffers(1, &stagingBuffer);
+  glNamedBufferStorage(stagingBuffer, size, nullptr, flags);
+  stagingData = static_cast<std::byte *>(
+      glMapNamedBufferRange(stagingBuffer, 0, size, flags));
+  stagingHalf = 0;
+  SGENG_TRACE(Buffers) << "Staging buffer of " << size << " bytes created";
+}
+
+void MeshUploader::destroyStagingBuffer() {
+  for (GLsync &fence : fences) {
+    if (fence)
+      glDeleteSync(fence);
+    fence = nullptr;
+  }
+  if (stagingBuffer == 0)
+    return;
+  glUnmapNamedBuffer(stagingBuffer);
+  glDeleteBuffers(1, &stagingBuffer);
+  stagingBuffer = 0;
+  stagingData = nullptr;
+}
+
+} // namespace SGEng
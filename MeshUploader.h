@@ -0,0 +1,92 @@
+//===- MeshUploader.h -------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <glad/gl.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace SGEng {
+
+struct Mesh;
+
+// Streams the vertices and indices of meshes loaded in the background to the
+// GPU, at most a given number of bytes per frame, so that large models do not
+// stall the frame they arrive in. Data is copied through a persistently mapped
+// staging buffer split in two halves used in alternate frames; a half is only
+// written again once the fence placed after its copies has signaled, and a
+// frame is skipped otherwise. Meshes can be enqueued from any thread, the
+// uploads are processed on the thread owning the OpenGL context.
+class MeshUploader {
+public:
+  MeshUploader() = default;
+  MeshUploader(const MeshUploader &uploader) = delete;
+  MeshUploader &operator=(const MeshUploader &uploader) = delete;
+  ~MeshUploader();
+
+  // onResident is called on the thread owning the context, once all of the
+  // meshes are drawable
+  void enqueue(std::vector<std::shared_ptr<Mesh>> meshes,
+               std::function<void()> onResident);
+  // Zero uploads all enqueued meshes in the next frame, without staging
+  void setBytesPerFrame(size_t bytesPerFrame);
+  // Copies the next slice of the enqueued meshes, called once per frame
+  void process();
+  void destroy();
+
+private:
+  struct Batch {
+    std::vector<std::shared_ptr<Mesh>> meshes;
+    std::function<void()> onResident;
+    size_t meshIndex{0};
+    // Of the vertices followed by the indices of the current mesh
+    size_t uploadedBytes{0};
+  };
+
+  std::mutex enqueuedMutex;
+  std::deque<Batch> enqueuedBatches;
+  std::deque<Batch> batches;
+  size_t bytesPerFrame{0};
+  GLuint stagingBuffer{0};
+  std::byte *stagingData{nullptr};
+  size_t stagingHalfSize{0};
+  size_t stagingHalf{0};
+  std::array<GLsync, 2> fences{};
+
+  void takeEnqueuedBatches();
+  void uploadImmediately();
+  // Returns whether the batch is complete
+  bool uploadSlice(Batch &batch, size_t &budget, size_t &stagingOffset);
+  void createStagingBuffer();
+  void destroyStagingBuffer();
+};
+
+} // namespace SGEng
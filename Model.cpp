@@ -25,8 +25,10 @@
 //===----------------------------------------------------------------------===//
 #include "Model.h"
 
+#include "Mesh.h"
 #include "Shader.h"
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
 
 namespace SGEng {
 
@@ -35,12 +37,23 @@ void SGEng::Model::updateModelMatrix() {
   matrix = glm::rotate(matrix, rotationAngle, rotationAxis);
   matrix = glm::translate(matrix, position);
   modelMatrix.set(matrix);
+  normalMatrix.set(glm::transpose(glm::inverse(mat3gl(matrix))));
+  updateBounds();
+}
+
+void Model::updateBounds() {
+  mat4gl matrix = modelMatrix.get();
+  for (size_t i = 0; i < meshes.size(); i++) {
+    Bounds meshBounds = meshes[i]->bounds.transformed(matrix);
+    bounds = i == 0 ? meshBounds : bounds.merged(meshBounds);
+  }
 }
 
 void Model::initializeUniforms(const Shader &shader) {
   material.color.initialize(shader, "color");
   material.shininess.initialize(shader, "shininess");
   modelMatrix.initialize(shader, "model");
+  normalMatrix.initialize(shader, "normal_matrix");
 }
 
 void Model::resetUniforms(const Shader &shader) {
@@ -25,10 +25,12 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "Bounds.h"
 #include "types.h"
 #include "uniforms.h"
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
+#include <memory>
 #include <vector>
 
 namespace SGEng {
@@ -41,16 +43,23 @@ struct MaterialUniforms {
 struct Mesh;
 class Shader;
 
+// Meshes are shared, so that copies of a model reuse the same GPU buffers and
+// can be drawn together by the instanced renderer.
 struct Model {
-  std::vector<Mesh> meshes;
+  std::vector<std::shared_ptr<Mesh>> meshes;
   glm::vec3 position{0.f, 0.f, 0.f};
   glm::vec3 scale{1.f, 1.f, 1.f};
   float rotationAngle{0.f};
   glm::vec3 rotationAxis{0.f, 1.f, 0.f};
   UniformMat4 modelMatrix;
+  UniformMat3 normalMatrix; // Recomputed only with the model matrix
   MaterialUniforms material;
+  // In world space, updated with the model matrix. Models in a scene are
+  // refitted in its spatial index by Scene::updateModel().
+  Bounds bounds;
 
   void updateModelMatrix();
+  void updateBounds();
   void initializeUniforms(const Shader &shader);
   void resetUniforms(const Shader &shader);
 };
@@ -0,0 +1,179 @@
+//===- ModelLoader.cpp ------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "ModelLoader.h"
+
+#include "Context.h"
+#include "TraceLog.h"
+#include "Window.h"
+#include "exceptions.h"
+#include "model_loading.h"
+#include <plog/Log.h>
+#include <utility>
+
+namespace SGEng {
+
+struct ModelLoadHandle::State {
+  std::atomic<ModelLoadState> loadState{ModelLoadState::Loading};
+  // Written before the state becomes Failed
+  std::exception_ptr error;
+};
+
+struct ModelLoader::Request {
+  fs::path path;
+  Callback onResident;
+  Preparation prepare;
+  std::shared_ptr<ModelLoadHandle::State> state;
+  JobHandle job;
+  // Written by the job before the state becomes Uploading
+  Model model;
+  bool isEnqueued{false};
+  std::atomic<bool> isUploaded{false};
+};
+
+ModelLoadHandle::ModelLoadHandle(std::shared_ptr<State> state)
+    : state{std::move(state)} {}
+
+bool ModelLoadHandle::isValid() const { return state != nullptr; }
+
+ModelLoadState ModelLoadHandle::getState() const {
+  return state->loadState.load(std::memory_order_acquire);
+}
+
+bool ModelLoadHandle::isDone() const {
+  ModelLoadState loadState = getState();
+  return loadState == ModelLoadState::Resident ||
+         loadState == ModelLoadState::Failed;
+}
+
+std::exception_ptr ModelLoadHandle::getError() const {
+  return getState() == ModelLoadState::Failed ? state->error : nullptr;
+}
+
+ModelLoader::ModelLoader(Context &ctx, Window &window)
+    : ctx{ctx}, window{window} {}
+
+ModelLoader::~ModelLoader() { waitForJobs(); }
+
+ModelLoadHandle ModelLoader::load(const fs::path &path, Callback onResident,
+                                  Preparation prepare) {
+  if (!jobSystem)
+    jobSystem = &ctx.get().getJobSystem();
+
+  auto request = std::make_shared<Request>();
+  request->path = path;
+  request->onResident = std::move(onResident);
+  request->prepare = std::move(prepare);
+  request->state = std::make_shared<ModelLoadHandle::State>();
+  SGENG_TRACE(FileOperations) << "Loading model " << path << "...";
+  const Config &cfg = ctx.get().cfg;
+  MeshOptimizationOptions optimizationOptions{
+      .weldVertices = cfg.weldVertices,
+      .weldEpsilon = cfg.weldEpsilon,
+      .vertexCache = cfg.optimizeVertexCache,
+      .overdraw = cfg.optimizeOverdraw,
+      .vertexFetch = cfg.optimizeVertexFetch,
+      .packVertices = cfg.packVertices};
+  request->job = jobSystem->schedule([request, optimizationOptions,
+                                      &jobSystem = *jobSystem] {
+    ModelLoadHandle::State &state = *request->state;
+    try {
+      request->model =
+          loadModel(request->path, jobSystem, optimizationOptions);
+      state.loadState.store(ModelLoadState::Uploading,
+                            std::memory_order_release);
+      return;
+    } catch (const FileError &err) {
+      PLOGE << err.what() << " [" << err.getPath() << "]";
+    } catch (const ModelLoadingError &err) {
+      PLOGE << err.what() << " [" << err.getPath() << "]: " << err.getInfo();
+    } catch (const std::exception &err) {
+      PLOGE << "Could not load model: " << err.what() << " ["
+            << request->path << "]";
+    }
+    state.error = std::current_exception();
+    state.loadState.store(ModelLoadState::Failed, std::memory_order_release);
+  });
+  requests.push_back(request);
+  return ModelLoadHandle(request->state);
+}
+
+void ModelLoader::update() {
+  if (requests.empty())
+    return;
+  // Without workers, jobs only run while they are waited for
+  if (jobSystem->getWorkerCount() == 0)
+    for (const auto &request : requests)
+      jobSystem->wait(request->job);
+
+  IRenderer *renderer = window.get().getRenderer();
+  std::vector<std::shared_ptr<Request>> residentRequests;
+  std::erase_if(requests, [&](const std::shared_ptr<Request> &request) {
+    ModelLoadHandle::State &state = *request->state;
+    switch (state.loadState.load(std::memory_order_acquire)) {
+    case ModelLoadState::Loading:
+      return false;
+    case ModelLoadState::Uploading:
+      if (!request->isEnqueued && renderer) {
+        renderer->getMeshUploader().enqueue(request->model.meshes, [request] {
+          if (request->prepare)
+            request->prepare(request->model);
+          request->isUploaded.store(true, std::memory_order_release);
+        });
+        request->isEnqueued = true;
+      }
+      if (!request->isUploaded.load(std::memory_order_acquire))
+        return false;
+      state.loadState.store(ModelLoadState::Resident,
+                            std::memory_order_release);
+      SGENG_TRACE(FileOperations) << "Model " << request->path << " resident";
+      residentRequests.push_back(request);
+      return true;
+    default:
+      return true;
+    }
+  });
+
+  // Callbacks may load other models
+  for (const auto &request : residentRequests)
+    request->onResident(std::move(request->model));
+}
+
+bool ModelLoader::isIdle() const { return requests.empty(); }
+
+void ModelLoader::destroy() {
+  waitForJobs();
+  if (IRenderer *renderer = window.get().getRenderer())
+    renderer->getMeshUploader().destroy();
+  requests.clear();
+}
+
+void ModelLoader::waitForJobs() {
+  for (const auto &request : requests)
+    if (!request->job.isDone())
+      jobSystem->wait(request->job);
+}
+
+} // namespace SGEng
@@ -0,0 +1,113 @@
+//===- ModelLoader.h --------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "JobSystem.h"
+#include "Model.h"
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace SGEng {
+
+namespace fs = std::filesystem;
+
+struct Context;
+class Window;
+
+enum class ModelLoadState {
+  Loading,   // Parsed and converted on a worker thread
+  Uploading, // Streamed to the GPU by the renderer's MeshUploader
+  Resident,  // Handed to the callback, ready to be added to a scene
+  Failed,
+};
+
+// Tracks a model loaded by ModelLoader, can be queried from any thread
+class ModelLoadHandle {
+public:
+  ModelLoadHandle() = default;
+
+  bool isValid() const;
+  ModelLoadState getState() const;
+  // Resident or failed
+  bool isDone() const;
+  // Exception thrown while loading a failed model
+  std::exception_ptr getError() const;
+
+private:
+  friend class ModelLoader;
+  struct State;
+
+  std::shared_ptr<State> state;
+
+  explicit ModelLoadHandle(std::shared_ptr<State> state);
+};
+
+// Loads models in the background: files are parsed and their meshes converted
+// on the job system, the meshes are then uploaded within the per-frame budget
+// of the renderer's MeshUploader, and the model is passed to the callback on
+// the game thread once it can be drawn. Used on the game thread.
+class ModelLoader {
+public:
+  using Callback = std::function<void(Model model)>;
+  // Runs on the thread owning the context right after the meshes are
+  // uploaded, so that GL state of the model, such as its uniforms, is set up
+  // without the game thread waiting for the render thread
+  using Preparation = std::function<void(Model &model)>;
+
+  ModelLoader(Context &ctx, Window &window);
+  ModelLoader(const ModelLoader &loader) = delete;
+  ModelLoader &operator=(const ModelLoader &loader) = delete;
+  // Only waits for the jobs, call destroy() first
+  ~ModelLoader();
+
+  ModelLoadHandle load(const fs::path &path, Callback onResident,
+                       Preparation prepare = {});
+  // Hands loaded models to the uploader and resident models to their
+  // callbacks, called once per frame
+  void update();
+  // True once every requested model has reached its callback or failed
+  bool isIdle() const;
+  // Waits for the jobs and drops the pending models, together with the meshes
+  // still waiting in the uploader. Their buffers are deleted, so it is called
+  // with the context current, after the render thread has stopped.
+  void destroy();
+
+private:
+  struct Request;
+
+  std::reference_wrapper<Context> ctx;
+  std::reference_wrapper<Window> window;
+  JobSystem *jobSystem{nullptr};
+  std::vector<std::shared_ptr<Request>> requests;
+
+  void waitForJobs();
+};
+
+} // namespace SGEng
@@ -26,14 +26,13 @@
 #include "MouseInput.h"
 
 #include "Context.h"
+#include "TraceLog.h"
 #include <plog/Log.h>
 
 namespace SGEng {
 
-using namespace std::string_literals;
-
 MouseInput::MouseInput(Context &ctx, std::vector<int> buttons) : ctx{ctx} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "MouseInput constructor...";
+  SGENG_TRACE(Lifetime) << "MouseInput constructor...";
   for (auto button : buttons) {
     this->buttons[button] = {};
   }
@@ -42,12 +41,12 @@ MouseInput::MouseInput(Context &ctx, std::vector<int> buttons) : ctx{ctx} {
 
 MouseInput::MouseInput(const MouseInput &mouseInput)
     : ctx{mouseInput.ctx}, buttons{mouseInput.buttons} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "MouseInput copy constructor...";
+  SGENG_TRACE(Lifetime) << "MouseInput copy constructor...";
   ctx.get().mouseInputs.push_back(this);
 }
 
 MouseInput &MouseInput::operator=(const MouseInput &mouseInput) {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "MouseInput copy assignment...";
+  SGENG_TRACE(Lifetime) << "MouseInput copy assignment...";
   if (&ctx.get() != &mouseInput.ctx.get()) {
     // Remove current mouse input from old context
     auto &_mouseInputs = ctx.get().mouseInputs;
@@ -64,12 +63,12 @@ MouseInput &MouseInput::operator=(const MouseInput &mouseInput) {
 
 MouseInput::MouseInput(MouseInput &&mouseInput) noexcept
     : ctx{mouseInput.ctx}, buttons{mouseInput.buttons} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "MouseInput move constructor...";
+  SGENG_TRACE(Lifetime) << "MouseInput move constructor...";
   ctx.get().mouseInputs.push_back(this);
 }
 
 MouseInput &MouseInput::operator=(MouseInput &&mouseInput) noexcept {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "MouseInput move assignment...";
+  SGENG_TRACE(Lifetime) << "MouseInput move assignment...";
   if (this != &mouseInput) {
     if (&ctx.get() != &mouseInput.ctx.get()) {
       // Remove current mouse input from old context
@@ -111,9 +110,8 @@ bool MouseInput::isRightButtonDown() const {
 
 bool MouseInput::isButtonClicked(int button) const {
   auto it = buttons.find(button);
-  if (it != buttons.end() && it->second.press && !it->second.longPress) {
-    it->second.longPress = true;
-    return true;
+  if (it != buttons.end()) {
+    return it->second.clicked;
   }
   return false;
 }
@@ -132,12 +130,19 @@ void MouseInput::setup(Context &ctx, GLFWwindow *window) {
   PLOGV << "Mouse Input setup complete";
 }
 
+void MouseInput::beginFrame() {
+  for (auto &[button, state] : buttons) {
+    state.clicked = false;
+  }
+}
+
 void MouseInput::setButtonState(int button, bool isDown) {
   auto it = buttons.find(button);
   if (it != buttons.end()) {
-    PLOGV_IF(LOG_KEY_PRESS) << "Button "s + std::to_string(button) +
-                                   (isDown ? " pressed" : " released");
-    it->second.longPress = isDown && it->second.press;
+    SGENG_TRACE(Input) << "Button " << button
+                       << (isDown ? " pressed" : " released");
+    if (isDown && !it->second.press)
+      it->second.clicked = true;
     it->second.press = isDown;
   }
 }
@@ -146,9 +151,10 @@ void MouseInput::callback(GLFWwindow *window, int button, int action,
                           int mods) {
   auto ctx = reinterpret_cast<Context *>(glfwGetWindowUserPointer(window));
   assert(ctx);
-  for (auto mouseInput : ctx->mouseInputs) {
-    mouseInput->setButtonState(button, action != GLFW_RELEASE);
-  }
+  ctx->inputEvents.push({.type = InputEventType::MouseButton,
+                         .isDown = action == GLFW_PRESS,
+                         .code = button,
+                         .timestamp = glfwGetTime()});
 }
 
 } // namespace SGEng
@@ -33,9 +33,13 @@ namespace SGEng {
 
 struct Context;
 
+// State of a button in the current frame, derived only from the input events
+// drained at its start
 struct ButtonState {
   bool press = false;
-  mutable bool longPress = false;
+  // Pressed at least once since the previous frame, also when it was released
+  // again before this one
+  bool clicked = false;
 };
 
 class MouseInput {
@@ -54,14 +58,17 @@ public:
   bool isLeftButtonClicked() const;
   bool isRightButtonClicked() const;
 
+  // Called by the game thread, before and while draining the input events of
+  // a frame
+  void beginFrame();
+  void setButtonState(int button, bool isDown);
+
   static void setup(Context &ctx, GLFWwindow *window);
 
 private:
   std::reference_wrapper<Context> ctx;
   std::map<int, ButtonState> buttons;
 
-  void setButtonState(int button, bool isDown);
-
   static void callback(GLFWwindow *window, int button, int action, int mods);
 };
 
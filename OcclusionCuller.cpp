@@ -0,0 +1,212 @@
+//===- OcclusionCuller.cpp --------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "OcclusionCuller.h"
+
+#include "GeometryArena.h"
+#include "TraceLog.h"
+#include "constants.h"
+#include <algorithm>
+#include <bit>
+#include <plog/Log.h>
+
+namespace SGEng {
+
+namespace {
+
+constexpr GLuint depthPyramidGroupSize{8};
+constexpr GLuint cullGroupSize{64};
+
+GLuint groupCount(GLuint size, GLuint groupSize) {
+  return (size + groupSize - 1) / groupSize;
+}
+
+} // namespace
+
+OcclusionCuller::~OcclusionCuller() { tryDestroy(); }
+
+bool OcclusionCuller::isInitialized() const {
+  return downsampleShader.isInitialized() && cullShader.isInitialized();
+}
+
+bool OcclusionCuller::tryInitialize(IFileManager &fileManager) {
+  if (!downsampleShader.tryInitializeCompute(fileManager,
+                                             defaultDepthPyramidShaderPath) ||
+      !cullShader.tryInitializeCompute(fileManager,
+                                       defaultOcclusionCullShaderPath)) {
+    PLOGE << "Occlusion culling disabled, compute shaders unavailable";
+    return false;
+  }
+
+  sourceLevel.initialize(downsampleShader, "source_level");
+  sourceSize.initialize(downsampleShader, "source_size");
+  previousViewProjection.initialize(cullShader, "previous_view_projection");
+  commandCount.initialize(cullShader, "command_count");
+  depthPyramidSize.initialize(cullShader, "hi_z_size");
+  depthPyramidLevels.initialize(cullShader, "hi_z_levels");
+  for (auto &slot : statistics)
+    slot.buffer.initialize();
+  return true;
+}
+
+bool OcclusionCuller::hasDepthPyramid() const { return _hasDepthPyramid; }
+
+bool OcclusionCuller::cull(const SSBO &commands, const SSBO &bounds,
+                           size_t commandCount, SSBO &output) {
+  if (!isInitialized() || !hasDepthPyramid() || commandCount == 0)
+    return false;
+
+  readStatistics();
+  StatisticsSlot &slot = statistics[nextStatistics];
+  nextStatistics = (nextStatistics + 1) % statistics.size();
+  // Still in flight after a whole ring of passes, its result is dropped
+  if (slot.fence) {
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+  }
+  GLuint zero{0};
+  slot.buffer.set(&zero, sizeof(zero));
+
+  output.reserve(commandCount * sizeof(DrawElementsIndirectCommand));
+  commands.bindBase(occlusionInputCommandsBindingIndex);
+  output.bindBase(occlusionOutputCommandsBindingIndex);
+  bounds.bindBase(occlusionBoundsBindingIndex);
+  slot.buffer.bindBase(occlusionStatisticsBindingIndex);
+  glBindTextureUnit(0, depthPyramid);
+
+  auto usageScope = cullShader.scopedUsage();
+  previousViewProjection.set(depthPyramidViewProjection);
+  this->commandCount.set(static_cast<GLuint>(commandCount));
+  depthPyramidSize.set(width, height);
+  depthPyramidLevels.set(levels);
+  cullShader.dispatch(
+      groupCount(static_cast<GLuint>(commandCount), cullGroupSize));
+
+  // The output is consumed as draw commands, the statistics are read back
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT |
+                  GL_BUFFER_UPDATE_BARRIER_BIT);
+  slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  return true;
+}
+
+void OcclusionCuller::buildDepthPyramid(const FBO &framebuffer,
+                                        const mat4gl &viewProjection) {
+  if (!isInitialized() || !framebuffer.isInitialized())
+    return;
+  if (framebuffer.getWidth() != width || framebuffer.getHeight() != height)
+    allocateDepthPyramid(framebuffer.getWidth(), framebuffer.getHeight());
+
+  auto usageScope = downsampleShader.scopedUsage();
+  for (GLsizei level = 0; level < levels; level++) {
+    // Level 0 copies the depth attachment, which cannot be bound as an image
+    if (level == 0) {
+      glBindTextureUnit(0, framebuffer.getDepthTexture());
+      sourceLevel.set(-1);
+      sourceSize.set(width, height);
+    } else {
+      glBindTextureUnit(0, depthPyramid);
+      sourceLevel.set(level - 1);
+      sourceSize.set(levelSize(level - 1));
+    }
+    glBindImageTexture(0, depthPyramid, level, GL_FALSE, 0, GL_WRITE_ONLY,
+                       GL_R32F);
+
+    ivec2gl size = levelSize(level);
+    downsampleShader.dispatch(
+        groupCount(static_cast<GLuint>(size.x), depthPyramidGroupSize),
+        groupCount(static_cast<GLuint>(size.y), depthPyramidGroupSize));
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+  }
+  // The depth attachment must not stay bound while the next frame renders
+  glBindTextureUnit(0, 0);
+
+  depthPyramidViewProjection = viewProjection;
+  _hasDepthPyramid = true;
+}
+
+size_t OcclusionCuller::getOccludedCount() const { return occludedCount; }
+
+void OcclusionCuller::tryDestroy() {
+  if (depthPyramid != 0 || isInitialized())
+    destroy();
+}
+
+void OcclusionCuller::destroy() {
+  glDeleteTextures(1, &depthPyramid);
+  depthPyramid = 0;
+  width = 0;
+  height = 0;
+  levels = 0;
+  _hasDepthPyramid = false;
+  downsampleShader.tryDestroy();
+  cullShader.tryDestroy();
+  destroyStatistics();
+}
+
+void OcclusionCuller::readStatistics() {
+  // Passes complete in order, so the first one still running ends the search
+  for (size_t i = 0; i < statistics.size(); i++) {
+    StatisticsSlot &slot =
+        statistics[(nextStatistics + i) % statistics.size()];
+    if (!slot.fence)
+      continue;
+    if (glClientWaitSync(slot.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+      break;
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    GLuint count{0};
+    slot.buffer.get(&count, sizeof(count));
+    occludedCount = count;
+  }
+}
+
+void OcclusionCuller::destroyStatistics() {
+  for (auto &slot : statistics) {
+    if (slot.fence)
+      glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    slot.buffer.tryDestroy();
+  }
+  nextStatistics = 0;
+}
+
+void OcclusionCuller::allocateDepthPyramid(GLsizei width, GLsizei height) {
+  glDeleteTextures(1, &depthPyramid);
+  this->width = width;
+  this->height = height;
+  levels = static_cast<GLsizei>(std::bit_width(
+      static_cast<unsigned int>(std::max(width, height))));
+  glCreateTextures(GL_TEXTURE_2D, 1, &depthPyramid);
+  glTextureStorage2D(depthPyramid, levels, GL_R32F, width, height);
+  _hasDepthPyramid = false;
+  SGENG_TRACE(Culling) << "Depth pyramid allocated: " << width << "x"
+                       << height << ", " << levels << " levels";
+}
+
+ivec2gl OcclusionCuller::levelSize(GLsizei level) const {
+  return {std::max(width >> level, 1), std::max(height >> level, 1)};
+}
+
+} // namespace SGEng
@@ -0,0 +1,111 @@
+//===- OcclusionCuller.h ----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "FBO.h"
+#include "IFileManager.h"
+#include "SSBO.h"
+#include "Shader.h"
+#include "constants.h"
+#include "types.h"
+#include "uniforms.h"
+#include <array>
+#include <glad/gl.h>
+
+namespace SGEng {
+
+// Bounds of the draw command with the same index, padded to the std430 layout
+struct CommandBounds {
+  vec4gl min;
+  vec4gl max;
+};
+
+// Rejects draws hidden behind the depth of the previous frame. After a frame
+// is rendered, its depth buffer is reduced into a hierarchical depth buffer
+// (Hi-Z): a mip chain where every texel holds the farthest depth of the texels
+// it covers. Next frame a compute pass compares the nearest depth of every
+// draw's bounds with the pyramid level where the bounds cover at most 2x2
+// texels, and zeroes the instance count of draws that are certainly occluded.
+class OcclusionCuller {
+public:
+  OcclusionCuller() = default;
+  OcclusionCuller(const OcclusionCuller &culler) = delete;
+  OcclusionCuller &operator=(const OcclusionCuller &culler) = delete;
+  ~OcclusionCuller();
+
+  bool isInitialized() const;
+  bool tryInitialize(IFileManager &fileManager);
+  bool hasDepthPyramid() const;
+  // Writes every command to output, with the instance count of occluded draws
+  // set to zero. Returns false, leaving output untouched, if no depth pyramid
+  // has been built yet.
+  bool cull(const SSBO &commands, const SSBO &bounds, size_t commandCount,
+            SSBO &output);
+  // Builds the pyramid from the depth attachment of the framebuffer, which
+  // must have been rendered with the given view-projection matrix
+  void buildDepthPyramid(const FBO &framebuffer, const mat4gl &viewProjection);
+  // Draws occluded by the last completed pass. Every pass counts into its own
+  // buffer, read back only once the fence after the pass has signaled, so
+  // that the CPU never waits for the compute pass.
+  size_t getOccludedCount() const;
+  void tryDestroy();
+  void destroy();
+
+private:
+  Shader downsampleShader;
+  Uniform1i sourceLevel;
+  Uniform2i sourceSize;
+
+  Shader cullShader;
+  UniformMat4 previousViewProjection;
+  Uniform1u commandCount;
+  Uniform2i depthPyramidSize;
+  Uniform1i depthPyramidLevels;
+
+  GLuint depthPyramid{0};
+  GLsizei width{0};
+  GLsizei height{0};
+  GLsizei levels{0};
+  mat4gl depthPyramidViewProjection{1.0f};
+  bool _hasDepthPyramid{false};
+
+  struct StatisticsSlot {
+    SSBO buffer;
+    GLsync fence{nullptr};
+  };
+
+  // Ring of the statistics of the passes in flight, oldest at nextStatistics
+  std::array<StatisticsSlot, maxFramesInFlight> statistics;
+  size_t nextStatistics{0};
+  size_t occludedCount{0};
+
+  void readStatistics();
+  void destroyStatistics();
+  void allocateDepthPyramid(GLsizei width, GLsizei height);
+  ivec2gl levelSize(GLsizei level) const;
+};
+
+} // namespace SGEng
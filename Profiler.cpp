@@ -0,0 +1,276 @@
+//===- Profiler.cpp ---------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "Profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+namespace SGEng {
+
+namespace {
+
+void writeJSONString(std::ostringstream &out, std::string_view text) {
+  out << '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      out << '\\';
+    out << c;
+  }
+  out << '"';
+}
+
+} // namespace
+
+Profiler &Profiler::get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler() : gpuBuffer{std::make_shared<ThreadBuffer>()} {
+  gpuBuffer->threadId = gpuThreadId;
+  gpuBuffer->threadName = "GPU";
+}
+
+void Profiler::setEnabled(bool enabled) {
+  this->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::isEnabled() const {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(std::string name) {
+  ThreadBuffer &buffer = currentThreadBuffer();
+  std::lock_guard lock(buffersMutex);
+  buffer.threadName = std::move(name);
+}
+
+void Profiler::recordScope(const char *name, Clock::time_point start,
+                           Clock::time_point end) {
+  currentThreadBuffer().record(name, sinceStart(start),
+                               sinceStart(end) - sinceStart(start));
+}
+
+void Profiler::recordGpuPass(const char *name, Clock::time_point submitted,
+                             std::chrono::nanoseconds duration) {
+  gpuBuffer->record(name, sinceStart(submitted), duration.count());
+}
+
+std::string Profiler::exportChromeTrace(double lastSeconds) const {
+  struct Event {
+    const char *name;
+    int64_t start;
+    int64_t duration;
+    uint32_t threadId;
+  };
+
+  std::vector<Event> events;
+  std::ostringstream out;
+  out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  bool isFirst{true};
+
+  std::lock_guard lock(buffersMutex);
+  std::vector<const ThreadBuffer *> buffers;
+  for (const auto &buffer : threadBuffers)
+    buffers.push_back(buffer.get());
+  buffers.push_back(gpuBuffer.get());
+
+  int64_t now = sinceStart(Clock::now());
+  int64_t from = lastSeconds > 0.0
+                     ? now - static_cast<int64_t>(lastSeconds * 1e9)
+                     : std::numeric_limits<int64_t>::min();
+
+  for (const ThreadBuffer *buffer : buffers) {
+    if (!isFirst)
+      out << ',';
+    isFirst = false;
+    out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+        << buffer->threadId << R"(,"args":{"name":)";
+    writeJSONString(out, buffer->threadName);
+    out << "}}";
+
+    uint64_t last = buffer->writeIndex.load(std::memory_order_acquire);
+    uint64_t first = last > eventsPerThread ? last - eventsPerThread : 0;
+    size_t firstEvent = events.size();
+    for (uint64_t i = first; i < last; i++) {
+      const EventSlot &slot = buffer->events[i % eventsPerThread];
+      events.push_back({slot.name.load(std::memory_order_relaxed),
+                        slot.start.load(std::memory_order_relaxed),
+                        slot.duration.load(std::memory_order_relaxed),
+                        buffer->threadId});
+    }
+    // Slots claimed by the producer in the meantime may hold a mix of old and
+    // new fields
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claimed = buffer->claimIndex.load(std::memory_order_relaxed);
+    if (claimed > first + eventsPerThread) {
+      size_t overwritten = std::min<uint64_t>(
+          claimed - first - eventsPerThread, last - first);
+      events.erase(events.begin() + static_cast<ptrdiff_t>(firstEvent),
+                   events.begin() +
+                       static_cast<ptrdiff_t>(firstEvent + overwritten));
+    }
+  }
+
+  for (const Event &event : events) {
+    if (event.start < from || !event.name)
+      continue;
+    out << R"(,{"name":)";
+    writeJSONString(out, event.name);
+    out << R"(,"ph":"X","pid":1,"tid":)" << event.threadId
+        << R"(,"ts":)" << static_cast<double>(event.start) / 1000.0
+        << R"(,"dur":)" << static_cast<double>(event.duration) / 1000.0
+        << '}';
+  }
+  out << "]}";
+  return out.str();
+}
+
+Profiler::ThreadBuffer &Profiler::currentThreadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    std::lock_guard lock(buffersMutex);
+    buffer->threadId = static_cast<uint32_t>(threadBuffers.size() + 1);
+    buffer->threadName = "Thread " + std::to_string(buffer->threadId);
+    threadBuffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+int64_t Profiler::sinceStart(Clock::time_point time) const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time -
+                                                              startTime)
+      .count();
+}
+
+void Profiler::ThreadBuffer::record(const char *name, int64_t start,
+                                    int64_t duration) {
+  uint64_t index = writeIndex.load(std::memory_order_relaxed);
+  claimIndex.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  EventSlot &slot = events[index % eventsPerThread];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.start.store(start, std::memory_order_relaxed);
+  slot.duration.store(duration, std::memory_order_relaxed);
+  writeIndex.store(index + 1, std::memory_order_release);
+}
+
+ProfileScope::ProfileScope(const char *name)
+    : name{name}, isRecording{Profiler::get().isEnabled()} {
+  if (isRecording)
+    start = Profiler::Clock::now();
+}
+
+ProfileScope::~ProfileScope() {
+  if (isRecording)
+    Profiler::get().recordScope(name, start, Profiler::Clock::now());
+}
+
+GpuPassTimers::GpuPassTimers(GpuPassTimers &&timers) noexcept
+    : passes{std::move(timers.passes)}, frameParity{timers.frameParity} {
+  timers.passes.clear();
+  timers.activePass.reset();
+}
+
+GpuPassTimers &GpuPassTimers::operator=(GpuPassTimers &&timers) noexcept {
+  if (this != &timers) {
+    destroy();
+    std::swap(passes, timers.passes);
+    frameParity = timers.frameParity;
+    timers.activePass.reset();
+  }
+  return *this;
+}
+
+GpuPassTimers::~GpuPassTimers() { destroy(); }
+
+void GpuPassTimers::beginFrame() {
+  frameParity ^= 1;
+  for (auto &pass : passes) {
+    if (!pass.isPending[frameParity])
+      continue;
+    pass.isPending[frameParity] = false;
+    GLuint query = pass.queries[frameParity];
+    GLint isAvailable{GL_FALSE};
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+    // Waiting for the result would stall, it is dropped instead
+    if (isAvailable == GL_FALSE)
+      continue;
+    GLuint64 elapsed{0};
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+    Profiler::get().recordGpuPass(pass.name, pass.submitted[frameParity],
+                                  std::chrono::nanoseconds(elapsed));
+  }
+}
+
+void GpuPassTimers::begin(const char *name) {
+  if (activePass)
+    end();
+
+  auto it = std::find_if(passes.begin(), passes.end(),
+                         [&](const Pass &pass) { return pass.name == name; });
+  if (it == passes.end()) {
+    Pass pass{.name = name};
+    glCreateQueries(GL_TIME_ELAPSED, 2, pass.queries.data());
+    passes.push_back(pass);
+    it = passes.end() - 1;
+  }
+  activePass = static_cast<size_t>(it - passes.begin());
+  it->submitted[frameParity] = Profiler::Clock::now();
+  glBeginQuery(GL_TIME_ELAPSED, it->queries[frameParity]);
+}
+
+void GpuPassTimers::end() {
+  if (!activePass)
+    return;
+  glEndQuery(GL_TIME_ELAPSED);
+  passes[*activePass].isPending[frameParity] = true;
+  activePass.reset();
+}
+
+void GpuPassTimers::destroy() {
+  for (auto &pass : passes)
+    glDeleteQueries(2, pass.queries.data());
+  passes.clear();
+  activePass.reset();
+}
+
+GpuPassScope::GpuPassScope(GpuPassTimers &timers, const char *name)
+    : timers{timers}, isRecording{Profiler::get().isEnabled()} {
+  if (isRecording)
+    timers.begin(name);
+}
+
+GpuPassScope::~GpuPassScope() {
+  if (isRecording)
+    timers.end();
+}
+
+} // namespace SGEng
@@ -0,0 +1,169 @@
+//===- Profiler.h -----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <glad/gl.h>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace SGEng {
+
+// Collects timed scopes of every thread and GPU pass timings, and exports
+// them as a Chrome trace (chrome://tracing, Perfetto). Each thread records
+// into a ring buffer of its own, so recording takes no locks and keeps only
+// the most recent events. Names have to be string literals, or otherwise
+// outlive the profiler.
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Events kept per thread, older ones are overwritten
+  static constexpr size_t eventsPerThread{16384};
+  // Thread ID of GPU pass events in the trace
+  static constexpr uint32_t gpuThreadId{0};
+
+  static Profiler &get();
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+  // Name of the calling thread in the trace
+  void setThreadName(std::string name);
+
+  void recordScope(const char *name, Clock::time_point start,
+                   Clock::time_point end);
+  // Records a GPU pass measured to take duration, shown starting at the CPU
+  // time when the pass was submitted
+  void recordGpuPass(const char *name, Clock::time_point submitted,
+                     std::chrono::nanoseconds duration);
+
+  // Chrome trace JSON of the recorded events, of the last given number of
+  // seconds or everything still in the buffers when zero
+  std::string exportChromeTrace(double lastSeconds = 0.0) const;
+
+private:
+  // Fields are atomic, so that exporting can read slots that are being
+  // overwritten, the exporter discards such slots by their index
+  struct EventSlot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> duration{0};
+  };
+
+  // Single-producer ring. The producer claims an index before overwriting
+  // its slot and publishes it afterwards, so that a reader can tell which of
+  // the slots it read may have changed under it.
+  struct ThreadBuffer {
+    uint32_t threadId{0};
+    std::string threadName;
+    std::atomic<uint64_t> claimIndex{0};
+    std::atomic<uint64_t> writeIndex{0};
+    std::array<EventSlot, eventsPerThread> events;
+
+    void record(const char *name, int64_t start, int64_t duration);
+  };
+
+  std::atomic<bool> enabled{false};
+  Clock::time_point startTime{Clock::now()};
+
+  // Registration happens once per thread, exporting holds the mutex too
+  mutable std::mutex buffersMutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+  std::shared_ptr<ThreadBuffer> gpuBuffer;
+
+  Profiler();
+  ThreadBuffer &currentThreadBuffer();
+  int64_t sinceStart(Clock::time_point time) const;
+};
+
+// Records the lifetime of the scope it is declared in, when profiling is
+// enabled. Nested scopes of a thread show up nested in the trace.
+class ProfileScope {
+public:
+  explicit ProfileScope(const char *name);
+  ProfileScope(const ProfileScope &scope) = delete;
+  ProfileScope &operator=(const ProfileScope &scope) = delete;
+  ~ProfileScope();
+
+private:
+  const char *name;
+  Profiler::Clock::time_point start{};
+  bool isRecording;
+};
+
+// GL_TIME_ELAPSED queries around GPU passes. Every pass has two queries used
+// in alternate frames, and the result of a query is only collected two
+// frames after it was issued, and only if it is available, so reading never
+// stalls the pipeline. Elapsed time queries cannot nest, passes neither.
+// Used on the thread owning the OpenGL context.
+class GpuPassTimers {
+public:
+  GpuPassTimers() = default;
+  GpuPassTimers(const GpuPassTimers &timers) = delete;
+  GpuPassTimers &operator=(const GpuPassTimers &timers) = delete;
+  GpuPassTimers(GpuPassTimers &&timers) noexcept;
+  GpuPassTimers &operator=(GpuPassTimers &&timers) noexcept;
+  ~GpuPassTimers();
+
+  // Collects the results of the frame before the previous one
+  void beginFrame();
+  void begin(const char *name);
+  void end();
+  void destroy();
+
+private:
+  struct Pass {
+    const char *name;
+    std::array<GLuint, 2> queries{};
+    std::array<Profiler::Clock::time_point, 2> submitted{};
+    std::array<bool, 2> isPending{};
+  };
+
+  std::vector<Pass> passes;
+  size_t frameParity{0};
+  std::optional<size_t> activePass;
+};
+
+// Times the GPU work submitted in the scope it is declared in
+class GpuPassScope {
+public:
+  GpuPassScope(GpuPassTimers &timers, const char *name);
+  GpuPassScope(const GpuPassScope &scope) = delete;
+  GpuPassScope &operator=(const GpuPassScope &scope) = delete;
+  ~GpuPassScope();
+
+private:
+  GpuPassTimers &timers;
+  bool isRecording;
+};
+
+} // namespace SGEng
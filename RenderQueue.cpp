@@ -0,0 +1,103 @@
+//===- RenderQueue.cpp ------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "RenderQueue.h"
+
+#include <array>
+#include <bit>
+
+namespace SGEng {
+
+namespace {
+
+constexpr uint64_t mask(unsigned bits) { return (uint64_t{1} << bits) - 1; }
+
+} // namespace
+
+uint64_t RenderQueue::makeKey(RenderPass pass, GLuint shader, bool faceCulling,
+                              GLuint vao, uint32_t material, float depth) {
+  // Bit patterns of non-negative floats are ordered like the floats, so the
+  // distance needs no range - only its low mantissa bits are dropped
+  uint32_t depthBitsValue = std::bit_cast<uint32_t>(depth > 0.f ? depth : 0.f);
+  uint64_t quantizedDepth = depthBitsValue >> (32 - depthBits);
+
+  uint64_t key = static_cast<uint64_t>(pass) & mask(passBits);
+  key = (key << shaderBits) | (shader & mask(shaderBits));
+  // Culled meshes go first, matching the default of most meshes
+  key = (key << cullingBits) | (faceCulling ? 0 : 1);
+  key = (key << vaoBits) | (vao & mask(vaoBits));
+  key = (key << materialBits) | (material & mask(materialBits));
+  key = (key << depthBits) | quantizedDepth;
+  return key;
+}
+
+void RenderQueue::clear() { items.clear(); }
+
+void RenderQueue::push(uint64_t key, const ModelSnapshot &model,
+                       const Mesh &mesh) {
+  items.push_back({.key = key, .model = &model, .mesh = &mesh});
+}
+
+// LSD radix sort over 8-bit digits. Passes in which every key has the same
+// digit are skipped, which is common for the high bits of the key.
+void RenderQueue::sort() {
+  constexpr unsigned digitBits{8};
+  constexpr size_t bucketCount{size_t{1} << digitBits};
+
+  if (items.size() < 2)
+    return;
+  sortBuffer.resize(items.size());
+
+  for (unsigned shift = 0; shift < 64; shift += digitBits) {
+    std::array<size_t, bucketCount> offsets{};
+    for (const auto &item : items)
+      offsets[(item.key >> shift) & (bucketCount - 1)]++;
+    if (offsets[(items.front().key >> shift) & (bucketCount - 1)] ==
+        items.size())
+      continue;
+
+    size_t offset{0};
+    for (auto &bucketOffset : offsets) {
+      size_t count = bucketOffset;
+      bucketOffset = offset;
+      offset += count;
+    }
+    for (const auto &item : items)
+      sortBuffer[offsets[(item.key >> shift) & (bucketCount - 1)]++] = item;
+    items.swap(sortBuffer);
+  }
+}
+
+size_t RenderQueue::size() const { return items.size(); }
+
+bool RenderQueue::empty() const { return items.empty(); }
+
+const RenderItem *RenderQueue::begin() const { return items.data(); }
+
+const RenderItem *RenderQueue::end() const {
+  return items.data() + items.size();
+}
+
+} // namespace SGEng
@@ -0,0 +1,78 @@
+//===- RenderQueue.h --------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <glad/gl.h>
+#include <vector>
+
+namespace SGEng {
+
+struct Mesh;
+struct ModelSnapshot;
+
+enum class RenderPass : uint8_t { Opaque = 0, Transparent = 1 };
+
+struct RenderItem {
+  uint64_t key;
+  const ModelSnapshot *model;
+  const Mesh *mesh;
+};
+
+// Flat list of draw items ordered by a packed 64-bit sort key. From the most
+// to the least significant bits the key holds the render pass, shader, face
+// culling state, VAO, material and quantized camera distance, so sorting it
+// groups draws by the cost of switching between them and orders draws sharing
+// all state front to back.
+class RenderQueue {
+public:
+  static constexpr unsigned passBits{2};
+  static constexpr unsigned shaderBits{8};
+  static constexpr unsigned cullingBits{1};
+  static constexpr unsigned vaoBits{16};
+  static constexpr unsigned materialBits{13};
+  static constexpr unsigned depthBits{24};
+  static constexpr unsigned keyBits{passBits + shaderBits + cullingBits +
+                                    vaoBits + materialBits + depthBits};
+  static_assert(keyBits == 64, "Sort key fields have to fill 64 bits");
+
+  static uint64_t makeKey(RenderPass pass, GLuint shader, bool faceCulling,
+                          GLuint vao, uint32_t material, float depth);
+
+  void clear();
+  void push(uint64_t key, const ModelSnapshot &model, const Mesh &mesh);
+  void sort();
+  size_t size() const;
+  bool empty() const;
+  const RenderItem *begin() const;
+  const RenderItem *end() const;
+
+private:
+  std::vector<RenderItem> items;
+  std::vector<RenderItem> sortBuffer;
+};
+
+} // namespace SGEng
@@ -0,0 +1,154 @@
+//===- RenderThread.cpp -----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "RenderThread.h"
+
+#include "IRenderer.h"
+#include "Profiler.h"
+#include "Scene.h"
+#include "TraceLog.h"
+#include "Window.h"
+#include "constants.h"
+#include <algorithm>
+#include <utility>
+
+namespace SGEng {
+
+RenderThread::RenderThread(Window &window, unsigned int framesInFlight)
+    : window{window},
+      snapshots(std::clamp(framesInFlight, 1u, maxFramesInFlight)) {
+  for (auto &snapshot : snapshots)
+    freeSnapshots.push_back(&snapshot);
+  thread = std::jthread([this](std::stop_token stopToken) { run(stopToken); });
+  SGENG_TRACE(RenderThread)
+      << "Render thread started with " << snapshots.size()
+      << " frames in flight";
+}
+
+RenderThread::~RenderThread() {
+  thread.request_stop();
+  thread.join();
+  SGENG_TRACE(RenderThread) << "Render thread stopped";
+}
+
+void RenderThread::submit(const Scene &scene) {
+  FrameSnapshot *snapshot{nullptr};
+  {
+    std::unique_lock lock(mutex);
+    condition.wait(lock, [this] { return !freeSnapshots.empty(); });
+    snapshot = freeSnapshots.front();
+    freeSnapshots.pop_front();
+  }
+
+  // Nothing else touches a slot between taking it from the free list and
+  // putting it on the ready one, so it is filled without holding the lock
+  window.getRenderer()->captureFrame(scene, *snapshot);
+  snapshot->frameIndex = nextFrameIndex++;
+
+  {
+    std::lock_guard lock(mutex);
+    readyFrames.push_back({.scene = &scene, .snapshot = snapshot});
+  }
+  condition.notify_all();
+}
+
+void RenderThread::runAndWait(std::function<void()> task) {
+  // Waiting for itself would never return
+  if (std::this_thread::get_id() == thread.get_id()) {
+    task();
+    return;
+  }
+
+  std::packaged_task<void()> packagedTask(std::move(task));
+  auto future = packagedTask.get_future();
+  {
+    std::lock_guard lock(mutex);
+    tasks.push_back(std::move(packagedTask));
+  }
+  condition.notify_all();
+  future.get();
+}
+
+FrameLatencyStats RenderThread::takeLatencyStats() {
+  std::lock_guard lock(mutex);
+  return std::exchange(latencyStats, {});
+}
+
+void RenderThread::run(std::stop_token stopToken) {
+  Profiler::get().setThreadName("Render");
+  window.makeContextCurrent();
+
+  std::unique_lock lock(mutex);
+  while (true) {
+    // Tasks and submitted frames are still handled after a stop request, the
+    // thread only exits once there is nothing left to do
+    condition.wait(lock, stopToken,
+                   [this] { return !tasks.empty() || !readyFrames.empty(); });
+
+    // Frames submitted before a task are rendered first, they were captured
+    // with the state the task may be about to change
+    if (!readyFrames.empty()) {
+      ReadyFrame frame = readyFrames.front();
+      readyFrames.pop_front();
+      lock.unlock();
+      window.renderFrame(*frame.scene, *frame.snapshot);
+      frame.snapshot->releaseMeshes();
+      lock.lock();
+      recordLatency(*frame.snapshot);
+      freeSnapshots.push_back(frame.snapshot);
+      condition.notify_all();
+      continue;
+    }
+
+    if (!tasks.empty()) {
+      auto task = std::move(tasks.front());
+      tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+      continue;
+    }
+
+    break;
+  }
+  lock.unlock();
+
+  window.releaseContext();
+}
+
+void RenderThread::recordLatency(const FrameSnapshot &snapshot) {
+  std::chrono::duration<double, std::milli> latency =
+      FrameSnapshot::Clock::now() - snapshot.captureTime;
+  latencyStats.frameCount++;
+  latencyStats.mean +=
+      (latency.count() - latencyStats.mean) /
+      static_cast<double>(latencyStats.frameCount);
+  latencyStats.max = std::max(latencyStats.max, latency.count());
+  SGENG_TRACE(RenderThread) << "Frame " << snapshot.frameIndex
+                            << " presented after " << latency.count()
+                            << " ms";
+}
+
+} // namespace SGEng
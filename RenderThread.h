@@ -0,0 +1,103 @@
+//===- RenderThread.h -------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "FrameSnapshot.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SGEng {
+
+class Window;
+struct Scene;
+
+// Time from capturing frames on the game thread to presenting them, for the
+// frames presented since the last reset, in milliseconds
+struct FrameLatencyStats {
+  uint64_t frameCount{0};
+  double mean{0.0};
+  double max{0.0};
+};
+
+// Thread owning the OpenGL context of a window while the game thread
+// simulates the next frames. Frames are handed over as snapshots taken from a
+// fixed ring of framesInFlight slots: the game thread blocks in submit() when
+// every slot is waiting to be rendered, which bounds both memory and the
+// latency it can run ahead by.
+//
+// Scene state read while rendering (shaders, mesh buffers) must not be
+// changed by the game thread while the render thread is running. Changes to
+// it, and anything else that needs the context, go through runAndWait().
+// Meshes referenced by a snapshot, including those of models removed from the
+// scene, are released on the render thread after the snapshot is rendered.
+class RenderThread {
+public:
+  RenderThread(Window &window, unsigned int framesInFlight);
+  RenderThread(const RenderThread &renderThread) = delete;
+  RenderThread &operator=(const RenderThread &renderThread) = delete;
+  // Renders the frames already submitted and releases the context
+  ~RenderThread();
+
+  // Captures a frame of the scene, which has to outlive the render thread
+  void submit(const Scene &scene);
+  // Runs the task on the render thread between frames and rethrows its
+  // exception, if any
+  void runAndWait(std::function<void()> task);
+  // Returns the latency statistics and resets them
+  FrameLatencyStats takeLatencyStats();
+
+private:
+  struct ReadyFrame {
+    const Scene *scene;
+    FrameSnapshot *snapshot;
+  };
+
+  Window &window;
+  std::vector<FrameSnapshot> snapshots;
+  uint64_t nextFrameIndex{0};
+
+  // Guarded by mutex
+  std::mutex mutex;
+  std::condition_variable_any condition;
+  std::deque<FrameSnapshot *> freeSnapshots;
+  std::deque<ReadyFrame> readyFrames;
+  std::deque<std::packaged_task<void()>> tasks;
+  FrameLatencyStats latencyStats;
+
+  // Declared last, so that it stops before the state above is destroyed
+  std::jthread thread;
+
+  void run(std::stop_token stopToken);
+  void recordLatency(const FrameSnapshot &snapshot);
+};
+
+} // namespace SGEng
@@ -26,96 +26,404 @@
 #include "Renderer.h"
 
 #include "Config.h"
+#include "GLState.h"
+#include "JobSystem.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "Profiler.h"
 #include "Scene.h"
+#include "TraceLog.h"
 #include "constants.h"
 #include "exceptions.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <glm/geometric.hpp>
 #include <plog/Log.h>
 
 namespace SGEng {
 
+namespace {
+
+// Boxes tested by a single culling job
+constexpr size_t cullingGrainSize{4096};
+
+// Models do not share material objects, so draws with equal material
+// parameters are grouped by a hash of these parameters instead
+uint32_t materialKey(const MaterialUniforms &material) {
+  vec3gl color = material.color.get();
+  uint32_t hash{2166136261u};
+  for (uint32_t word : {std::bit_cast<uint32_t>(color.r),
+                        std::bit_cast<uint32_t>(color.g),
+                        std::bit_cast<uint32_t>(color.b),
+                        material.shininess.get()})
+    hash = (hash ^ word) * 16777619u;
+  return hash ^ (hash >> 16);
+}
+
+} // namespace
+
 Renderer::Renderer(Context &ctx, Window &window) : IRenderer(ctx, window) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Renderer constructor...";
+  SGENG_TRACE(Lifetime) << "Renderer constructor...";
   if (!ctx.isGLInitialized)
     ctx.initializeGL();
 }
 
-Renderer::Renderer(const Renderer &renderer)
-    : IRenderer(ctx, window), enabledFaceCulling{renderer.enabledFaceCulling} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Renderer copy constructor...";
+Renderer::~Renderer() { PLOGV << "Renderer destructor..."; }
+
+void Renderer::drawElements(const Shader &shader, const VAO &vao,
+                            GLsizei count, GLenum indexType) {
+  vao.bind();
+  glDrawElements(GL_TRIANGLES, count, indexType, nullptr);
+  SGENG_TRACE(Draw) << "Elements drawn";
 }
 
-Renderer &Renderer::operator=(const Renderer &renderer) {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "Renderer copy assignment...";
-  ctx = renderer.ctx;
-  window = renderer.window;
-  enabledFaceCulling = renderer.enabledFaceCulling;
-  return *this;
+void Renderer::drawElementsInstanced(const Shader &shader, const VAO &vao,
+                                     GLsizei count, GLenum indexType,
+                                     GLsizei instanceCount,
+                                     GLuint baseInstance) {
+  vao.bind();
+  glDrawElementsInstancedBaseInstance(GL_TRIANGLES, count, indexType, nullptr,
+                                      instanceCount, baseInstance);
+  SGENG_TRACE(Draw) << "Elements drawn (" << instanceCount << " instances)";
 }
 
-Renderer::Renderer(Renderer &&renderer) noexcept
-    : IRenderer(ctx, window), enabledFaceCulling{renderer.enabledFaceCulling} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Renderer move constructor...";
-  renderer.enabledFaceCulling = false;
+void Renderer::multiDrawElementsIndirect(const Shader &shader, const VAO &vao,
+                                         size_t firstCommand,
+                                         GLsizei drawCount, GLenum indexType) {
+  vao.bind();
+  glMultiDrawElementsIndirect(
+      GL_TRIANGLES, indexType,
+      reinterpret_cast<const void *>(firstCommand *
+                                     sizeof(DrawElementsIndirectCommand)),
+      drawCount, 0);
+  SGENG_TRACE(Draw) << "Elements drawn (" << drawCount << " commands)";
+}
+
+void Renderer::update() { IRenderer::update(); }
+
+void Renderer::render(const Scene &scene) {
+  ProfileScope profileScope("Renderer::render");
+  captureFrame(scene, frameSnapshot);
+  renderFrame(scene, frameSnapshot);
+  frameSnapshot.releaseMeshes();
+}
+
+void Renderer::captureFrame(const Scene &scene, FrameSnapshot &snapshot) {
+  ProfileScope profileScope("Renderer::captureFrame");
+  cullModels(scene);
+  cullingStats.occludedDraws = occludedDraws;
+
+  snapshot.clear();
+  snapshot.captureTime = FrameSnapshot::Clock::now();
+  snapshot.frameData = scene.makeFrameData();
+  scene.takeReleasedMeshes(snapshot.releasedMeshes);
+  for (size_t i = 0; i < scene.models.size(); i++)
+    if (modelVisibility[i])
+      snapshot.addModel(scene.models[i]);
 }
 
-Renderer &Renderer::operator=(Renderer &&renderer) noexcept {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "Renderer move assignment...";
-  if (this != &renderer) {
-    std::swap(this->ctx, renderer.ctx);
-    std::swap(this->window, renderer.window);
-    enabledFaceCulling = renderer.enabledFaceCulling;
-    renderer.enabledFaceCulling = false;
+void Renderer::renderFrame(const Scene &scene, const FrameSnapshot &snapshot) {
+  ProfileScope profileScope("Renderer::renderFrame");
+  if (Profiler::get().isEnabled())
+    gpuPassTimers.beginFrame();
+  scene.uploadFrameData(snapshot.frameData);
+
+  switch (ctx.get().cfg.renderingMode) {
+  case RenderingMode::Indirect:
+    if (scene.instancedShader.isInitialized()) {
+      renderIndirect(scene, snapshot);
+      break;
+    }
+    [[fallthrough]];
+  case RenderingMode::Instanced:
+    if (scene.instancedShader.isInitialized()) {
+      renderInstanced(scene, snapshot);
+      break;
+    }
+    [[fallthrough]];
+  case RenderingMode::Direct:
+    renderDirect(scene, snapshot);
+    break;
   }
-  return *this;
 }
 
-Renderer::~Renderer() { PLOGV << "Renderer destructor..."; }
+const CullingStats &Renderer::getCullingStats() const { return cullingStats; }
 
-void Renderer::drawElements(const Shader &shader, const VAO &vao,
-                            GLsizei count) {
-  vao.bind();
-  glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
-  PLOGV_IF(LOG_DRAW) << "Elements drawn";
-  vao.unbind();
+void Renderer::cullModels(const Scene &scene) {
+  ProfileScope profileScope("Renderer::cullModels");
+  Frustum frustum =
+      Frustum::fromMatrix(scene.projectionMatrix * scene.viewMatrix);
+  modelVisibility.resize(scene.models.size());
+
+  if (scene.spatialIndex.size() == scene.models.size()) {
+    // Every model is indexed, so whole subtrees can be accepted or rejected
+    // at once
+    visibleModelIndices.clear();
+    scene.spatialIndex.query(frustum, visibleModelIndices);
+    std::fill(modelVisibility.begin(), modelVisibility.end(), 0);
+    for (size_t index : visibleModelIndices)
+      modelVisibility[index] = 1;
+    cullingStats.visibleModels = visibleModelIndices.size();
+  } else {
+    cullingBoxes.clear();
+    for (const auto &model : scene.models)
+      cullingBoxes.push(model.bounds.aabb);
+    std::atomic<size_t> visibleModels{0};
+    ctx.get().getJobSystem().parallelFor(
+        0, cullingBoxes.size(), cullingGrainSize,
+        [&](size_t first, size_t last) {
+          visibleModels += frustum.intersects(cullingBoxes, first, last,
+                                              modelVisibility);
+        });
+    cullingStats.visibleModels = visibleModels;
+  }
+  cullingStats.culledModels =
+      scene.models.size() - cullingStats.visibleModels;
+  SGENG_TRACE(Culling) << "Models visible: " << cullingStats.visibleModels
+                       << ", culled: " << cullingStats.culledModels;
 }
 
-void Renderer::update() { IRenderer::update(); }
+bool Renderer::prepareOcclusionCulling() {
+  // The depth pyramid is built from the offscreen framebuffer, because the
+  // depth buffer of the default framebuffer cannot be sampled
+  if (!ctx.get().cfg.occlusionCulling ||
+      !window.get().getOffscreenFramebuffer().isInitialized())
+    return false;
+  if (!occlusionCuller.isInitialized() && !occlusionCullerFailed)
+    occlusionCullerFailed =
+        !occlusionCuller.tryInitialize(*ctx.get().fileManager);
+  return occlusionCuller.isInitialized();
+}
+
+void Renderer::setFaceCulling(bool enable) {
+  GLState::current().setFaceCulling(enable);
+}
+
+void Renderer::usePositionQuantization(
+    const PositionQuantization &quantization) {
+  const auto &[scale, offset] = quantization;
+  if (GLState::current().needsUniformUpload(positionScaleLocation, scale))
+    glUniform3f(positionScaleLocation, scale.x, scale.y, scale.z);
+  if (GLState::current().needsUniformUpload(positionOffsetLocation, offset))
+    glUniform3f(positionOffsetLocation, offset.x, offset.y, offset.z);
+}
+
+void Renderer::renderDirect(const Scene &scene,
+                            const FrameSnapshot &snapshot) {
+  renderQueue.clear();
+  for (const auto &model : snapshot.getModels()) {
+    uint32_t material = materialKey(model.material);
+    float depth = glm::distance(snapshot.frameData.cameraPosition,
+                                vec3gl(model.modelMatrix.get()[3]));
+    for (const auto &mesh : model.meshes)
+      renderQueue.push(RenderQueue::makeKey(RenderPass::Opaque,
+                                            scene.shader.getId(),
+                                            mesh->enableFaceCulling,
+                                            mesh->vao.getId(), material, depth),
+                       model, *mesh);
+  }
+  renderQueue.sort();
 
-void Renderer::render(const Scene &scene) {
   auto usageScope = scene.shader.scopedUsage();
+  GpuPassScope gpuPassScope(gpuPassTimers, "Draw");
 
-  scene.cameraPosition.use();
-  scene.light.strength.use();
-  scene.light.position.use();
-  scene.light.diffuseCoefficient.use();
-  scene.light.ambientColor.use();
-  scene.light.specularCoefficient.use();
-  scene.light.specularColor.use();
-  scene.light.ambientCoefficient.use();
-  scene.light.ambientColor.use();
-
-  for (auto &model : scene.models) {
-    model.modelMatrix.use();
-    model.material.color.use();
-    model.material.shininess.use();
-    scene.updateMVP(model.modelMatrix.get());
-    scene.mvp.use();
-
-    for (auto &mesh : model.meshes) {
-      if (enabledFaceCulling != mesh.enableFaceCulling) {
-        if (mesh.enableFaceCulling)
-          glEnable(GL_CULL_FACE);
-        else
-          glDisable(GL_CULL_FACE);
-        enabledFaceCulling = mesh.enableFaceCulling;
+  const ModelSnapshot *currentModel{nullptr};
+  for (const auto &item : renderQueue) {
+    if (item.model != currentModel) {
+      item.model->modelMatrix.use();
+      item.model->normalMatrix.use();
+      item.model->material.color.use();
+      item.model->material.shininess.use();
+      currentModel = item.model;
+    }
+    setFaceCulling(item.mesh->enableFaceCulling);
+    usePositionQuantization(item.mesh->getVertices().quantization);
+    drawElements(scene.shader, item.mesh->vao,
+                 static_cast<GLsizei>(item.mesh->getIndices().size()),
+                 item.mesh->ebo.getIndexType());
+  }
+}
+
+void Renderer::renderInstanced(const Scene &scene,
+                               const FrameSnapshot &snapshot) {
+  collectInstanceBatches(snapshot);
+  if (instanceData.empty())
+    return;
+
+  instanceBuffer.set(instanceData.data(),
+                     instanceData.size() * sizeof(InstanceData));
+  instanceBuffer.bindBase(instanceDataBindingIndex);
+
+  auto usageScope = scene.instancedShader.scopedUsage();
+  GpuPassScope gpuPassScope(gpuPassTimers, "Draw");
+
+  for (size_t i = 0; i < usedInstanceBatches; i++) {
+    const auto &batch = instanceBatches[i];
+    setFaceCulling(batch.mesh->enableFaceCulling);
+    drawElementsInstanced(scene.instancedShader, batch.mesh->vao,
+                          static_cast<GLsizei>(batch.mesh->getIndices().size()),
+                          batch.mesh->ebo.getIndexType(),
+                          static_cast<GLsizei>(batch.instances.size()),
+                          batch.baseInstance);
+  }
+}
+
+void Renderer::renderIndirect(const Scene &scene,
+                              const FrameSnapshot &snapshot) {
+  collectInstanceBatches(snapshot);
+  if (instanceData.empty())
+    return;
+
+  if (!geometryArena)
+    geometryArena = std::make_shared<GeometryArena>();
+
+  bool occlusionCulling = prepareOcclusionCulling();
+
+  // Meshes differ only in face culling, the vertex format and the index type,
+  // the latter two selecting the VAO of the arena, so commands are grouped by
+  // all three and every group is submitted with one call
+  drawCommands.clear();
+  commandBounds.clear();
+  indirectDrawGroups.clear();
+  for (bool faceCulling : {true, false}) {
+    for (VertexFormat vertexFormat :
+         {VertexFormat::Float, VertexFormat::Packed}) {
+      for (GLenum indexType : {GL_UNSIGNED_INT, GL_UNSIGNED_SHORT}) {
+        IndirectDrawGroup group{.faceCulling = faceCulling,
+                                .vertexFormat = vertexFormat,
+                                .indexType = indexType,
+                                .firstCommand = drawCommands.size(),
+                                .commandCount = 0};
+        collectDrawCommands(group, occlusionCulling);
+        if (group.commandCount > 0)
+          indirectDrawGroups.push_back(group);
+      }
+    }
+  }
+
+  instanceBuffer.set(instanceData.data(),
+                     instanceData.size() * sizeof(InstanceData));
+  instanceBuffer.bindBase(instanceDataBindingIndex);
+  drawCommandBuffer.set(drawCommands.data(),
+                        drawCommands.size() *
+                            sizeof(DrawElementsIndirectCommand));
+
+  const SSBO *indirectBuffer = &drawCommandBuffer;
+  if (occlusionCulling) {
+    commandBoundsBuffer.set(commandBounds.data(),
+                            commandBounds.size() * sizeof(CommandBounds));
+    GpuPassScope gpuPassScope(gpuPassTimers, "Occlusion culling");
+    if (occlusionCuller.cull(drawCommandBuffer, commandBoundsBuffer,
+                             drawCommands.size(), visibleCommandBuffer))
+      indirectBuffer = &visibleCommandBuffer;
+    occludedDraws = occlusionCuller.getOccludedCount();
+    SGENG_TRACE(Culling) << "Draws occluded: " << occludedDraws;
+  }
+  indirectBuffer->bindAsIndirect();
+
+  {
+    auto usageScope = scene.instancedShader.scopedUsage();
+    GpuPassScope gpuPassScope(gpuPassTimers, "Draw");
+
+    for (const auto &group : indirectDrawGroups) {
+      setFaceCulling(group.faceCulling);
+      multiDrawElementsIndirect(
+          scene.instancedShader,
+          geometryArena->getVAO(group.vertexFormat, group.indexType),
+          group.firstCommand, group.commandCount, group.indexType);
+    }
+  }
+
+  // Depth of this frame is what the next frame is tested against
+  if (occlusionCulling) {
+    GpuPassScope gpuPassScope(gpuPassTimers, "Depth pyramid");
+    occlusionCuller.buildDepthPyramid(window.get().getOffscreenFramebuffer(),
+                                      snapshot.frameData.viewProjection);
+  }
+}
+
+void Renderer::collectDrawCommands(IndirectDrawGroup &group,
+                                   bool occlusionCulling) {
+  for (size_t i = 0; i < usedInstanceBatches; i++) {
+    const auto &batch = instanceBatches[i];
+    const auto &mesh = *batch.mesh;
+    if (mesh.enableFaceCulling != group.faceCulling ||
+        mesh.getVertices().format != group.vertexFormat ||
+        mesh.getIndices().type != group.indexType)
+      continue;
+    if (!mesh.arenaAllocation.isValid())
+      mesh.arenaAllocation =
+          geometryArena->allocate(mesh.getVertices(), mesh.getIndices());
+    if (!occlusionCulling) {
+      drawCommands.push_back(
+          {.count = mesh.arenaAllocation.getIndexCount(),
+           .instanceCount = static_cast<GLuint>(batch.instances.size()),
+           .firstIndex = mesh.arenaAllocation.getFirstIndex(),
+           .baseVertex = mesh.arenaAllocation.getBaseVertex(),
+           .baseInstance = batch.baseInstance});
+      continue;
+    }
+    // One command per instance, so that instances are culled individually
+    for (size_t j = 0; j < batch.instances.size(); j++) {
+      drawCommands.push_back(
+          {.count = mesh.arenaAllocation.getIndexCount(),
+           .instanceCount = 1,
+           .firstIndex = mesh.arenaAllocation.getFirstIndex(),
+           .baseVertex = mesh.arenaAllocation.getBaseVertex(),
+           .baseInstance = batch.baseInstance + static_cast<GLuint>(j)});
+      const AABB &bounds = batch.instanceBounds[j];
+      commandBounds.push_back({.min = vec4gl(bounds.min, 1.0f),
+                               .max = vec4gl(bounds.max, 1.0f)});
+    }
+  }
+  group.commandCount =
+      static_cast<GLsizei>(drawCommands.size() - group.firstCommand);
+}
+
+void Renderer::collectInstanceBatches(const FrameSnapshot &snapshot) {
+  for (size_t i = 0; i < usedInstanceBatches; i++) {
+    instanceBatches[i].instances.clear();
+    instanceBatches[i].instanceBounds.clear();
+  }
+  usedInstanceBatches = 0;
+  instanceBatchIndices.clear();
+
+  for (const auto &model : snapshot.getModels()) {
+    InstanceData instance{.modelMatrix = model.modelMatrix.get(),
+                          .normalMatrix = mat3x4gl(model.normalMatrix.get()),
+                          .color = model.material.color.get(),
+                          .shininess = model.material.shininess.get(),
+                          .positionScale = vec3gl(1.f),
+                          ._padding0 = 0.f,
+                          .positionOffset = vec3gl(0.f),
+                          ._padding1 = 0.f};
+
+    for (const auto &mesh : model.meshes) {
+      const auto &[scale, offset] = mesh->getVertices().quantization;
+      instance.positionScale = scale;
+      instance.positionOffset = offset;
+      auto [it, inserted] =
+          instanceBatchIndices.try_emplace(mesh.get(), usedInstanceBatches);
+      if (inserted) {
+        if (usedInstanceBatches == instanceBatches.size())
+          instanceBatches.emplace_back();
+        instanceBatches[usedInstanceBatches].mesh = mesh.get();
+        usedInstanceBatches++;
       }
-      drawElements(scene.shader, mesh.vao,
-                   static_cast<GLsizei>(mesh.indices.size()));
+      instanceBatches[it->second].instances.push_back(instance);
+      instanceBatches[it->second].instanceBounds.push_back(model.bounds);
     }
   }
+
+  instanceData.clear();
+  for (size_t i = 0; i < usedInstanceBatches; i++) {
+    auto &batch = instanceBatches[i];
+    batch.baseInstance = static_cast<GLuint>(instanceData.size());
+    instanceData.insert(instanceData.end(), batch.instances.begin(),
+                        batch.instances.end());
+  }
 }
 
 } // namespace SGEng
\ No newline at end of file
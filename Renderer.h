@@ -25,37 +25,134 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "FrameSnapshot.h"
+#include "Frustum.h"
+#include "GeometryArena.h"
 #include "IRenderer.h"
+#include "InstanceData.h"
+#include "OcclusionCuller.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include "SSBO.h"
 #include "Shader.h"
 #include "VAO.h"
+#include "Vertex.h"
 #include "Window.h"
+#include <atomic>
 #include <exception>
 #include <functional>
 #include <glad/gl.h>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace SGEng {
 
 struct Context;
 struct Config;
 struct Scene;
+struct Mesh;
+
+// All instances of a single mesh drawn with one instanced draw call. Instance
+// data of every batch is stored contiguously in one shader storage buffer,
+// starting at baseInstance.
+struct InstanceBatch {
+  const Mesh *mesh{nullptr};
+  std::vector<InstanceData> instances;
+  std::vector<AABB> instanceBounds;
+  GLuint baseInstance{0};
+};
+
+// Consecutive indirect draw commands submitted with one call, as they share
+// the state they are drawn with
+struct IndirectDrawGroup {
+  bool faceCulling{true};
+  VertexFormat vertexFormat{VertexFormat::Float};
+  GLenum indexType{GL_UNSIGNED_INT};
+  size_t firstCommand{0};
+  GLsizei commandCount{0};
+};
+
+struct CullingStats {
+  size_t visibleModels{0};
+  size_t culledModels{0};
+  // Draws rejected by occlusion culling, reported one frame late
+  size_t occludedDraws{0};
+};
 
 class Renderer : public IRenderer {
 public:
   Renderer(Context &ctx, Window &window);
-  Renderer(const Renderer &renderer);
-  Renderer &operator=(const Renderer &renderer);
-  Renderer(Renderer &&renderer) noexcept;
-  Renderer &operator=(Renderer &&renderer) noexcept;
+  Renderer(const Renderer &renderer) = delete;
+  Renderer &operator=(const Renderer &renderer) = delete;
+  Renderer(Renderer &&renderer) = delete;
+  Renderer &operator=(Renderer &&renderer) = delete;
   virtual ~Renderer();
 
-  void drawElements(const Shader &shader, const VAO &vao, GLsizei count);
+  void drawElements(const Shader &shader, const VAO &vao, GLsizei count,
+                    GLenum indexType = GL_UNSIGNED_INT);
+  void drawElementsInstanced(const Shader &shader, const VAO &vao,
+                             GLsizei count, GLenum indexType,
+                             GLsizei instanceCount, GLuint baseInstance = 0);
+  void multiDrawElementsIndirect(const Shader &shader, const VAO &vao,
+                                 size_t firstCommand, GLsizei drawCount,
+                                 GLenum indexType = GL_UNSIGNED_INT);
 
   void update() override;
   void render(const Scene &scene) override;
+  void captureFrame(const Scene &scene, FrameSnapshot &snapshot) override;
+  void renderFrame(const Scene &scene, const FrameSnapshot &snapshot) override;
+
+  const CullingStats &getCullingStats() const;
 
 private:
-  bool enabledFaceCulling{false};
+  // Frustum culling state, visibility is indexed like Scene::models
+  AABBBatch cullingBoxes;
+  std::vector<size_t> visibleModelIndices;
+  std::vector<uint8_t> modelVisibility;
+  CullingStats cullingStats;
+  // Written by the thread rendering frames, read when capturing them
+  std::atomic<size_t> occludedDraws{0};
+
+  // Snapshot used when the frame is captured and rendered on one thread
+  FrameSnapshot frameSnapshot;
+
+  GpuPassTimers gpuPassTimers;
+
+  // Direct rendering state
+  RenderQueue renderQueue;
+
+  // Instanced rendering state, reused between frames to avoid reallocations
+  std::vector<InstanceBatch> instanceBatches;
+  size_t usedInstanceBatches{0};
+  std::unordered_map<const Mesh *, size_t> instanceBatchIndices;
+  std::vector<InstanceData> instanceData;
+  SSBO instanceBuffer;
+
+  // Indirect rendering state
+  std::shared_ptr<GeometryArena> geometryArena;
+  std::vector<DrawElementsIndirectCommand> drawCommands;
+  std::vector<IndirectDrawGroup> indirectDrawGroups;
+  SSBO drawCommandBuffer;
+
+  // Occlusion culling state, only used by indirect rendering
+  OcclusionCuller occlusionCuller;
+  bool occlusionCullerFailed{false};
+  std::vector<CommandBounds> commandBounds;
+  SSBO commandBoundsBuffer;
+  SSBO visibleCommandBuffer;
+
+  void setFaceCulling(bool enable);
+  void usePositionQuantization(const PositionQuantization &quantization);
+  void cullModels(const Scene &scene);
+  bool prepareOcclusionCulling();
+  void renderDirect(const Scene &scene, const FrameSnapshot &snapshot);
+  void renderInstanced(const Scene &scene, const FrameSnapshot &snapshot);
+  void renderIndirect(const Scene &scene, const FrameSnapshot &snapshot);
+  void collectInstanceBatches(const FrameSnapshot &snapshot);
+  // Appends the commands of the batches drawn with the state of the group
+  void collectDrawCommands(IndirectDrawGroup &group, bool occlusionCulling);
 };
 
 } // namespace SGEng
\ No newline at end of file
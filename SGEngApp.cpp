@@ -27,12 +27,13 @@
 
 #include "Mesh.h"
 #include "Model.h"
+#include "TraceLog.h"
 #include "examples/cubes.h"
 #include "exceptions.h"
-#include "model_loading.h"
 #include <array>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <memory>
 #include <plog/Log.h>
 
 namespace SGEng {
@@ -57,9 +58,10 @@ constexpr glm::vec3 lightAmbientColor = {0.1f, 0.1f, 0.15f};
 SGEngApp::SGEngApp(Context &ctx)
     : App(ctx),
       keyInput(ctx, {GLFW_KEY_ESCAPE, GLFW_KEY_SPACE, GLFW_KEY_W, GLFW_KEY_A,
-                     GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_UP, GLFW_KEY_DOWN}),
+                     GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_UP, GLFW_KEY_DOWN,
+                     GLFW_KEY_F12}),
       mouseInput(ctx, {GLFW_MOUSE_BUTTON_LEFT}) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "SGEngApp constructor...";
+  SGENG_TRACE(Lifetime) << "SGEngApp constructor...";
 }
 
 bool SGEngApp::onStartup() {
@@ -68,6 +70,10 @@ bool SGEngApp::onStartup() {
   scene.shader.tryInitialize(*ctx.get().fileManager,
                              defaultBasicVertexShaderPath,
                              defaultBasicFragmentShaderPath);
+  if (ctx.get().cfg.renderingMode != RenderingMode::Direct)
+    scene.instancedShader.tryInitialize(*ctx.get().fileManager,
+                                        defaultInstancedVertexShaderPath,
+                                        defaultBasicFragmentShaderPath);
 
   auto usageScope = scene.shader.scopedUsage();
   initializeUniforms();
@@ -86,78 +92,97 @@ bool SGEngApp::update(double ts, double td) {
   }
 
   if (keyInput.isKeyDown(GLFW_KEY_ESCAPE)) {
-    window.close();
+    window.requestClose();
     return false;
   }
 
   if (keyInput.isKeyClicked(GLFW_KEY_SPACE)) {
-    if (scene.shader.isInitialized())
-      scene.shader.tryReload(*ctx.get().fileManager);
-    else
-      scene.shader.tryReload(*ctx.get().fileManager,
-                             defaultBasicVertexShaderPath,
-                             defaultBasicFragmentShaderPath);
-    resetUniforms();
+    runOnRenderThread([this] {
+      if (scene.shader.isInitialized())
+        scene.shader.tryReload(*ctx.get().fileManager);
+      else
+        scene.shader.tryReload(*ctx.get().fileManager,
+                               defaultBasicVertexShaderPath,
+                               defaultBasicFragmentShaderPath);
+      if (scene.instancedShader.isInitialized())
+        scene.instancedShader.tryReload(*ctx.get().fileManager);
+      resetUniforms();
+    });
   }
 
+  if (keyInput.isKeyClicked(GLFW_KEY_F12) && ctx.get().cfg.profilerEnabled)
+    writeProfilerTrace();
+
   if (mouseInput.isLeftButtonClicked()) {
     PLOGD << "Click";
   }
 
-  auto usageScope = scene.shader.scopedUsage();
-
-  glm::vec3 cameraDiff{0.f};
-  constexpr float cameraMoveSpeed = 0.75f;
-  constexpr float cameraRotationSpeed = 2.f;
-  if (keyInput.isKeyDown(GLFW_KEY_W))
-    cameraDiff -=
-        cameraMoveSpeed * static_cast<float>(td) * scene.cameraPosition.get();
-  if (keyInput.isKeyDown(GLFW_KEY_S))
-    cameraDiff +=
-        cameraMoveSpeed * static_cast<float>(td) * scene.cameraPosition.get();
-  if (keyInput.isKeyDown(GLFW_KEY_A))
-    cameraDiff += glm::normalize(glm::cross(scene.cameraPosition.get(), up)) *
-                  cameraRotationSpeed * static_cast<float>(td);
-  if (keyInput.isKeyDown(GLFW_KEY_D))
-    cameraDiff -= glm::normalize(glm::cross(scene.cameraPosition.get(), up)) *
-                  cameraRotationSpeed * static_cast<float>(td);
-  scene.cameraPosition.set(scene.cameraPosition.get() + cameraDiff);
+  // With a fixed timestep the camera is moved by fixedUpdate instead
+  if (!ctx.get().cfg.fixedTimestep) {
+    previousCameraPosition = cameraPosition;
+    moveCamera(static_cast<float>(td));
+  }
 
-  if (scene.light.strength.get() >= 1.f && keyInput.isKeyClicked(GLFW_KEY_DOWN))
-    scene.light.strength.set(scene.light.strength.get() - 1.f);
+  if (scene.light.strength >= 1.f && keyInput.isKeyClicked(GLFW_KEY_DOWN))
+    scene.light.strength -= 1.f;
   if (keyInput.isKeyClicked(GLFW_KEY_UP))
-    scene.light.strength.set(scene.light.strength.get() + 1.f);
-
-  scene.viewMatrix = glm::lookAt(scene.cameraPosition.get(), cameraTarget, up);
+    scene.light.strength += 1.f;
 
   return true;
 }
 
-void SGEngApp::draw() { window.draw(scene); }
+void SGEngApp::fixedUpdate(double /*ts*/, double td) {
+  previousCameraPosition = cameraPosition;
+  moveCamera(static_cast<float>(td));
+}
+
+void SGEngApp::draw(double alpha) {
+  scene.cameraPosition = glm::mix(previousCameraPosition, cameraPosition,
+                                  static_cast<float>(alpha));
+  scene.viewMatrix = glm::lookAt(scene.cameraPosition, cameraTarget, up);
+  window.draw(scene);
+}
 
 void SGEngApp::onDestroy() {}
 
 void SGEngApp::initializeUniforms() {
-  auto usageScope = scene.shader.scopedUsage();
-  scene.initializeUniforms();
-  scene.cameraPosition.set({0.f, 1.f, -radius});
-  scene.light.position.set(lightPosition);
-  scene.light.strength.set(lightStrength);
-  scene.light.diffuseCoefficient.set(lightDiffuseCoefficient);
-  scene.light.diffuseColor.set(lightDiffuseColor);
-  scene.light.specularCoefficient.set(lightSpecularCoefficient);
-  scene.light.specularColor.set(lightSpecularColor);
-  scene.light.ambientCoefficient.set(lightAmbientCoefficient);
-  scene.light.ambientColor.set(lightAmbientColor);
+  scene.cameraPosition = {0.f, 1.f, -radius};
+  cameraPosition = scene.cameraPosition;
+  previousCameraPosition = scene.cameraPosition;
+  scene.light.position = lightPosition;
+  scene.light.strength = lightStrength;
+  scene.light.diffuseCoefficient = lightDiffuseCoefficient;
+  scene.light.diffuseColor = lightDiffuseColor;
+  scene.light.specularCoefficient = lightSpecularCoefficient;
+  scene.light.specularColor = lightSpecularColor;
+  scene.light.ambientCoefficient = lightAmbientCoefficient;
+  scene.light.ambientColor = lightAmbientColor;
   scene.projectionMatrix = glm::perspective(fov, aspect, near, far);
-  scene.viewMatrix = glm::lookAt(scene.cameraPosition.get(), cameraTarget, up);
+  scene.viewMatrix = glm::lookAt(scene.cameraPosition, cameraTarget, up);
+}
+
+void SGEngApp::moveCamera(float td) {
+  glm::vec3 cameraDiff{0.f};
+  constexpr float cameraMoveSpeed = 0.75f;
+  constexpr float cameraRotationSpeed = 2.f;
+  if (keyInput.isKeyDown(GLFW_KEY_W))
+    cameraDiff -= cameraMoveSpeed * td * cameraPosition;
+  if (keyInput.isKeyDown(GLFW_KEY_S))
+    cameraDiff += cameraMoveSpeed * td * cameraPosition;
+  if (keyInput.isKeyDown(GLFW_KEY_A))
+    cameraDiff += glm::normalize(glm::cross(cameraPosition, up)) *
+                  cameraRotationSpeed * td;
+  if (keyInput.isKeyDown(GLFW_KEY_D))
+    cameraDiff -= glm::normalize(glm::cross(cameraPosition, up)) *
+                  cameraRotationSpeed * td;
+  cameraPosition += cameraDiff;
 }
 
 void SGEngApp::addGeneratedCube() {
   constexpr Color objColor(Color::BasicColor::White);
   constexpr unsigned int shininess = 64;
-  Mesh mesh = generateCube();
-  mesh.initialize();
+  auto mesh = std::make_shared<Mesh>(generateCube());
+  mesh->initialize();
 
   Model model;
   model.meshes.push_back(std::move(mesh));
@@ -167,14 +192,14 @@ void SGEngApp::addGeneratedCube() {
   model.material.shininess.set(shininess);
   model.updateModelMatrix();
 
-  scene.models.push_back(std::move(model));
+  scene.addModel(std::move(model));
 }
 
 void SGEngApp::addGeneratedOptimizedCube() {
   constexpr Color objColor(Color::BasicColor::White);
   constexpr unsigned int shininess = 64;
-  Mesh mesh = generateOptimizedCube();
-  mesh.initialize();
+  auto mesh = std::make_shared<Mesh>(generateOptimizedCube());
+  mesh->initialize();
 
   Model model;
   model.meshes.push_back(std::move(mesh));
@@ -184,43 +209,37 @@ void SGEngApp::addGeneratedOptimizedCube() {
   model.material.shininess.set(shininess);
   model.updateModelMatrix();
 
-  scene.models.push_back(std::move(model));
+  scene.addModel(std::move(model));
 }
 
 void SGEngApp::addTeapot() {
-  constexpr Color objColor(Color::BasicColor::White);
-  constexpr unsigned int shininess = 64;
-  constexpr vec3gl scale = {0.05f, 0.05f, 0.05f};
-  Model model = loadModel(ctx.get().cfg.resourcesDirectory / "teapot.obj");
-  for (auto &mesh : model.meshes) {
-    mesh.enableFaceCulling = true;
-    mesh.initialize();
-  }
-  auto usageScope = scene.shader.scopedUsage();
-  model.initializeUniforms(scene.shader);
-  model.material.color.set(objColor.vec3f());
-  model.material.shininess.set(shininess);
-  model.scale = scale;
-  model.updateModelMatrix();
-
-  scene.models.push_back(std::move(model));
+  loadModelAsync(
+      ctx.get().cfg.resourcesDirectory / "teapot.obj",
+      [this](Model model) { scene.addModel(std::move(model)); },
+      [this](Model &model) {
+        constexpr vec3gl scale = {0.05f, 0.05f, 0.05f};
+        model.scale = scale;
+        prepareLoadedModel(model);
+      });
 }
 
 void SGEngApp::addSphere() {
+  loadModelAsync(
+      ctx.get().cfg.resourcesDirectory / "sphere.obj",
+      [this](Model model) { scene.addModel(std::move(model)); },
+      [this](Model &model) { prepareLoadedModel(model); });
+}
+
+void SGEngApp::prepareLoadedModel(Model &model) {
   constexpr Color objColor(Color::BasicColor::White);
   constexpr unsigned int shininess = 64;
-  Model model = loadModel(ctx.get().cfg.resourcesDirectory / "sphere.obj");
-  for (auto &mesh : model.meshes) {
-    mesh.enableFaceCulling = true;
-    mesh.initialize();
-  }
+  for (auto &mesh : model.meshes)
+    mesh->enableFaceCulling = true;
   auto usageScope = scene.shader.scopedUsage();
   model.initializeUniforms(scene.shader);
   model.material.color.set(objColor.vec3f());
   model.material.shininess.set(shininess);
   model.updateModelMatrix();
-
-  scene.models.push_back(std::move(model));
 }
 
 void SGEngApp::resetUniforms() { scene.resetUniforms(); }
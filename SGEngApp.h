@@ -44,7 +44,8 @@ public:
 
   bool onStartup() override;
   bool update(double ts, double td) override;
-  void draw() override;
+  void fixedUpdate(double ts, double td) override;
+  void draw(double alpha) override;
   void onDestroy() override;
 
 private:
@@ -52,13 +53,20 @@ private:
   KeyInput keyInput;
   MouseInput mouseInput;
   double lastPrintTs{0.0};
+  // Simulated camera positions of the last two steps, interpolated when drawn
+  vec3gl cameraPosition{0.f};
+  vec3gl previousCameraPosition{0.f};
 
   void initializeUniforms();
   void resetUniforms();
+  void moveCamera(float td);
   void addGeneratedCube();
   void addGeneratedOptimizedCube();
   void addTeapot();
   void addSphere();
+  // Sets up a model loaded in the background on the render thread, before it
+  // is added to the scene
+  void prepareLoadedModel(Model &model);
 };
 
 } // namespace SGEng
@@ -0,0 +1,123 @@
+//===- SSBO.cpp -------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "SSBO.h"
+
+#include "TraceLog.h"
+#include "constants.h"
+#include <algorithm>
+#include <utility>
+
+namespace SGEng {
+
+SSBO::SSBO(bool initialize) {
+  if (initialize)
+    this->initialize();
+}
+
+SSBO::SSBO(SSBO &&ssbo) noexcept : id{ssbo.id}, capacity{ssbo.capacity} {
+  ssbo.id = 0;
+  ssbo.capacity = 0;
+}
+
+SSBO &SSBO::operator=(SSBO &&ssbo) noexcept {
+  if (this != &ssbo) {
+    tryDestroy();
+    std::swap(id, ssbo.id);
+    std::swap(capacity, ssbo.capacity);
+  }
+  return *this;
+}
+
+SSBO::~SSBO() { tryDestroy(); }
+
+bool SSBO::isInitialized() const { return id != 0; }
+
+void SSBO::initialize() {
+  tryDestroy();
+  SGENG_TRACE(Buffers) << "SSBO initialization...";
+  glCreateBuffers(1, &id);
+}
+
+GLuint SSBO::getId() const { return id; }
+
+size_t SSBO::getCapacity() const { return capacity; }
+
+void SSBO::set(const void *data, size_t size) {
+  if (!isInitialized())
+    initialize();
+
+  if (size > capacity) {
+    // Grow geometrically so that a slowly growing scene does not reallocate
+    // the storage every frame
+    capacity = std::max(size, capacity * 2);
+    SGENG_TRACE(Buffers) << "SSBO storage resized to " << capacity;
+  }
+  // Orphan the previous storage, so that the driver does not have to wait for
+  // draws still reading from it
+  glNamedBufferData(id, static_cast<GLsizeiptr>(capacity), nullptr,
+                    GL_STREAM_DRAW);
+  glNamedBufferSubData(id, 0, static_cast<GLsizeiptr>(size), data);
+}
+
+void SSBO::reserve(size_t size) {
+  if (!isInitialized())
+    initialize();
+
+  if (size > capacity) {
+    capacity = std::max(size, capacity * 2);
+    glNamedBufferData(id, static_cast<GLsizeiptr>(capacity), nullptr,
+                      GL_DYNAMIC_COPY);
+    SGENG_TRACE(Buffers) << "SSBO storage resized to " << capacity;
+  }
+}
+
+void SSBO::get(void *data, size_t size) const {
+  glGetNamedBufferSubData(id, 0, static_cast<GLsizeiptr>(size), data);
+}
+
+void SSBO::bindBase(GLuint bindingIndex) const {
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingIndex, id);
+}
+
+// Buffer objects are untyped, so the same storage that a shader writes to can
+// also be consumed as the source of indirect draw commands
+void SSBO::bindAsIndirect() const {
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, id);
+}
+
+void SSBO::tryDestroy() {
+  if (isInitialized())
+    destroy();
+}
+
+void SSBO::destroy() {
+  glDeleteBuffers(1, &id);
+  id = 0;
+  capacity = 0;
+  SGENG_TRACE(Buffers) << "SSBO destroyed";
+}
+
+} // namespace SGEng
@@ -0,0 +1,59 @@
+//===- SSBO.h ---------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <glad/gl.h>
+
+namespace SGEng {
+
+class SSBO {
+public:
+  SSBO(bool initialize = false);
+  SSBO(const SSBO &ssbo) = delete;
+  SSBO &operator=(const SSBO &ssbo) = delete;
+  SSBO(SSBO &&ssbo) noexcept;
+  SSBO &operator=(SSBO &&ssbo) noexcept;
+  ~SSBO();
+
+  bool isInitialized() const;
+  void initialize();
+  GLuint getId() const;
+  size_t getCapacity() const;
+  void set(const void *data, size_t size);
+  // Allocates uninitialized storage for data written by shaders
+  void reserve(size_t size);
+  void get(void *data, size_t size) const;
+  void bindBase(GLuint bindingIndex) const;
+  void bindAsIndirect() const;
+  void tryDestroy();
+  void destroy();
+
+private:
+  GLuint id{0};
+  size_t capacity{0};
+};
+
+} // namespace SGEng
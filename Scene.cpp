@@ -26,54 +26,88 @@
 #include "Scene.h"
 
 #include "Model.h"
+#include <cstring>
+#include <iterator>
 
 namespace SGEng {
 
-void Scene::initializeUniforms() {
-  auto usageScope = shader.scopedUsage();
-  cameraPosition.initialize(shader, "camera_pos");
-  mvp.initialize(shader, "mvp");
-  light.position.initialize(shader, "light.position");
-  light.strength.initialize(shader, "light.strength");
-  light.diffuseCoefficient.initialize(shader, "light.diffuse_coefficient");
-  light.diffuseColor.initialize(shader, "light.diffuse_color");
-  light.specularCoefficient.initialize(shader, "light.specular_coefficient");
-  light.specularColor.initialize(shader, "light.specular_color");
-  light.ambientCoefficient.initialize(shader, "light.ambient_coefficient");
-  light.ambientColor.initialize(shader, "light.ambient_color");
+void Scene::addModel(Model model) {
+  // Models pushed to models directly are not indexed
+  spatialIndexNodes.resize(models.size(), BVH::nullNode);
+  spatialIndexNodes.push_back(
+      spatialIndex.insert(model.bounds.aabb, models.size()));
+  models.push_back(std::move(model));
 }
 
-void Scene::resetUniforms() {
-  auto currentCameraPosition = cameraPosition.get();
-  auto currentMVP = mvp.get();
-  auto currentLightPosition = light.position.get();
-  auto currentLightStrength = light.strength.get();
-  auto currentLightDiffuseCoefficient = light.diffuseCoefficient.get();
-  auto currentLightDiffuseColor = light.diffuseColor.get();
-  auto currentLightSpecularCoefficient = light.specularCoefficient.get();
-  auto currentLightSpecularColor = light.specularColor.get();
-  auto currentLightAmbientCoefficient = light.ambientCoefficient.get();
-  auto currentLightAmbientColor = light.ambientColor.get();
+void Scene::removeModel(size_t index) {
+  spatialIndexNodes.resize(models.size(), BVH::nullNode);
+  if (spatialIndexNodes[index] != BVH::nullNode)
+    spatialIndex.remove(spatialIndexNodes[index]);
+  for (auto &mesh : models[index].meshes)
+    releasedMeshes.push_back(std::move(mesh));
+  if (index != models.size() - 1) {
+    models[index] = std::move(models.back());
+    spatialIndexNodes[index] = spatialIndexNodes.back();
+    if (spatialIndexNodes[index] != BVH::nullNode)
+      spatialIndex.setUserIndex(spatialIndexNodes[index], index);
+  }
+  models.pop_back();
+  spatialIndexNodes.pop_back();
+}
 
-  initializeUniforms();
-  cameraPosition.set(currentCameraPosition);
-  mvp.set(currentMVP);
-  light.position.set(currentLightPosition);
-  light.strength.set(currentLightStrength);
-  light.diffuseCoefficient.set(currentLightDiffuseCoefficient);
-  light.diffuseColor.set(currentLightDiffuseColor);
-  light.specularCoefficient.set(currentLightSpecularCoefficient);
-  light.specularColor.set(currentLightSpecularColor);
-  light.ambientCoefficient.set(currentLightAmbientCoefficient);
-  light.ambientColor.set(currentLightAmbientColor);
+void Scene::updateModel(size_t index) {
+  if (index < spatialIndexNodes.size() &&
+      spatialIndexNodes[index] != BVH::nullNode)
+    spatialIndex.update(spatialIndexNodes[index], models[index].bounds.aabb);
+}
 
-  for (auto &model : models) {
-    model.resetUniforms(shader);
+void Scene::resetUniforms() {
+  auto usageScope = shader.scopedUsage();
+  for (size_t i = 0; i < models.size(); i++) {
+    models[i].resetUniforms(shader);
+    updateModel(i);
   }
 }
 
-void Scene::updateMVP(mat4gl modelMatrix) const {
-  mvp.set(projectionMatrix * viewMatrix * modelMatrix);
+void Scene::takeReleasedMeshes(
+    std::vector<std::shared_ptr<Mesh>> &meshes) const {
+  meshes.insert(meshes.end(), std::make_move_iterator(releasedMeshes.begin()),
+                std::make_move_iterator(releasedMeshes.end()));
+  releasedMeshes.clear();
+}
+
+void Scene::updateFrameData() const { uploadFrameData(makeFrameData()); }
+
+FrameData Scene::makeFrameData() const {
+  return {
+      .view = viewMatrix,
+      .projection = projectionMatrix,
+      .viewProjection = projectionMatrix * viewMatrix,
+      .cameraPosition = cameraPosition,
+      ._padding0 = 0.f,
+      .light = {.position = light.position,
+                .strength = light.strength,
+                .diffuseColor = light.diffuseColor,
+                .diffuseCoefficient = light.diffuseCoefficient,
+                .specularColor = light.specularColor,
+                .specularCoefficient = light.specularCoefficient,
+                .ambientColor = light.ambientColor,
+                .ambientCoefficient = light.ambientCoefficient}};
+}
+
+void Scene::uploadFrameData(const FrameData &newFrameData) const {
+  if (!frameDataBuffer.isInitialized())
+    frameDataBuffer.initialize(sizeof(FrameData));
+
+  // The whole block is uploaded with a single call, and only when any of the
+  // scene parameters changed since the last frame
+  if (!isFrameDataUploaded ||
+      std::memcmp(&newFrameData, &frameData, sizeof(FrameData)) != 0) {
+    frameData = newFrameData;
+    frameDataBuffer.set(&frameData, sizeof(FrameData));
+    isFrameDataUploaded = true;
+  }
+  frameDataBuffer.bindBase(frameDataBindingIndex);
 }
 
 } // namespace SGEng
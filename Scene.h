@@ -25,40 +25,69 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "BVH.h"
+#include "FrameData.h"
 #include "Shader.h"
-#include "uniforms.h"
+#include "UBO.h"
+#include <memory>
 #include <vector>
 
 namespace SGEng {
 
-struct LightUniforms {
-  Uniform3f position;
-  Uniform1f strength;
+struct Light {
+  vec3gl position{0.f, 0.f, 0.f};
+  GLfloat strength{1.f};
 
-  Uniform1f diffuseCoefficient;
-  Uniform3f diffuseColor;
+  GLfloat diffuseCoefficient{1.f};
+  vec3gl diffuseColor{1.f, 1.f, 1.f};
 
-  Uniform1f specularCoefficient;
-  Uniform3f specularColor;
+  GLfloat specularCoefficient{1.f};
+  vec3gl specularColor{1.f, 1.f, 1.f};
 
-  Uniform1f ambientCoefficient;
-  Uniform3f ambientColor;
+  GLfloat ambientCoefficient{1.f};
+  vec3gl ambientColor{0.f, 0.f, 0.f};
 };
 
+struct Mesh;
 struct Model;
 
 struct Scene {
   std::vector<Model> models;
   Shader shader;
+  Shader instancedShader;
   mat4gl projectionMatrix{mat4gl(1.f)};
   mat4gl viewMatrix{mat4gl(1.f)};
-  Uniform3f cameraPosition;
-  LightUniforms light;
-  mutable UniformMat4 mvp;
+  vec3gl cameraPosition{0.f, 0.f, 0.f};
+  Light light;
+  // Bounding volume hierarchy over models added with addModel(), user indices
+  // are indices to models. Leaves are refitted by updateModel().
+  BVH spatialIndex;
 
-  void initializeUniforms();
+  void addModel(Model model);
+  // The meshes of the model are released with the next captured frame, see
+  // takeReleasedMeshes()
+  void removeModel(size_t index);
+  // Refits the leaf of the model after its bounds changed, e.g. by
+  // Model::updateModelMatrix()
+  void updateModel(size_t index);
   void resetUniforms();
-  void updateMVP(mat4gl modelMatrix) const;
+  void updateFrameData() const;
+  // Split of updateFrameData() for pipelined rendering: the frame data is
+  // made from the scene on the game thread and uploaded on the render thread
+  FrameData makeFrameData() const;
+  void uploadFrameData(const FrameData &newFrameData) const;
+  // Moves the meshes of models removed since the last call to the end of
+  // meshes. The last reference to a mesh deletes its buffers, so it has to
+  // be dropped on the thread owning the context.
+  void takeReleasedMeshes(std::vector<std::shared_ptr<Mesh>> &meshes) const;
+
+private:
+  // Leaf of every model in spatialIndex, by model index
+  std::vector<BVH::NodeId> spatialIndexNodes;
+  mutable std::vector<std::shared_ptr<Mesh>> releasedMeshes;
+  mutable FrameData frameData{};
+  mutable UBO frameDataBuffer;
+  mutable bool isFrameDataUploaded{false};
 };
 
 } // namespace SGEng
@@ -26,6 +26,9 @@
 #include "Shader.h"
 
 #include "FileManager.h"
+#include "GLState.h"
+#include "Profiler.h"
+#include "TraceLog.h"
 #include "exceptions.h"
 #include <cassert>
 #include <glm/glm.hpp>
@@ -33,53 +36,36 @@
 
 namespace SGEng {
 
-Shader::Shader() { PLOGV_IF(LOG_CONSTRUCTORS) << "Shader constructor 1..."; }
+Shader::Shader() { SGENG_TRACE(Lifetime) << "Shader constructor 1..."; }
 
 Shader::Shader(IFileManager &fileManager, const fs::path &vertexShaderPath,
                const fs::path &fragmentShaderPath) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Shader constructor 2...";
+  SGENG_TRACE(Lifetime) << "Shader constructor 2...";
   initialize(fileManager, vertexShaderPath, fragmentShaderPath);
 }
 
 Shader::~Shader() {
-  PLOGV_IF(LOG_DESTRUCTORS) << "Shader destructor...";
+  SGENG_TRACE(Lifetime) << "Shader destructor...";
   tryDestroy();
 }
 
 void Shader::initialize(IFileManager &fileManager, fs::path vertexShaderPath,
                         fs::path fragmentShaderPath) {
-  PLOGV_IF(LOG_SHADERS) << "Initializing shader program...";
+  SGENG_TRACE(Shaders) << "Initializing shader program...";
   GLuint vertexShader =
       initializeShader(fileManager, vertexShaderPath, GL_VERTEX_SHADER);
   GLuint fragmentShader =
       initializeShader(fileManager, fragmentShaderPath, GL_FRAGMENT_SHADER);
 
-  GLuint newId = glCreateProgram();
-  glAttachShader(newId, vertexShader);
-  glAttachShader(newId, fragmentShader);
-  glLinkProgram(newId);
-
-  glDeleteShader(vertexShader);
-  glDeleteShader(fragmentShader);
-
-  GLint success{GL_FALSE};
-  glGetProgramiv(newId, GL_LINK_STATUS, &success);
-  if (success == GL_FALSE) {
-    GLint maxLength = 0;
-    glGetProgramiv(newId, GL_INFO_LOG_LENGTH, &maxLength);
-    std::string infoLog;
-    infoLog.reserve(maxLength);
-    glGetProgramInfoLog(newId, maxLength, nullptr, infoLog.data());
-    glDeleteProgram(newId);
-    throw ShaderLinkingError(std::move(infoLog));
-  }
+  GLuint newId = linkProgram({vertexShader, fragmentShader});
 
   tryDestroy();
   id = newId;
   this->vertexShaderPath = std::move(vertexShaderPath);
   this->fragmentShaderPath = std::move(fragmentShaderPath);
+  this->computeShaderPath.clear();
   _isInitialized = true;
-  PLOGV_IF(LOG_SHADERS) << "Shader program initialized";
+  SGENG_TRACE(Shaders) << "Shader program initialized";
 }
 
 bool Shader::tryInitialize(IFileManager &fileManager, fs::path vertexShaderPath,
@@ -102,9 +88,46 @@ bool Shader::tryInitialize(IFileManager &fileManager, fs::path vertexShaderPath,
   return true;
 }
 
-void Shader::use() const { glUseProgram(id); }
+void Shader::initializeCompute(IFileManager &fileManager,
+                               fs::path computeShaderPath) {
+  SGENG_TRACE(Shaders) << "Initializing compute program...";
+  GLuint computeShader =
+      initializeShader(fileManager, computeShaderPath, GL_COMPUTE_SHADER);
+
+  GLuint newId = linkProgram({computeShader});
+
+  tryDestroy();
+  id = newId;
+  this->vertexShaderPath.clear();
+  this->fragmentShaderPath.clear();
+  this->computeShaderPath = std::move(computeShaderPath);
+  _isInitialized = true;
+  SGENG_TRACE(Shaders) << "Compute program initialized";
+}
+
+bool Shader::tryInitializeCompute(IFileManager &fileManager,
+                                  fs::path computeShaderPath) {
+  try {
+    initializeCompute(fileManager, computeShaderPath);
+  } catch (const ShaderCompilationError &e) {
+    PLOGE << e.what();
+    std::string infoLog = e.getInfoLog();
+    if (!infoLog.empty())
+      PLOGE << "More info: " << e.getInfoLog();
+    return false;
+  } catch (const ShaderLinkingError &e) {
+    PLOGE << e.what();
+    std::string infoLog = e.getInfoLog();
+    if (!infoLog.empty())
+      PLOGE << "More info: " << e.getInfoLog();
+    return false;
+  }
+  return true;
+}
+
+void Shader::use() const { GLState::current().useProgram(id); }
 
-void Shader::forget() const { glUseProgram(0); }
+void Shader::forget() const { GLState::current().releaseProgram(id); }
 
 std::shared_ptr<ScopedShaderUsage> Shader::scopedUsage() const {
   auto _scopedUsage = scopedUsagePtr.lock();
@@ -122,25 +145,39 @@ void Shader::tryDestroy() {
 }
 
 void Shader::destroy() {
+  GLState::current().forgetProgram(id);
   glDeleteProgram(id);
   _isInitialized = false;
-  PLOGV_IF(LOG_SHADERS) << "Shader program destroyed";
+  SGENG_TRACE(Shaders) << "Shader program destroyed";
 }
 
 GLuint Shader::getId() const { return id; }
 
 bool Shader::isInitialized() const { return _isInitialized; }
 
+bool Shader::isCompute() const { return !computeShaderPath.empty(); }
+
+void Shader::dispatch(GLuint groupsX, GLuint groupsY, GLuint groupsZ) const {
+  assert(isCompute());
+  glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
 void Shader::reload(IFileManager &fileManager,
                     std::optional<fs::path> vertexShaderPath,
                     std::optional<fs::path> fragmentShaderPath) {
+  if (isCompute()) {
+    initializeCompute(fileManager, this->computeShaderPath);
+    PLOGI << "Compute shader reloaded";
+    return;
+  }
+
   fs::path newVertexShaderPath =
       vertexShaderPath.value_or(this->vertexShaderPath);
   fs::path newFragmentShaderPath =
       fragmentShaderPath.value_or(this->fragmentShaderPath);
 
   initialize(fileManager, newVertexShaderPath, newFragmentShaderPath);
-  PLOGI_IF(LOG_SHADERS_RELOAD) << "Shaders reloaded";
+  PLOGI << "Shaders reloaded";
 }
 
 bool Shader::tryReload(IFileManager &fileManager,
@@ -173,6 +210,7 @@ std::optional<GLint> Shader::getUniformLocation(std::string_view name) const {
 
 GLuint Shader::initializeShader(IFileManager &fileManager, const fs::path &path,
                                 GLenum type) {
+  ProfileScope profileScope("Shader::initializeShader");
   std::string shaderSource = fileManager.loadTextFile(path);
   GLuint shaderId = glCreateShader(type);
 
@@ -192,11 +230,35 @@ GLuint Shader::initializeShader(IFileManager &fileManager, const fs::path &path,
     throw ShaderCompilationError(type, std::move(infoLog));
   }
 
-  PLOGV_IF(LOG_SHADERS) << "Shader of type " << type
-                        << " successfully compiled";
+  SGENG_TRACE(Shaders) << "Shader of type " << type
+                       << " successfully compiled";
   return shaderId;
 }
 
+GLuint Shader::linkProgram(std::initializer_list<GLuint> shaders) {
+  ProfileScope profileScope("Shader::linkProgram");
+  GLuint programId = glCreateProgram();
+  for (GLuint shaderId : shaders)
+    glAttachShader(programId, shaderId);
+  glLinkProgram(programId);
+
+  for (GLuint shaderId : shaders)
+    glDeleteShader(shaderId);
+
+  GLint success{GL_FALSE};
+  glGetProgramiv(programId, GL_LINK_STATUS, &success);
+  if (success == GL_FALSE) {
+    GLint maxLength = 0;
+    glGetProgramiv(programId, GL_INFO_LOG_LENGTH, &maxLength);
+    std::string infoLog;
+    infoLog.reserve(maxLength);
+    glGetProgramInfoLog(programId, maxLength, nullptr, infoLog.data());
+    glDeleteProgram(programId);
+    throw ShaderLinkingError(std::move(infoLog));
+  }
+  return programId;
+}
+
 ScopedShaderUsage::ScopedShaderUsage(const Shader &shader) : shader{shader} {
   shader.use();
 }
@@ -28,6 +28,7 @@
 #include "IFileManager.h"
 #include <filesystem>
 #include <glad/gl.h>
+#include <initializer_list>
 #include <memory>
 
 namespace SGEng {
@@ -58,6 +59,9 @@ public:
                   fs::path fragmentShaderPath);
   bool tryInitialize(IFileManager &fileManager, fs::path vertexShaderPath,
                      fs::path fragmentShaderPath);
+  void initializeCompute(IFileManager &fileManager, fs::path computeShaderPath);
+  bool tryInitializeCompute(IFileManager &fileManager,
+                            fs::path computeShaderPath);
   void use() const;
   void forget() const;
   std::shared_ptr<ScopedShaderUsage> scopedUsage() const;
@@ -65,6 +69,9 @@ public:
   void destroy();
   GLuint getId() const;
   bool isInitialized() const;
+  bool isCompute() const;
+  // Runs the compute program, which must be in use
+  void dispatch(GLuint groupsX, GLuint groupsY = 1, GLuint groupsZ = 1) const;
   void reload(IFileManager &fileManager,
               std::optional<fs::path> vertexShaderPath = std::nullopt,
               std::optional<fs::path> fragmentShaderPath = std::nullopt);
@@ -81,10 +88,12 @@ private:
   bool _isInitialized{false};
   fs::path vertexShaderPath;
   fs::path fragmentShaderPath;
+  fs::path computeShaderPath;
   mutable std::weak_ptr<ScopedShaderUsage> scopedUsagePtr;
 
   GLuint initializeShader(IFileManager &fileManager, const fs::path &path,
                           GLenum type);
+  GLuint linkProgram(std::initializer_list<GLuint> shaders);
 };
 
 inline constexpr std::string_view Shader::typeToStringView(GLenum type) {
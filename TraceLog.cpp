@@ -0,0 +1,336 @@
+//===- TraceLog.cpp ---------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "TraceLog.h"
+
+#include "exceptions.h"
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+
+namespace SGEng {
+
+// Trace file layout, in native byte order:
+//   "SGTRACE1"
+//   Site records:  uint8 kind, uint32 site, uint8 category, uint32 line,
+//                  uint16 file length, file
+//   Event records: uint8 kind, uint32 site, uint32 thread, int64 nanoseconds
+//                  since the start, uint16 payload size, payload
+// A payload is a sequence of arguments, each one a TraceRecord::ArgumentType
+// followed by the value, strings as uint16 length and characters. Sites are
+// written to the file before any event referring to them.
+
+namespace {
+
+constexpr std::string_view fileMagic{"SGTRACE1"};
+
+enum class RecordKind : uint8_t { Site = 1, Event = 2 };
+
+constexpr std::array<std::string_view,
+                     static_cast<size_t>(TraceCategory::Count)>
+    categoryNames{"fileOperations", "draw",        "input",
+                  "window",         "lifetime",    "buffers",
+                  "shaders",        "glState",     "culling",
+                  "framePacing",    "fixedUpdate", "jobs",
+                  "renderThread"};
+
+template <typename T> void append(std::vector<std::byte> &bytes, T value) {
+  const auto *data = reinterpret_cast<const std::byte *>(&value);
+  bytes.insert(bytes.end(), data, data + sizeof(T));
+}
+
+template <typename T> bool read(std::string_view &bytes, T &value) {
+  if (bytes.size() < sizeof(T))
+    return false;
+  std::memcpy(&value, bytes.data(), sizeof(T));
+  bytes.remove_prefix(sizeof(T));
+  return true;
+}
+
+bool readString(std::string_view &bytes, std::string_view &text) {
+  uint16_t length{0};
+  if (!read(bytes, length) || bytes.size() < length)
+    return false;
+  text = bytes.substr(0, length);
+  bytes.remove_prefix(length);
+  return true;
+}
+
+// Appends the arguments of a payload to the text
+void decodePayload(std::string_view payload, std::ostringstream &out) {
+  using ArgumentType = TraceRecord::ArgumentType;
+  uint8_t type{0};
+  while (read(payload, type)) {
+    switch (static_cast<ArgumentType>(type)) {
+    case ArgumentType::Bool: {
+      uint8_t value{0};
+      if (!read(payload, value))
+        return;
+      out << (value != 0 ? "true" : "false");
+      break;
+    }
+    case ArgumentType::Int: {
+      int64_t value{0};
+      if (!read(payload, value))
+        return;
+      out << value;
+      break;
+    }
+    case ArgumentType::UInt: {
+      uint64_t value{0};
+      if (!read(payload, value))
+        return;
+      out << value;
+      break;
+    }
+    case ArgumentType::Double: {
+      double value{0.0};
+      if (!read(payload, value))
+        return;
+      out << value;
+      break;
+    }
+    case ArgumentType::String: {
+      std::string_view text;
+      if (!readString(payload, text))
+        return;
+      out << text;
+      break;
+    }
+    default:
+      return;
+    }
+  }
+}
+
+} // namespace
+
+TraceLog &TraceLog::get() {
+  static TraceLog traceLog;
+  return traceLog;
+}
+
+TraceLog::~TraceLog() { flush(); }
+
+void TraceLog::setEnabled(TraceCategory category, bool enabled) {
+  if (enabled)
+    enabledCategories.fetch_or(categoryBit(category),
+                               std::memory_order_relaxed);
+  else
+    enabledCategories.fetch_and(~categoryBit(category),
+                                std::memory_order_relaxed);
+}
+
+void TraceLog::disableAll() {
+  enabledCategories.store(0, std::memory_order_relaxed);
+}
+
+std::string_view TraceLog::getName(TraceCategory category) {
+  return categoryNames.at(static_cast<size_t>(category));
+}
+
+std::optional<TraceCategory> TraceLog::parseCategory(std::string_view name) {
+  auto it = std::find(categoryNames.begin(), categoryNames.end(), name);
+  if (it == categoryNames.end())
+    return std::nullopt;
+  return static_cast<TraceCategory>(it - categoryNames.begin());
+}
+
+void TraceLog::setOutputPath(const fs::path &path) {
+  flush();
+  std::lock_guard lock(fileMutex);
+  if (path == outputPath)
+    return;
+  file.close();
+  outputPath = path;
+}
+
+void TraceLog::flush() {
+  std::lock_guard lock(buffersMutex);
+  for (const auto &buffer : threadBuffers) {
+    std::lock_guard bufferLock(buffer->mutex);
+    writeOut(buffer->bytes);
+  }
+  std::lock_guard fileLock(fileMutex);
+  if (file.is_open())
+    file.flush();
+}
+
+uint32_t TraceLog::registerSite(TraceCategory category, const char *file,
+                                unsigned int line) {
+  std::lock_guard lock(fileMutex);
+  auto id = static_cast<uint32_t>(sites.size());
+  sites.push_back({category, fs::path(file).filename().string(), line});
+  if (this->file.is_open())
+    writeSite(id, sites.back());
+  return id;
+}
+
+void TraceLog::write(uint32_t site, Clock::time_point time,
+                     const std::byte *payload, uint16_t payloadSize) {
+  ThreadBuffer &buffer = currentThreadBuffer();
+  std::lock_guard lock(buffer.mutex);
+  std::vector<std::byte> &bytes = buffer.bytes;
+  append(bytes, RecordKind::Event);
+  append(bytes, site);
+  append(bytes, buffer.threadId);
+  append(bytes, static_cast<int64_t>(
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     time - startTime)
+                     .count()));
+  append(bytes, payloadSize);
+  bytes.insert(bytes.end(), payload, payload + payloadSize);
+  if (bytes.size() >= threadBufferSize)
+    writeOut(bytes);
+}
+
+std::string TraceLog::decode(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open())
+    throw FileError{"File could not be opened", path};
+  std::string contents{std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>()};
+  std::string_view bytes{contents};
+  if (!bytes.starts_with(fileMagic))
+    throw FileError{"File is not a trace", path};
+  bytes.remove_prefix(fileMagic.size());
+
+  std::unordered_map<uint32_t, Site> decodedSites;
+  // Threads write their records in chunks, lines are sorted by time instead
+  std::vector<std::pair<int64_t, std::string>> lines;
+  RecordKind kind{};
+  while (read(bytes, kind)) {
+    uint32_t siteId{0};
+    if (kind == RecordKind::Site) {
+      uint8_t category{0};
+      uint32_t line{0};
+      std::string_view fileName;
+      if (!read(bytes, siteId) || !read(bytes, category) ||
+          !read(bytes, line) || !readString(bytes, fileName) ||
+          category >= static_cast<uint8_t>(TraceCategory::Count))
+        break;
+      decodedSites[siteId] = {static_cast<TraceCategory>(category),
+                              std::string(fileName), line};
+    } else if (kind == RecordKind::Event) {
+      uint32_t threadId{0};
+      int64_t nanoseconds{0};
+      uint16_t payloadSize{0};
+      if (!read(bytes, siteId) || !read(bytes, threadId) ||
+          !read(bytes, nanoseconds) || !read(bytes, payloadSize) ||
+          bytes.size() < payloadSize)
+        break;
+      std::string_view payload = bytes.substr(0, payloadSize);
+      bytes.remove_prefix(payloadSize);
+      std::ostringstream line;
+      line << std::fixed << std::setprecision(6)
+           << static_cast<double>(nanoseconds) / 1e9 << " [" << threadId
+           << "] ";
+      auto site = decodedSites.find(siteId);
+      if (site != decodedSites.end())
+        line << getName(site->second.category) << " [" << site->second.file
+             << '@' << site->second.line << "] ";
+      line << std::defaultfloat;
+      decodePayload(payload, line);
+      lines.emplace_back(nanoseconds, line.str());
+    } else {
+      break;
+    }
+  }
+  std::stable_sort(
+      lines.begin(), lines.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::string text;
+  for (const auto &[nanoseconds, line] : lines)
+    text.append(line).append("\n");
+  return text;
+}
+
+TraceLog::ThreadBuffer &TraceLog::currentThreadBuffer() {
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<ThreadBuffer>();
+    buffer->bytes.reserve(threadBufferSize);
+    std::lock_guard lock(buffersMutex);
+    buffer->threadId = static_cast<uint32_t>(threadBuffers.size() + 1);
+    threadBuffers.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void TraceLog::writeOut(std::vector<std::byte> &bytes) {
+  if (bytes.empty())
+    return;
+  std::lock_guard lock(fileMutex);
+  if (openFile())
+    file.write(reinterpret_cast<const char *>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+  bytes.clear();
+}
+
+bool TraceLog::openFile() {
+  if (file.is_open())
+    return true;
+  if (outputPath.empty())
+    return false;
+  file.open(outputPath, std::ios::binary | std::ios::trunc);
+  if (!file.is_open())
+    return false;
+  file.write(fileMagic.data(), static_cast<std::streamsize>(fileMagic.size()));
+  for (size_t i = 0; i < sites.size(); i++)
+    writeSite(static_cast<uint32_t>(i), sites[i]);
+  return true;
+}
+
+void TraceLog::writeSite(uint32_t id, const Site &site) {
+  std::vector<std::byte> bytes;
+  append(bytes, RecordKind::Site);
+  append(bytes, id);
+  append(bytes, static_cast<uint8_t>(site.category));
+  append(bytes, static_cast<uint32_t>(site.line));
+  auto length = static_cast<uint16_t>(
+      std::min<size_t>(site.file.size(), UINT16_MAX));
+  append(bytes, length);
+  const auto *file = reinterpret_cast<const std::byte *>(site.file.data());
+  bytes.insert(bytes.end(), file, file + length);
+  this->file.write(reinterpret_cast<const char *>(bytes.data()),
+                   static_cast<std::streamsize>(bytes.size()));
+}
+
+void TraceRecord::appendString(std::string_view text) {
+  size_t header = 1 + sizeof(uint16_t);
+  if (payloadSize + header > maxPayloadSize)
+    return;
+  auto length = static_cast<uint16_t>(
+      std::min(text.size(), maxPayloadSize - payloadSize - header));
+  payload[payloadSize++] = static_cast<std::byte>(ArgumentType::String);
+  std::memcpy(payload.data() + payloadSize, &length, sizeof(length));
+  payloadSize += sizeof(length);
+  std::memcpy(payload.data() + payloadSize, text.data(), length);
+  payloadSize += length;
+}
+
+} // namespace SGEng
@@ -0,0 +1,222 @@
+//===- TraceLog.h -----------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "constants.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace SGEng {
+
+namespace fs = std::filesystem;
+
+// Categories of diagnostic traces, each one can be enabled separately
+enum class TraceCategory : uint8_t {
+  FileOperations,
+  Draw,
+  Input,
+  Window,
+  Lifetime, // Constructors, assignments and destructors
+  Buffers,  // Buffer objects, VAOs and their linking
+  Shaders,
+  GLState,
+  Culling,
+  FramePacing,
+  FixedUpdate,
+  Jobs,
+  RenderThread,
+  Count
+};
+
+// Registry of trace categories and writer of the binary trace that records
+// of enabled categories go to. Checking a disabled category costs a relaxed
+// load of one atomic mask and a branch. Records are encoded in binary,
+// without any text formatting, into a buffer of the recording thread, and
+// the buffers are appended to the trace file when they fill up and on
+// flush(). decode() turns a trace file into text.
+class TraceLog {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  // Bytes buffered per thread before they are written to the trace file
+  static constexpr size_t threadBufferSize{64 * 1024};
+
+  static TraceLog &get();
+  TraceLog(const TraceLog &traceLog) = delete;
+  TraceLog &operator=(const TraceLog &traceLog) = delete;
+  ~TraceLog();
+
+  static bool isEnabled(TraceCategory category) {
+    return (enabledCategories.load(std::memory_order_relaxed) &
+            categoryBit(category)) != 0;
+  }
+  static void setEnabled(TraceCategory category, bool enabled);
+  static void disableAll();
+  static std::string_view getName(TraceCategory category);
+  static std::optional<TraceCategory> parseCategory(std::string_view name);
+
+  // Flushes the trace written so far, the next records start a new trace file
+  void setOutputPath(const fs::path &path);
+  // Writes the records buffered by every thread to the trace file
+  void flush();
+
+  // Returns the ID of a call site, records only refer to it by the ID
+  uint32_t registerSite(TraceCategory category, const char *file,
+                        unsigned int line);
+  void write(uint32_t site, Clock::time_point time, const std::byte *payload,
+             uint16_t payloadSize);
+
+  // Text of a trace file, one record per line. Throws FileError when the file
+  // cannot be read.
+  static std::string decode(const fs::path &path);
+
+private:
+  struct Site {
+    TraceCategory category;
+    std::string file;
+    unsigned int line;
+  };
+
+  struct ThreadBuffer {
+    std::mutex mutex;
+    uint32_t threadId{0};
+    std::vector<std::byte> bytes;
+  };
+
+  // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+  inline static std::atomic<uint32_t> enabledCategories{0};
+  static_assert(static_cast<size_t>(TraceCategory::Count) <= 32,
+                "Categories do not fit into the mask");
+
+  Clock::time_point startTime{Clock::now()};
+
+  // Registration happens once per thread, flushing holds the mutex too
+  std::mutex buffersMutex;
+  std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+
+  // Guards the file and the sites, locked after a thread buffer
+  std::mutex fileMutex;
+  fs::path outputPath{defaultTracePath};
+  std::ofstream file;
+  std::vector<Site> sites;
+
+  TraceLog() = default;
+  static uint32_t categoryBit(TraceCategory category) {
+    return 1u << static_cast<uint32_t>(category);
+  }
+  ThreadBuffer &currentThreadBuffer();
+  void writeOut(std::vector<std::byte> &bytes);
+  bool openFile();
+  void writeSite(uint32_t id, const Site &site);
+};
+
+// Trace record of one call site, encoded as it is streamed into. Numbers are
+// stored as they are, strings are copied, anything else is formatted through
+// its stream operator. Arguments that do not fit are truncated.
+class TraceRecord {
+public:
+  enum class ArgumentType : uint8_t { Bool, Int, UInt, Double, String };
+
+  static constexpr size_t maxPayloadSize{256};
+
+  explicit TraceRecord(uint32_t site)
+      : site{site}, time{TraceLog::Clock::now()} {}
+  TraceRecord(const TraceRecord &record) = delete;
+  TraceRecord &operator=(const TraceRecord &record) = delete;
+  ~TraceRecord() {
+    TraceLog::get().write(site, time, payload.data(),
+                          static_cast<uint16_t>(payloadSize));
+  }
+
+  template <typename T> TraceRecord &operator<<(const T &value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      append(ArgumentType::Bool, static_cast<uint8_t>(value));
+    } else if constexpr (std::is_same_v<T, char>) {
+      appendString(std::string_view(&value, 1));
+    } else if constexpr (std::is_enum_v<T>) {
+      *this << static_cast<std::underlying_type_t<T>>(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      append(ArgumentType::Int, static_cast<int64_t>(value));
+    } else if constexpr (std::is_integral_v<T>) {
+      append(ArgumentType::UInt, static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+      append(ArgumentType::Double, static_cast<double>(value));
+    } else if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      appendString(value);
+    } else {
+      std::ostringstream text;
+      text << value;
+      appendString(text.str());
+    }
+    return *this;
+  }
+
+private:
+  uint32_t site;
+  TraceLog::Clock::time_point time;
+  size_t payloadSize{0};
+  std::array<std::byte, maxPayloadSize> payload;
+
+  template <typename T> void append(ArgumentType type, T value) {
+    if (payloadSize + 1 + sizeof(T) > maxPayloadSize)
+      return;
+    payload[payloadSize++] = static_cast<std::byte>(type);
+    std::memcpy(payload.data() + payloadSize, &value, sizeof(T));
+    payloadSize += sizeof(T);
+  }
+
+  void appendString(std::string_view text);
+};
+
+} // namespace SGEng
+
+// Streams a record of the category, when it is enabled:
+//   SGENG_TRACE(Buffers) << "SSBO storage resized to " << capacity;
+// The arguments are not evaluated when the category is disabled. Being a
+// single for statement, it also keeps the else of an unbraced if around it.
+#define SGENG_TRACE(category)                                                  \
+  for (bool sgengTraceOnce =                                                   \
+           ::SGEng::TraceLog::isEnabled(::SGEng::TraceCategory::category);     \
+       sgengTraceOnce; sgengTraceOnce = false)                                 \
+  ::SGEng::TraceRecord([] {                                                    \
+    static const uint32_t site = ::SGEng::TraceLog::get().registerSite(        \
+        ::SGEng::TraceCategory::category, __FILE__, __LINE__);                 \
+    return site;                                                               \
+  }())
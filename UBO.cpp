@@ -0,0 +1,88 @@
+//===- UBO.cpp --------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "UBO.h"
+
+#include "TraceLog.h"
+#include "constants.h"
+#include <utility>
+
+namespace SGEng {
+
+UBO::UBO(size_t size) { initialize(size); }
+
+UBO::UBO(UBO &&ubo) noexcept : id{ubo.id}, size{ubo.size} {
+  ubo.id = 0;
+  ubo.size = 0;
+}
+
+UBO &UBO::operator=(UBO &&ubo) noexcept {
+  if (this != &ubo) {
+    tryDestroy();
+    std::swap(id, ubo.id);
+    std::swap(size, ubo.size);
+  }
+  return *this;
+}
+
+UBO::~UBO() { tryDestroy(); }
+
+bool UBO::isInitialized() const { return id != 0; }
+
+void UBO::initialize(size_t size) {
+  tryDestroy();
+  SGENG_TRACE(Buffers) << "UBO initialization...";
+  glCreateBuffers(1, &id);
+  glNamedBufferStorage(id, static_cast<GLsizeiptr>(size), nullptr,
+                       GL_DYNAMIC_STORAGE_BIT);
+  this->size = size;
+}
+
+GLuint UBO::getId() const { return id; }
+
+size_t UBO::getSize() const { return size; }
+
+void UBO::set(const void *data, size_t size, size_t offset) {
+  glNamedBufferSubData(id, static_cast<GLintptr>(offset),
+                       static_cast<GLsizeiptr>(size), data);
+}
+
+void UBO::bindBase(GLuint bindingIndex) const {
+  glBindBufferBase(GL_UNIFORM_BUFFER, bindingIndex, id);
+}
+
+void UBO::tryDestroy() {
+  if (isInitialized())
+    destroy();
+}
+
+void UBO::destroy() {
+  glDeleteBuffers(1, &id);
+  id = 0;
+  size = 0;
+  SGENG_TRACE(Buffers) << "UBO destroyed";
+}
+
+} // namespace SGEng
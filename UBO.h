@@ -0,0 +1,56 @@
+//===- UBO.h ----------------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <glad/gl.h>
+
+namespace SGEng {
+
+class UBO {
+public:
+  UBO() = default;
+  UBO(size_t size);
+  UBO(const UBO &ubo) = delete;
+  UBO &operator=(const UBO &ubo) = delete;
+  UBO(UBO &&ubo) noexcept;
+  UBO &operator=(UBO &&ubo) noexcept;
+  ~UBO();
+
+  bool isInitialized() const;
+  void initialize(size_t size);
+  GLuint getId() const;
+  size_t getSize() const;
+  void set(const void *data, size_t size, size_t offset = 0);
+  void bindBase(GLuint bindingIndex) const;
+  void tryDestroy();
+  void destroy();
+
+private:
+  GLuint id{0};
+  size_t size{0};
+};
+
+} // namespace SGEng
@@ -25,8 +25,10 @@
 //===----------------------------------------------------------------------===//
 #include "VAO.h"
 
+#include "GLState.h"
+#include "TraceLog.h"
 #include "constants.h"
-#include <plog/Log.h>
+#include <algorithm>
 
 namespace SGEng {
 
@@ -57,7 +59,7 @@ VAO::~VAO() { tryDestroy(); }
 bool VAO::isInitialized() const { return id != 0; }
 
 void VAO::initialize() {
-  PLOGV_IF(LOG_VAO) << "VAO initialization...";
+  SGENG_TRACE(Buffers) << "VAO initialization...";
   glCreateVertexArrays(1, &id);
 }
 
@@ -67,20 +69,25 @@ void VAO::linkVBO(GLuint vboId, const DataLayout &dataLayout,
                   GLuint bindingIndex) {
   if (!isInitialized())
     initialize();
-  PLOGV_IF(LOG_BUFFER_LINKING) << "Linking VBO to VAO...";
+  SGENG_TRACE(Buffers) << "Linking VBO to VAO...";
   this->dataLayout = dataLayout;
-  size_t accumulatedSize{0};
+  size_t layoutSize{0};
   for (const auto &[layoutIndex, subDataLayout] : dataLayout) {
     glEnableVertexArrayAttrib(id, layoutIndex);
     glVertexArrayAttribBinding(id, layoutIndex, bindingIndex);
-    glVertexArrayAttribFormat(
-        id, layoutIndex, static_cast<GLint>(subDataLayout.length), GL_FLOAT,
-        GL_FALSE, static_cast<GLuint>(subDataLayout.offset));
-    accumulatedSize += subDataLayout.length;
+    auto size = static_cast<GLint>(subDataLayout.length);
+    auto offset = static_cast<GLuint>(subDataLayout.offset);
+    if (subDataLayout.isInteger)
+      glVertexArrayAttribIFormat(id, layoutIndex, size, subDataLayout.type,
+                                 offset);
+    else
+      glVertexArrayAttribFormat(id, layoutIndex, size, subDataLayout.type,
+                                subDataLayout.normalized, offset);
+    layoutSize =
+        std::max(layoutSize, subDataLayout.offset + subDataLayout.getSize());
   }
-  glVertexArrayVertexBuffer(
-      id, bindingIndex, vboId, 0,
-      static_cast<GLsizei>(accumulatedSize * sizeof(GLfloat)));
+  glVertexArrayVertexBuffer(id, bindingIndex, vboId, 0,
+                            static_cast<GLsizei>(layoutSize));
 }
 
 VAO &VAO::withVBO(GLuint vboId, const DataLayout &dataLayout,
@@ -92,7 +99,7 @@ VAO &VAO::withVBO(GLuint vboId, const DataLayout &dataLayout,
 void VAO::linkEBO(GLuint eboId) {
   if (!isInitialized())
     initialize();
-  PLOGV_IF(LOG_BUFFER_LINKING) << "Linking EBO to VAO...";
+  SGENG_TRACE(Buffers) << "Linking EBO to VAO...";
   glVertexArrayElementBuffer(id, eboId);
 }
 
@@ -101,9 +108,9 @@ VAO &VAO::withEBO(GLuint eboId) {
   return *this;
 }
 
-void VAO::bind() const { glBindVertexArray(id); }
+void VAO::bind() const { GLState::current().bindVertexArray(id); }
 
-void VAO::unbind() const { glBindVertexArray(0); }
+void VAO::unbind() const { GLState::current().releaseVertexArray(id); }
 
 void VAO::tryDestroy() {
   if (isInitialized())
@@ -111,9 +118,10 @@ void VAO::tryDestroy() {
 }
 
 void VAO::destroy() {
+  GLState::current().forgetVertexArray(id);
   glDeleteVertexArrays(1, &id);
   id = 0;
-  PLOGV_IF(LOG_VAO) << "VAO destroyed";
+  SGENG_TRACE(Buffers) << "VAO destroyed";
 }
 
 VAO VAO::linkedWithVBO(GLuint vboId, const DataLayout &dataLayout,
@@ -46,6 +46,7 @@ public:
   bool isInitialized() const;
   void initialize();
   GLuint getId() const;
+  // The stride is the end of the last attribute
   void linkVBO(GLuint vboId, const DataLayout &dataLayout,
                GLuint bindingIndex = 0);
   VAO &withVBO(GLuint vboId, const DataLayout &dataLayout,
@@ -25,9 +25,9 @@
 //===----------------------------------------------------------------------===//
 #include "VBO.h"
 
+#include "TraceLog.h"
 #include "Vertex.h"
 #include "constants.h"
-#include <plog/Log.h>
 #include <utility>
 
 namespace SGEng {
@@ -52,14 +52,14 @@ bool VBO::isInitialized() const { return id != 0; }
 
 void VBO::initialize(const GLfloat *data, size_t size) {
   tryDestroy();
-  PLOGV_IF(LOG_BUFFERS) << "VBO initialization...";
+  SGENG_TRACE(Buffers) << "VBO initialization...";
   glCreateBuffers(1, &id);
   set(data, size);
 }
 
 void VBO::initialize(const Vertex *vertices, size_t size) {
   tryDestroy();
-  PLOGV_IF(LOG_BUFFERS) << "VBO initialization...";
+  SGENG_TRACE(Buffers) << "VBO initialization...";
   glCreateBuffers(1, &id);
   set(vertices, size);
 }
@@ -94,7 +94,7 @@ void VBO::tryDestroy() {
 void VBO::destroy() {
   glDeleteBuffers(1, &id);
   id = 0;
-  PLOGV_IF(LOG_BUFFERS) << "VBO destroyed";
+  SGENG_TRACE(Buffers) << "VBO destroyed";
 }
 
 #if __cplusplus >= 202002L
@@ -104,14 +104,14 @@ VBO::VBO(std::span<Vertex> vertices) { initialize(vertices); }
 
 void VBO::initialize(std::span<GLfloat> data) {
   tryDestroy();
-  PLOGV_IF(LOG_BUFFERS) << "VBO initialization...";
+  SGENG_TRACE(Buffers) << "VBO initialization...";
   glCreateBuffers(1, &id);
   set(data);
 }
 
 void VBO::initialize(std::span<Vertex> vertices) {
   tryDestroy();
-  PLOGV_IF(LOG_BUFFERS) << "VBO initialization...";
+  SGENG_TRACE(Buffers) << "VBO initialization...";
   glCreateBuffers(1, &id);
   set(vertices);
 }
@@ -135,6 +135,28 @@ void VBO::set(std::span<Vertex> vertices) {
   glNamedBufferData(id, static_cast<GLsizeiptr>(vertices.size_bytes()),
                     vertices.data(), GL_STATIC_DRAW);
 }
+
+VBO::VBO(VertexSpan vertices) { initialize(vertices); }
+
+void VBO::initialize(VertexSpan vertices) {
+  tryDestroy();
+  SGENG_TRACE(Buffers) << "VBO initialization...";
+  glCreateBuffers(1, &id);
+  set(vertices);
+}
+
+void VBO::set(VertexSpan vertices) {
+  glNamedBufferData(id, static_cast<GLsizeiptr>(vertices.size_bytes()),
+                    vertices.data, GL_STATIC_DRAW);
+}
+
+void VBO::setSubData(VertexSpan vertices, size_t offset) {
+  glNamedBufferSubData(
+      id,
+      static_cast<GLintptr>(offset *
+                            VertexSpan::getVertexSize(vertices.format)),
+      static_cast<GLsizeiptr>(vertices.size_bytes()), vertices.data);
+}
 #endif
 
 } // namespace SGEng
\ No newline at end of file
@@ -28,6 +28,7 @@
 #include <glad/gl.h>
 
 #if __cplusplus >= 202002L
+#include "VertexSpan.h"
 #include <span>
 #endif
 
@@ -66,6 +67,11 @@ public:
   VBO &initializedWith(std::span<Vertex> vertices);
   void set(std::span<GLfloat> data);
   void set(std::span<Vertex> vertices);
+  VBO(VertexSpan vertices);
+  void initialize(VertexSpan vertices);
+  void set(VertexSpan vertices);
+  // The offset counts vertices of the format of the span
+  void setSubData(VertexSpan vertices, size_t offset);
 #endif
 
 private:
@@ -25,6 +25,9 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <glad/gl.h>
 #include <glm/vec3.hpp>
 
 namespace SGEng {
@@ -34,4 +37,23 @@ struct Vertex {
   glm::vec3 normal;
 };
 
+// How the vertices of a mesh are stored in its vertex buffer
+enum class VertexFormat : uint32_t { Float, Packed };
+
+// Half the size of Vertex. The position is stored as 16-bit normalized
+// coordinates within the bounding box of the mesh and the normal as
+// GL_INT_2_10_10_10_REV, both converted to floats by the vertex fetch.
+struct PackedVertex {
+  std::array<GLushort, 3> position;
+  GLushort padding;
+  GLuint normal;
+};
+
+// Maps normalized packed positions back to model space, position = offset +
+// scale * packed position. The identity leaves float positions as they are.
+struct PositionQuantization {
+  glm::vec3 scale{1.f, 1.f, 1.f};
+  glm::vec3 offset{0.f, 0.f, 0.f};
+};
+
 } // namespace SGEng
@@ -0,0 +1,77 @@
+//===- VertexSpan.h ---------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Vertex.h"
+#include "vertex_compression.h"
+#include <cstddef>
+#include <span>
+
+namespace SGEng {
+
+// Vertices stored either as Vertex or as PackedVertex together with the
+// quantization of their positions, see VertexFormat
+struct VertexSpan {
+  VertexFormat format{VertexFormat::Float};
+  const void *data{nullptr};
+  size_t count{0};
+  PositionQuantization quantization;
+
+  VertexSpan() = default;
+  VertexSpan(VertexFormat format, const void *data, size_t count,
+             const PositionQuantization &quantization = {})
+      : format{format}, data{data}, count{count}, quantization{quantization} {
+  }
+  VertexSpan(std::span<const Vertex> vertices)
+      : format{VertexFormat::Float}, data{vertices.data()},
+        count{vertices.size()} {}
+  VertexSpan(std::span<const PackedVertex> vertices,
+             const PositionQuantization &quantization)
+      : format{VertexFormat::Packed}, data{vertices.data()},
+        count{vertices.size()}, quantization{quantization} {}
+
+  static size_t getVertexSize(VertexFormat format) {
+    return format == VertexFormat::Packed ? sizeof(PackedVertex)
+                                          : sizeof(Vertex);
+  }
+
+  size_t size() const { return count; }
+  size_t size_bytes() const { return count * getVertexSize(format); }
+  bool empty() const { return count == 0; }
+  std::span<const std::byte> bytes() const {
+    return {static_cast<const std::byte *>(data), size_bytes()};
+  }
+
+  // The vertex as the vertex shader sees it
+  Vertex operator[](size_t i) const {
+    if (format == VertexFormat::Packed)
+      return unpackVertex(static_cast<const PackedVertex *>(data)[i],
+                          quantization);
+    return static_cast<const Vertex *>(data)[i];
+  }
+};
+
+} // namespace SGEng
@@ -27,7 +27,10 @@
 
 #include "App.h"
 #include "Config.h"
+#include "GLState.h"
+#include "RenderThread.h"
 #include "Renderer.h"
+#include "TraceLog.h"
 #include "exceptions.h"
 #include <plog/Log.h>
 
@@ -36,7 +39,7 @@ namespace SGEng {
 Window::Window(Context &ctx)
     : ctx{ctx}, width{ctx.cfg.windowWidth}, height{ctx.cfg.windowHeight},
       title{ctx.cfg.windowTitle}, backgroundColor{ctx.cfg.backgroundColor} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Window constructor...";
+  SGENG_TRACE(Lifetime) << "Window constructor...";
 }
 
 Window::Window(const Window &window)
@@ -44,11 +47,11 @@ Window::Window(const Window &window)
       height{window.ctx.get().cfg.windowHeight},
       title{window.ctx.get().cfg.windowTitle},
       backgroundColor{window.ctx.get().cfg.backgroundColor} {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Window copy constructor...";
+  SGENG_TRACE(Lifetime) << "Window copy constructor...";
 }
 
 Window &Window::operator=(const Window &window) {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "Window copy assignment...";
+  SGENG_TRACE(Lifetime) << "Window copy assignment...";
   ctx = window.ctx;
   resize(window.width, window.height);
   setTitle(window.title);
@@ -57,10 +60,12 @@ Window &Window::operator=(const Window &window) {
 }
 
 Window::Window(Window &&window) noexcept : ctx(window.ctx) {
-  PLOGV_IF(LOG_CONSTRUCTORS) << "Window move constructor...";
+  SGENG_TRACE(Lifetime) << "Window move constructor...";
   if (isInitialized()) {
     destroy();
   }
+  // The render thread refers to the window it was started for
+  window.stopRenderThread();
   this->backgroundColor = window.backgroundColor;
   this->width = window.width;
   this->height = window.height;
@@ -68,6 +73,9 @@ Window::Window(Window &&window) noexcept : ctx(window.ctx) {
   this->window = std::move(window.window);
   this->_isInitialized = window._isInitialized;
   renderer.swap(window.renderer);
+  headlessContext.swap(window.headlessContext);
+  offscreenFramebuffer = std::move(window.offscreenFramebuffer);
+  headlessShouldClose = window.headlessShouldClose;
   window.backgroundColor = defaultBackgroundColor;
   window.width = defaultWindowWidth;
   window.height = defaultWindowHeight;
@@ -77,11 +85,12 @@ Window::Window(Window &&window) noexcept : ctx(window.ctx) {
 }
 
 Window &Window::operator=(Window &&window) noexcept {
-  PLOGV_IF(LOG_ASSIGNMENTS) << "Window move assignment...";
+  SGENG_TRACE(Lifetime) << "Window move assignment...";
   if (this != &window) {
     if (isInitialized()) {
       destroy();
     }
+    window.stopRenderThread();
     this->backgroundColor = window.backgroundColor;
     this->width = window.width;
     this->height = window.height;
@@ -90,6 +99,9 @@ Window &Window::operator=(Window &&window) noexcept {
     this->_isInitialized = window._isInitialized;
     std::swap(this->ctx, window.ctx);
     renderer.swap(window.renderer);
+    headlessContext.swap(window.headlessContext);
+    offscreenFramebuffer = std::move(window.offscreenFramebuffer);
+    headlessShouldClose = window.headlessShouldClose;
     window.backgroundColor = defaultBackgroundColor;
     window.width = defaultWindowWidth;
     window.height = defaultWindowHeight;
@@ -103,7 +115,7 @@ Window &Window::operator=(Window &&window) noexcept {
 }
 
 Window::~Window() {
-  PLOGV_IF(LOG_DESTRUCTORS) << "Window destructor...";
+  SGENG_TRACE(Lifetime) << "Window destructor...";
   destroy();
   ctx.get().currentWindow = nullptr;
 }
@@ -119,12 +131,20 @@ void Window::initialize() {
   ctx.get().currentWindow = this;
   PLOGV << "Initializing window...";
 
-  if (!ctx.get().isGLFWInitialized)
-    throw WindowInitializationError("GLFW is not initialized");
-
   if (isInitialized())
     throw WindowInitializationError("Window is already initialized");
 
+  if (ctx.get().cfg.headless) {
+    headlessContext = std::make_unique<HeadlessContext>();
+    headlessContext->initialize(ctx.get().cfg.headlessBackend);
+    _isInitialized = true;
+    PLOGV << "Headless window initialized";
+    return;
+  }
+
+  if (!ctx.get().isGLFWInitialized)
+    throw WindowInitializationError("GLFW is not initialized");
+
   if (width <= 0 || height <= 0)
     throw WindowInitializationError(
         "Invalid window dimensions: " + std::to_string(width) + " x " +
@@ -141,6 +161,8 @@ void Window::initialize() {
                           GLFW_DONT_CARE);
 
   glfwGetWindowPos(window, &position.x, &position.y);
+  glfwGetFramebufferSize(window, &eventThreadFramebufferSize.x,
+                         &eventThreadFramebufferSize.y);
 
   _isInitialized = true;
   PLOGV_IF(window != nullptr) << "Window innitialized";
@@ -148,13 +170,28 @@ void Window::initialize() {
 }
 
 void Window::makeContextCurrent() {
-  glfwMakeContextCurrent(window);
+  if (isHeadless())
+    headlessContext->makeCurrent();
+  else
+    glfwMakeContextCurrent(window);
+  GLState::current().setContextCurrent(true);
   ctx.get().currentWindow = this;
   PLOGV << "Window context made current";
 }
 
+void Window::releaseContext() {
+  if (isHeadless())
+    headlessContext->releaseCurrent();
+  else
+    glfwMakeContextCurrent(nullptr);
+  GLState::current().setContextCurrent(false);
+  PLOGV << "Window context released";
+}
+
 bool Window::isInitialized() const { return _isInitialized; }
 
+bool Window::isHeadless() const { return headlessContext != nullptr; }
+
 unsigned int Window::getWidth() const { return width; }
 
 unsigned int Window::getHeight() const { return height; }
@@ -167,15 +204,27 @@ void Window::resize(int width, int height) {
     return;
   }
 
+  if (this->width != width || this->height != height) {
+    if (window)
+      glfwSetWindowSize(window, width, height);
+    resizeFramebuffer(width, height);
+  }
+}
+
+void Window::resizeFramebuffer(int width, int height) {
+  if (width < defaultMinWindowWidth || height < defaultMinWindowHeight) {
+    PLOGV << "Window size too small: " << width << "x" << height;
+    return;
+  }
+
   if (this->width != width || this->height != height) {
     this->width = width;
     this->height = height;
-    if (isInitialized())
-      glfwSetWindowSize(window, width, height);
-    if (ctx.get().isGLInitialized) {
+    // The offscreen framebuffer is resized by the renderer, on the thread
+    // owning the context
+    if (ctx.get().isGLInitialized && renderer)
       renderer->setNeedsToResize();
-    }
-    PLOGV_IF(LOG_WINDOW_RESIZE) << "Window resized";
+    SGENG_TRACE(Window) << "Window resized";
   }
 }
 
@@ -184,8 +233,9 @@ const std::string &Window::getTitle() const { return title; }
 void Window::setTitle(const std::string &title) {
   if (this->title != title) {
     this->title = title;
-    glfwSetWindowTitle(window, title.c_str());
-    PLOGV_IF(LOG_WINDOW_TITLE_CHANGE) << "Window title changed";
+    if (window)
+      glfwSetWindowTitle(window, title.c_str());
+    SGENG_TRACE(Window) << "Window title changed";
   }
 }
 
@@ -194,7 +244,7 @@ Color Window::getBackgroundColor() const { return backgroundColor; }
 void Window::setBackgroundColor(Color backgroundColor) {
   if (this->backgroundColor != backgroundColor) {
     this->backgroundColor = backgroundColor;
-    PLOGV_IF(LOG_WINDOW_BACKGROUND_COLOR_CHANGE) << "Background color changed";
+    SGENG_TRACE(Window) << "Background color changed";
   }
 }
 
@@ -202,21 +252,43 @@ glm::ivec2 Window::getPosition() const { return position; }
 
 void Window::setPosition(glm::ivec2 position) {
   if (this->position != position) {
-    glfwSetWindowPos(window, position.x, position.y);
+    if (window)
+      glfwSetWindowPos(window, position.x, position.y);
     this->position = position;
   }
 }
 
+const FBO &Window::getOffscreenFramebuffer() const {
+  return offscreenFramebuffer;
+}
+
+void Window::resizeOffscreenFramebuffer() {
+  if (offscreenFramebuffer.isInitialized() &&
+      (offscreenFramebuffer.getWidth() != width ||
+       offscreenFramebuffer.getHeight() != height))
+    offscreenFramebuffer.initialize(width, height);
+}
+
 bool Window::isActive() const { return !shouldClose(); }
 
-bool Window::shouldClose() const { return glfwWindowShouldClose(window); }
+bool Window::shouldClose() const {
+  if (isHeadless())
+    return headlessShouldClose;
+  return glfwWindowShouldClose(window);
+}
 
 void Window::close() {
-  glfwSetWindowShouldClose(window, true);
+  if (isHeadless())
+    headlessShouldClose = true;
+  else
+    glfwSetWindowShouldClose(window, true);
   PLOGV << "Window closed";
 }
 
-void Window::swapBuffers() const { glfwSwapBuffers(window); }
+void Window::swapBuffers() const {
+  if (window)
+    glfwSwapBuffers(window);
+}
 
 void Window::clearScreen() const {
   auto col = backgroundColor.vec4f();
@@ -225,32 +297,165 @@ void Window::clearScreen() const {
 }
 
 void Window::destroy() {
+  stopRenderThread();
   if (isInitialized()) {
-    glfwDestroyWindow(window);
+    if (renderer)
+      renderer->getMeshUploader().destroy();
+    offscreenFramebuffer.tryDestroy();
+    if (isHeadless()) {
+      headlessContext->destroy();
+    } else {
+      glfwDestroyWindow(window);
+    }
     _isInitialized = false;
     PLOGV << "Window destroyed";
   }
 }
 
 void Window::draw(const Scene &scene) const {
-  clearScreen();
-
+  if (renderThread) {
+    renderThread->submit(scene);
+    return;
+  }
+  beginFrame();
   renderer->render(scene);
+  endFrame();
+}
 
+void Window::renderFrame(const Scene &scene,
+                         const FrameSnapshot &snapshot) const {
+  beginFrame();
+  renderer->renderFrame(scene, snapshot);
+  endFrame();
+}
+
+void Window::beginFrame() const {
+  renderer->update();
+  if (offscreenFramebuffer.isInitialized())
+    offscreenFramebuffer.bind();
+  clearScreen();
+}
+
+void Window::endFrame() const {
+  if (offscreenFramebuffer.isInitialized() && !isHeadless()) {
+    offscreenFramebuffer.blitToDefaultFramebuffer();
+    offscreenFramebuffer.unbind();
+  }
   swapBuffers();
 }
 
-void Window::update() {
-  if (needsToChangeTitle) {
-    setTitle(newTitle);
-    needsToChangeTitle = false;
+void Window::startRenderThread(unsigned int framesInFlight) {
+  if (renderThread)
+    return;
+  releaseContext();
+  renderThread = std::make_unique<RenderThread>(*this, framesInFlight);
+}
+
+void Window::stopRenderThread() {
+  if (!renderThread)
+    return;
+  renderThread.reset();
+  makeContextCurrent();
+  // The cached state of this thread is stale after the render thread used
+  // the context
+  GLState::current().invalidate();
+}
+
+RenderThread *Window::getRenderThread() { return renderThread.get(); }
+
+void Window::runOnRenderThread(std::function<void()> task) {
+  if (renderThread)
+    renderThread->runAndWait(std::move(task));
+  else
+    task();
+}
+
+void Window::setCursorMode(int mode) {
+  if (window)
+    glfwSetInputMode(window, GLFW_CURSOR, mode);
+}
+
+void Window::postCommand(WindowCommand command) {
+  if (isHeadless() || !window) {
+    applyCommand(command);
+    return;
+  }
+
+  bool isEventThreadCommand =
+      command.type != WindowCommand::Type::ResizeFramebuffer;
+  auto &queue = isEventThreadCommand ? eventThreadCommands : gameThreadCommands;
+  if (!queue.push(std::move(command))) {
+    PLOGW << "Window command queue full, command dropped";
+    return;
   }
+  // The event thread may be blocked waiting for events
+  if (isEventThreadCommand)
+    glfwPostEmptyEvent();
 }
 
-void Window::setNeedsToChangeTitle(const std::string &title) {
-  if (this->title != title) {
-    newTitle = title;
-    needsToChangeTitle = true;
+void Window::requestTitle(std::string title) {
+  postCommand(
+      {.type = WindowCommand::Type::SetTitle, .title = std::move(title)});
+}
+
+void Window::requestSize(int width, int height) {
+  postCommand(
+      {.type = WindowCommand::Type::SetSize, .value = {width, height}});
+}
+
+void Window::requestPosition(glm::ivec2 position) {
+  postCommand({.type = WindowCommand::Type::SetPosition, .value = position});
+}
+
+void Window::requestCursorMode(int mode) {
+  postCommand({.type = WindowCommand::Type::SetCursorMode, .cursorMode = mode});
+}
+
+void Window::requestClose() {
+  postCommand({.type = WindowCommand::Type::Close});
+}
+
+void Window::processEventThreadCommands() {
+  WindowCommand command;
+  while (eventThreadCommands.pop(command))
+    applyCommand(command);
+}
+
+void Window::processGameThreadCommands() {
+  WindowCommand command;
+  while (gameThreadCommands.pop(command))
+    applyCommand(command);
+}
+
+void Window::applyCommand(const WindowCommand &command) {
+  switch (command.type) {
+  case WindowCommand::Type::SetTitle:
+    setTitle(command.title);
+    break;
+  case WindowCommand::Type::SetSize:
+    // Only the GLFW window is resized here, the framebuffer follows with a
+    // command from the refresh callback
+    if (window)
+      glfwSetWindowSize(window, command.value.x, command.value.y);
+    else
+      resizeFramebuffer(command.value.x, command.value.y);
+    break;
+  case WindowCommand::Type::SetPosition:
+    setPosition(command.value);
+    break;
+  case WindowCommand::Type::SetCursorMode:
+    setCursorMode(command.cursorMode);
+    break;
+  case WindowCommand::Type::Close:
+    close();
+    break;
+  case WindowCommand::Type::ResizeFramebuffer:
+    // The render thread reads the size and the renderer's resize flag while
+    // drawing, so they are changed between its frames
+    runOnRenderThread([this, size = command.value] {
+      resizeFramebuffer(size.x, size.y);
+    });
+    break;
   }
 }
 
@@ -259,20 +464,23 @@ void Window::poll() { glfwPollEvents(); }
 void Window::waitEvents() { glfwWaitEvents(); }
 
 void Window::windowRefreshCallback(GLFWwindow *window) {
-  PLOGV_IF(LOG_WINDOW_REFRESH) << "Window refresh...";
+  SGENG_TRACE(Window) << "Window refresh...";
   auto ctx = reinterpret_cast<Context *>(glfwGetWindowUserPointer(window));
   assert(ctx);
   if (ctx->currentWindow) {
-    int width{0}, height{0};
-    glfwGetFramebufferSize(window, &width, &height);
+    glm::ivec2 size{0, 0};
+    glfwGetFramebufferSize(window, &size.x, &size.y);
 
-    if (width == 0 || height == 0)
+    if (size.x == 0 || size.y == 0)
       return;
 
-    if (width != ctx->currentWindow->getWidth() ||
-        height != ctx->currentWindow->getHeight()) {
-      assert(ctx->app);
-      ctx->currentWindow->resize(width, height);
+    // Compared with the last size seen on this thread, the size of the
+    // window itself belongs to the game thread
+    Window &currentWindow = *ctx->currentWindow;
+    if (size != currentWindow.eventThreadFramebufferSize) {
+      currentWindow.eventThreadFramebufferSize = size;
+      currentWindow.postCommand(
+          {.type = WindowCommand::Type::ResizeFramebuffer, .value = size});
     }
   }
 }
@@ -288,7 +496,13 @@ IRenderer *Window::getRenderer() { return renderer.get(); }
 void Window::createRenderer() {
   makeContextCurrent();
   if (!ctx.get().isGLInitialized)
-    ctx.get().initializeGL();
+    ctx.get().initializeGL(isHeadless() ? headlessContext->getLoader()
+                                        : glfwGetProcAddress);
+  // Occlusion culling samples the depth of the previous frame, which is only
+  // possible when rendering into a framebuffer with a depth texture
+  if (isHeadless() || (ctx.get().cfg.occlusionCulling &&
+                       ctx.get().cfg.renderingMode == RenderingMode::Indirect))
+    offscreenFramebuffer.initialize(width, height);
   renderer = std::make_unique<Renderer>(ctx, *this);
 }
 
@@ -27,18 +27,46 @@
 
 #include "Color.h"
 #include "Context.h"
+#include "FBO.h"
+#include "HeadlessContext.h"
 #include "IRenderer.h"
+#include "MPSCQueue.h"
 #include "constants.h"
 #include <GLFW/glfw3.h>
+#include <cstdint>
 #include <exception>
+#include <functional>
 #include <glm/vec2.hpp>
+#include <memory>
 #include <string>
 
 namespace SGEng {
 
 struct Config;
+class FrameSnapshot;
+class RenderThread;
 struct Scene;
 
+// Window operation handed over to the thread owning it. The GLFW window
+// (title, size, position, cursor and closing) is owned by the thread
+// processing events, the framebuffer size and everything derived from it by
+// the game thread, which forwards it to the render thread when there is one.
+struct WindowCommand {
+  enum class Type : uint8_t {
+    SetTitle,
+    SetSize,
+    SetPosition,
+    SetCursorMode,
+    Close,
+    ResizeFramebuffer
+  };
+
+  Type type{Type::Close};
+  std::string title{};
+  glm::ivec2 value{}; // Size or position
+  int cursorMode{GLFW_CURSOR_NORMAL};
+};
+
 class Window {
 public:
   Window(Context &ctx);
@@ -51,7 +79,10 @@ public:
   Window &withConfig(const Config &config);
   void initialize();
   void makeContextCurrent();
+  // Detaches the context from the calling thread
+  void releaseContext();
   bool isInitialized() const;
+  bool isHeadless() const;
 
   // Getters, Setters
   const GLFWwindow *getRawWindow() const;
@@ -65,11 +96,12 @@ public:
   void resize(int width, int height);
   const std::string &getTitle() const;
   void setTitle(const std::string &title);
-  void setNeedsToChangeTitle(const std::string &title);
   Color getBackgroundColor() const;
   void setBackgroundColor(Color color);
   glm::ivec2 getPosition() const;
   void setPosition(glm::ivec2 position);
+  const FBO &getOffscreenFramebuffer() const;
+  void resizeOffscreenFramebuffer();
 
   bool isActive() const;
   bool shouldClose() const;
@@ -78,13 +110,41 @@ public:
   void swapBuffers() const;
   void clearScreen() const;
   void draw(const Scene &scene) const;
-  void update();
+
+  // Thread-safe requests, queued for the thread owning the operation. Without
+  // separate threads (headless mode) they are applied immediately.
+  void postCommand(WindowCommand command);
+  void requestTitle(std::string title);
+  void requestSize(int width, int height);
+  void requestPosition(glm::ivec2 position);
+  void requestCursorMode(int mode);
+  void requestClose();
+  // Apply the queued commands, each on the thread owning them
+  void processEventThreadCommands();
+  void processGameThreadCommands();
+
+  // Pipelined rendering, the context moves from the calling thread to the
+  // render thread until it is stopped
+  void startRenderThread(unsigned int framesInFlight);
+  void stopRenderThread();
+  RenderThread *getRenderThread();
+  // Runs the task on the thread owning the context, which is the calling one
+  // when there is no render thread
+  void runOnRenderThread(std::function<void()> task);
+  // Renders a snapshot captured by the renderer, called by the render thread
+  void renderFrame(const Scene &scene, const FrameSnapshot &snapshot) const;
 
   static void poll();
   static void waitEvents();
   static void windowRefreshCallback(GLFWwindow *window);
 
 private:
+  void beginFrame() const;
+  void endFrame() const;
+  void resizeFramebuffer(int width, int height);
+  void setCursorMode(int mode);
+  void applyCommand(const WindowCommand &command);
+
   std::reference_wrapper<Context> ctx;
   std::unique_ptr<IRenderer> renderer;
   bool _isInitialized{false};
@@ -94,9 +154,19 @@ private:
   std::string title;
   Color backgroundColor{defaultBackgroundColor};
 
-  // Thread safety related members
-  bool needsToChangeTitle{false};
-  std::string newTitle;
+  // Headless mode state, there is no GLFW window and rendering goes to the
+  // offscreen framebuffer
+  std::unique_ptr<HeadlessContext> headlessContext;
+  FBO offscreenFramebuffer;
+  bool headlessShouldClose{false};
+
+  std::unique_ptr<RenderThread> renderThread;
+
+  // Cross-thread commands, see WindowCommand
+  MPSCQueue<WindowCommand, 64> eventThreadCommands;
+  MPSCQueue<WindowCommand, 64> gameThreadCommands;
+  // Last framebuffer size seen by the thread processing events
+  glm::ivec2 eventThreadFramebufferSize{};
 };
 
 } // namespace SGEng
\ No newline at end of file
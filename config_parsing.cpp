@@ -69,6 +69,64 @@ Config parseConfig(const toml::table &tbl) {
       fs::exists(fs::path(rawResourcesDirectory.value())))
     resourcesDirectory = fs::path(rawResourcesDirectory.value());
 
+  // Load rendering mode (assume default if error)
+  RenderingMode renderingMode = RenderingMode::Direct;
+  toml::optional<std::string> rawRenderingMode =
+      tbl["renderer"]["mode"].value<std::string>();
+  if (rawRenderingMode.has_value()) {
+    if (rawRenderingMode.value() == "direct")
+      renderingMode = RenderingMode::Direct;
+    else if (rawRenderingMode.value() == "instanced")
+      renderingMode = RenderingMode::Instanced;
+    else if (rawRenderingMode.value() == "indirect")
+      renderingMode = RenderingMode::Indirect;
+    else
+      PLOGW << "Invalid renderer mode specified in config, assuming default";
+  }
+
+  // Load frame pacing mode (assume default if error)
+  FramePacingMode framePacingMode = FramePacingMode::VSync;
+  toml::optional<std::string> rawFramePacingMode =
+      tbl["framePacing"]["mode"].value<std::string>();
+  if (rawFramePacingMode.has_value()) {
+    if (rawFramePacingMode.value() == "unlimited")
+      framePacingMode = FramePacingMode::Unlimited;
+    else if (rawFramePacingMode.value() == "vsync")
+      framePacingMode = FramePacingMode::VSync;
+    else if (rawFramePacingMode.value() == "adaptive_vsync")
+      framePacingMode = FramePacingMode::AdaptiveVSync;
+    else if (rawFramePacingMode.value() == "fixed")
+      framePacingMode = FramePacingMode::FixedFPS;
+    else
+      PLOGW << "Invalid frame pacing mode specified in config, assuming "
+               "default";
+  }
+
+  // Load headless backend (assume default if error)
+  HeadlessBackend headlessBackend = HeadlessBackend::EGL;
+  toml::optional<std::string> rawHeadlessBackend =
+      tbl["headless"]["backend"].value<std::string>();
+  if (rawHeadlessBackend.has_value()) {
+    if (rawHeadlessBackend.value() == "egl")
+      headlessBackend = HeadlessBackend::EGL;
+    else if (rawHeadlessBackend.value() == "hidden_window")
+      headlessBackend = HeadlessBackend::HiddenWindow;
+    else
+      PLOGW << "Invalid headless backend specified in config, assuming "
+               "default";
+  }
+
+  std::vector<std::string> traceCategories;
+  if (const toml::array *rawTraceCategories =
+          tbl["trace"]["categories"].as_array()) {
+    for (const auto &rawCategory : *rawTraceCategories) {
+      if (auto category = rawCategory.value<std::string>())
+        traceCategories.push_back(*category);
+      else
+        PLOGW << "Invalid trace category specified in config, ignoring it";
+    }
+  }
+
   return Config()
       .withWindowWidth(tbl["window"]["width"].value_or(defaultWindowWidth))
       .withWindowHeight(tbl["window"]["height"].value_or(defaultWindowHeight))
@@ -80,7 +138,57 @@ Config parseConfig(const toml::table &tbl) {
       .withShowFPS(tbl["showFPS"].value_or(false))
       .withStartWindowMaximized(
           tbl["window"]["startMaximized"].value_or(defaultStartWindowMaximized))
-      .withResourcesDirectory(resourcesDirectory);
+      .withResourcesDirectory(resourcesDirectory)
+      .withRenderingMode(renderingMode)
+      .withOcclusionCulling(
+          tbl["renderer"]["occlusionCulling"].value_or(false))
+      .withPipelinedRendering(tbl["renderer"]["pipelined"].value_or(false))
+      .withFramesInFlight(tbl["renderer"]["framesInFlight"].value_or(
+          defaultFramesInFlight))
+      .withFramePacingMode(framePacingMode)
+      .withTargetFPS(tbl["framePacing"]["targetFPS"].value_or(defaultTargetFPS))
+      .withFixedTimestep(tbl["simulation"]["fixedTimestep"].value_or(false))
+      .withFixedUpdateRate(tbl["simulation"]["fixedUpdateRate"].value_or(
+          defaultFixedUpdateRate))
+      .withMaxFixedUpdatesPerFrame(
+          tbl["simulation"]["maxFixedUpdatesPerFrame"].value_or(
+              defaultMaxFixedUpdatesPerFrame))
+      .withJobWorkerCount(tbl["jobs"]["workerCount"].value_or(0u))
+      .withUploadBytesPerFrame(tbl["loading"]["uploadBytesPerFrame"].value_or(
+          defaultUploadBytesPerFrame))
+      .withWeldVertices(tbl["meshOptimization"]["weldVertices"].value_or(true))
+      .withWeldEpsilon(static_cast<float>(
+          tbl["meshOptimization"]["weldEpsilon"].value_or(
+              static_cast<double>(defaultWeldEpsilon))))
+      .withOptimizeVertexCache(
+          tbl["meshOptimization"]["vertexCache"].value_or(true))
+      .withOptimizeOverdraw(tbl["meshOptimization"]["overdraw"].value_or(true))
+      .withOptimizeVertexFetch(
+          tbl["meshOptimization"]["vertexFetch"].value_or(true))
+      .withPackVertices(tbl["meshOptimization"]["packVertices"].value_or(true))
+      .withFrameStatsWindow(tbl["stats"]["windowFrames"].value_or(
+          defaultFrameStatsWindow))
+      .withFrameStatsPath(tbl["stats"]["summaryPath"].value_or<std::string>(
+          defaultFrameStatsPath.string()))
+      .withProfilerEnabled(tbl["profiler"]["enabled"].value_or(false))
+      .withProfilerTraceSeconds(tbl["profiler"]["traceSeconds"].value_or(
+          defaultProfilerTraceSeconds))
+      .withProfilerTracePath(
+          tbl["profiler"]["tracePath"].value_or<std::string>(
+              defaultProfilerTracePath.string()))
+      .withTraceCategories(traceCategories)
+      .withTracePath(tbl["trace"]["path"].value_or<std::string>(
+          defaultTracePath.string()))
+      .withTraceTextPath(tbl["trace"]["textPath"].value_or<std::string>(""))
+      .withHeadless(tbl["headless"]["enabled"].value_or(false))
+      .withHeadlessBackend(headlessBackend)
+      .withHeadlessFrameCount(tbl["headless"]["frames"].value_or(
+          defaultHeadlessFrameCount))
+      .withHeadlessReadbackHash(
+          tbl["headless"]["readbackHash"].value_or(false))
+      .withHeadlessReportPath(
+          tbl["headless"]["reportPath"].value_or<std::string>(
+              defaultHeadlessReportPath.string()));
 }
 
 } // namespace SGEng
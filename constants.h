@@ -31,7 +31,9 @@
 #pragma once
 
 #include "Color.h"
+#include <cstddef>
 #include <filesystem>
+#include <glad/gl.h>
 #include <glm/vec4.hpp>
 #include <plog/Severity.h>
 #include <string_view>
@@ -48,13 +50,28 @@ const fs::path defaultBasicVertexShaderPath =
     defaultShaderDirectory / "basic" / "basic.vert";
 const fs::path defaultBasicFragmentShaderPath =
     defaultShaderDirectory / "basic" / "basic.frag";
+const fs::path defaultInstancedVertexShaderPath =
+    defaultShaderDirectory / "basic" / "instanced.vert";
+const fs::path defaultDepthPyramidShaderPath =
+    defaultShaderDirectory / "culling" / "hiz_downsample.comp";
+const fs::path defaultOcclusionCullShaderPath =
+    defaultShaderDirectory / "culling" / "occlusion_cull.comp";
 const fs::path defaultLogPath = fs::path("log.txt");
 const fs::path defaultResourcesDirectory = fs::path("resources/");
 
 constexpr int OPENGL_MAJOR = 4;
 constexpr int OPENGL_MINOR = 6;
 
-constexpr bool DISABLE_SWAP_INTERVAL{true};
+constexpr GLuint instanceDataBindingIndex{0};
+constexpr GLuint frameDataBindingIndex{0};
+constexpr GLuint occlusionInputCommandsBindingIndex{1};
+constexpr GLuint occlusionOutputCommandsBindingIndex{2};
+constexpr GLuint occlusionBoundsBindingIndex{3};
+constexpr GLuint occlusionStatisticsBindingIndex{4};
+// Uniforms with the position quantization of packed meshes, must match
+// position_scale and position_offset in shaders/basic/basic.vert
+constexpr GLint positionScaleLocation{0};
+constexpr GLint positionOffsetLocation{1};
 
 #ifdef _DEBUG
 constexpr plog::Severity defaultLogLevel = plog::debug;
@@ -70,23 +87,23 @@ constexpr int defaultMinWindowWidth{640};
 constexpr int defaultMinWindowHeight{480};
 constexpr Color defaultBackgroundColor(Color::MaterialDark::Background);
 constexpr bool defaultStartWindowMaximized{false};
-
-constexpr bool LOG_FILE_OPERATIONS{false};
-constexpr bool LOG_DRAW{false};
-constexpr bool LOG_KEY_PRESS{false};
-constexpr bool LOG_WINDOW_REFRESH{false};
-constexpr bool LOG_WINDOW_RESIZE{false};
-constexpr bool LOG_WINDOW_TITLE_CHANGE{false};
-constexpr bool LOG_WINDOW_BACKGROUND_COLOR_CHANGE{false};
-constexpr bool LOG_CONSTRUCTORS{false};
-constexpr bool LOG_ASSIGNMENTS{false};
-constexpr bool LOG_DESTRUCTORS{false};
-constexpr bool LOG_BUFFER_LINKING{false};
-constexpr bool LOG_BUFFERS{false};
-constexpr bool LOG_VAO{false};
-constexpr bool LOG_SHADERS{false};
-constexpr bool LOG_SHADERS_RELOAD{true};
-constexpr bool LOG_FPS{true};
+constexpr unsigned int defaultTargetFPS{60};
+constexpr unsigned int defaultFixedUpdateRate{60};
+constexpr unsigned int defaultMaxFixedUpdatesPerFrame{5};
+constexpr unsigned int defaultFramesInFlight{2};
+constexpr unsigned int maxFramesInFlight{3};
+constexpr unsigned int defaultHeadlessFrameCount{600};
+const fs::path defaultHeadlessReportPath = fs::path("frame_timings.csv");
+constexpr unsigned int defaultFrameStatsWindow{600};
+const fs::path defaultFrameStatsPath = fs::path("frame_stats.json");
+constexpr double defaultProfilerTraceSeconds{5.0};
+const fs::path defaultProfilerTracePath = fs::path("trace.json");
+const fs::path defaultTracePath = fs::path("trace.sgtrace");
+constexpr unsigned int defaultUploadBytesPerFrame{4 * 1024 * 1024};
+// Post-transform cache size optimized for and simulated by the statistics
+constexpr size_t defaultVertexCacheSize{16};
+constexpr float defaultOverdrawThreshold{1.05f};
+constexpr float defaultWeldEpsilon{1e-6f};
 
 static_assert((OPENGL_MAJOR > 4) ||
                   (OPENGL_MAJOR == 4 &&
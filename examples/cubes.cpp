@@ -144,6 +144,8 @@ Mesh SGEng::generateCube(vec3gl center, vec3gl scale, float rotationAngle,
       20, 21, 22, 22, 23, 20, // NOLINT(cppcoreguidelines-avoid-*)
   };
 
+  mesh.compactIndices();
+  mesh.computeBounds();
   return mesh;
 }
 
@@ -209,6 +211,8 @@ Mesh generateOptimizedCube(vec3gl center, vec3gl scale, float rotationAngle,
       0, 2, 1, 3, 2, 0  // NOLINT(cppcoreguidelines-avoid-*)
   };
 
+  mesh.compactIndices();
+  mesh.computeBounds();
   return mesh;
 }
 
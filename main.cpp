@@ -34,16 +34,25 @@
 #include <plog/Log.h>
 
 int main() {
-  SGEng::Context ctx;
+  // GLFW is set up after loading the config, which decides whether a display
+  // is needed at all
+  SGEng::Context ctx(false);
   /*ctx.logger.setLogLevel(plog::verbose);*/
   ctx.loadConfig();
 
   try {
+    ctx.setup();
     auto app = std::make_unique<SGEng::SGEngApp>(ctx);
     app->run();
+  } catch (const SGEng::GLFWInitializationError &err) {
+    PLOGE << err.what();
+    return 0;
   } catch (const SGEng::GLInitializationError &err) {
     PLOGE << err.what();
     return 0;
+  } catch (const SGEng::WindowInitializationError &err) {
+    PLOGE << err.what();
+    return 0;
   }
 
   return 0;
@@ -0,0 +1,300 @@
+//===- mesh_cooking.cpp -----------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "mesh_cooking.h"
+
+#include "MappedFile.h"
+#include "Mesh.h"
+#include "Model.h"
+#include "Profiler.h"
+#include "exceptions.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <functional>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace SGEng {
+
+namespace {
+
+// File layout, in native byte order: the header, a table of meshCount
+// CookedMesh entries, and the vertex and index blobs the table points to,
+// each aligned to blobAlignment bytes
+constexpr std::array<char, 8> cookedMeshMagic{'S', 'G', 'M', 'E',
+                                              'S', 'H', '\0', '\0'};
+constexpr uint64_t blobAlignment{16};
+
+struct CookedHeader {
+  std::array<char, 8> magic;
+  uint32_t version;
+  uint32_t meshCount;
+  uint32_t vertexSize;
+  uint32_t optimizationFlags;
+  uint64_t sourceSize;
+  int64_t sourceWriteTime;
+  float weldEpsilon;
+  uint32_t packedVertexSize;
+};
+
+struct CookedMesh {
+  uint64_t vertexOffset;
+  uint64_t vertexCount;
+  uint64_t indexOffset;
+  uint64_t indexCount;
+  std::array<float, 3> aabbMin;
+  std::array<float, 3> aabbMax;
+  std::array<float, 3> sphereCenter;
+  float sphereRadius;
+  uint32_t enableFaceCulling;
+  uint32_t indexSize; // Of GLushort or GLuint
+  uint32_t vertexFormat;
+  std::array<float, 3> positionScale;
+  std::array<float, 3> positionOffset;
+  uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable_v<CookedHeader> &&
+              std::is_trivially_copyable_v<CookedMesh> &&
+              std::is_trivially_copyable_v<Vertex> &&
+              std::is_trivially_copyable_v<PackedVertex>);
+
+uint64_t alignBlob(uint64_t offset) {
+  return (offset + blobAlignment - 1) / blobAlignment * blobAlignment;
+}
+
+// Size and modification time of the source file, both zero without one
+std::pair<uint64_t, int64_t> getSourceStamp(const fs::path &sourcePath) {
+  std::error_code error;
+  if (sourcePath.empty())
+    return {0, 0};
+  uint64_t size = fs::file_size(sourcePath, error);
+  if (error)
+    return {0, 0};
+  auto writeTime = fs::last_write_time(sourcePath, error);
+  if (error)
+    return {0, 0};
+  return {size, static_cast<int64_t>(writeTime.time_since_epoch().count())};
+}
+
+std::array<float, 3> toArray(const vec3gl &vector) {
+  return {vector.x, vector.y, vector.z};
+}
+
+vec3gl toVector(const std::array<float, 3> &array) {
+  return {array[0], array[1], array[2]};
+}
+
+// Whether count elements of the given size fit into the file at the offset
+bool isBlobInside(uint64_t offset, uint64_t count, uint64_t size,
+                  uint64_t fileSize) {
+  return offset % blobAlignment == 0 && offset <= fileSize &&
+         count <= (fileSize - offset) / size;
+}
+
+} // namespace
+
+fs::path getCookedModelPath(const fs::path &sourcePath) {
+  fs::path cookedPath = sourcePath;
+  cookedPath += cookedMeshExtension;
+  return cookedPath;
+}
+
+bool isCookedModelCurrent(const fs::path &cookedPath,
+                          const fs::path &sourcePath,
+                          const MeshOptimizationOptions &options) {
+  std::ifstream in(cookedPath, std::ios::binary);
+  CookedHeader header{};
+  if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    return false;
+  auto [sourceSize, sourceWriteTime] = getSourceStamp(sourcePath);
+  return header.magic == cookedMeshMagic &&
+         header.version == cookedMeshVersion &&
+         header.vertexSize == sizeof(Vertex) &&
+         header.packedVertexSize == sizeof(PackedVertex) &&
+         header.sourceSize == sourceSize &&
+         header.sourceWriteTime == sourceWriteTime &&
+         header.optimizationFlags == options.getFlags() &&
+         header.weldEpsilon == options.weldEpsilon;
+}
+
+void cookModel(const Model &model, const fs::path &cookedPath,
+               const fs::path &sourcePath,
+               const MeshOptimizationOptions &options) {
+  ProfileScope profileScope("cookModel");
+  auto [sourceSize, sourceWriteTime] = getSourceStamp(sourcePath);
+  CookedHeader header{.magic = cookedMeshMagic,
+                      .version = cookedMeshVersion,
+                      .meshCount = static_cast<uint32_t>(model.meshes.size()),
+                      .vertexSize = sizeof(Vertex),
+                      .optimizationFlags = options.getFlags(),
+                      .sourceSize = sourceSize,
+                      .sourceWriteTime = sourceWriteTime,
+                      .weldEpsilon = options.weldEpsilon,
+                      .packedVertexSize = sizeof(PackedVertex)};
+
+  std::vector<CookedMesh> table;
+  uint64_t offset = alignBlob(sizeof(CookedHeader) +
+                              model.meshes.size() * sizeof(CookedMesh));
+  for (const auto &mesh : model.meshes) {
+    const Bounds &bounds = mesh->bounds;
+    VertexSpan vertices = mesh->getVertices();
+    IndexSpan indices = mesh->getIndices();
+    uint64_t vertexOffset = offset;
+    uint64_t indexOffset = alignBlob(vertexOffset + vertices.size_bytes());
+    offset = alignBlob(indexOffset + indices.size_bytes());
+    table.push_back(
+        {.vertexOffset = vertexOffset,
+         .vertexCount = vertices.size(),
+         .indexOffset = indexOffset,
+         .indexCount = indices.size(),
+         .aabbMin = toArray(bounds.aabb.min),
+         .aabbMax = toArray(bounds.aabb.max),
+         .sphereCenter = toArray(bounds.sphere.center),
+         .sphereRadius = bounds.sphere.radius,
+         .enableFaceCulling = mesh->enableFaceCulling ? 1u : 0u,
+         .indexSize =
+             static_cast<uint32_t>(IndexSpan::getIndexSize(indices.type)),
+         .vertexFormat = static_cast<uint32_t>(vertices.format),
+         .positionScale = toArray(vertices.quantization.scale),
+         .positionOffset = toArray(vertices.quantization.offset),
+         .reserved = 0});
+  }
+
+  // Written under a temporary name first, so that a cook interrupted half way
+  // does not leave a broken file behind. The name is unique to the thread, as
+  // models may be loaded on several threads at once.
+  fs::path temporaryPath = cookedPath;
+  temporaryPath += "." +
+                   std::to_string(std::hash<std::thread::id>{}(
+                       std::this_thread::get_id())) +
+                   ".tmp";
+  {
+    std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+      throw FileError{"File could not be opened", temporaryPath};
+    auto writeBlob = [&](const void *data, uint64_t size) {
+      out.write(static_cast<const char *>(data),
+                static_cast<std::streamsize>(size));
+    };
+    auto pad = [&] {
+      static constexpr std::array<char, blobAlignment> zeros{};
+      auto position = static_cast<uint64_t>(out.tellp());
+      writeBlob(zeros.data(), alignBlob(position) - position);
+    };
+
+    writeBlob(&header, sizeof(header));
+    writeBlob(table.data(), table.size() * sizeof(CookedMesh));
+    pad();
+    for (const auto &mesh : model.meshes) {
+      writeBlob(mesh->getVertices().data, mesh->getVertices().size_bytes());
+      pad();
+      writeBlob(mesh->getIndices().data, mesh->getIndices().size_bytes());
+      pad();
+    }
+    if (!out)
+      throw FileError{"File could not be written", temporaryPath};
+  }
+
+  std::error_code error;
+  fs::rename(temporaryPath, cookedPath, error);
+  if (error) {
+    fs::remove(temporaryPath, error);
+    throw FileError{"File could not be renamed", cookedPath};
+  }
+}
+
+Model loadCookedModel(const fs::path &cookedPath) {
+  ProfileScope profileScope("loadCookedModel");
+  auto file = std::make_shared<const MappedFile>(cookedPath);
+  std::span<const std::byte> data = file->getData();
+
+  CookedHeader header{};
+  if (data.size() < sizeof(header))
+    throw ModelLoadingError("Could not load cooked model", cookedPath,
+                            "File is truncated");
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.magic != cookedMeshMagic)
+    throw ModelLoadingError("Could not load cooked model", cookedPath,
+                            "File is not a cooked mesh");
+  if (header.version != cookedMeshVersion ||
+      header.vertexSize != sizeof(Vertex) ||
+      header.packedVertexSize != sizeof(PackedVertex))
+    throw ModelLoadingError("Could not load cooked model", cookedPath,
+                            "File was cooked by another version");
+  if ((data.size() - sizeof(header)) / sizeof(CookedMesh) < header.meshCount)
+    throw ModelLoadingError("Could not load cooked model", cookedPath,
+                            "File is truncated");
+
+  Model model;
+  for (uint32_t i = 0; i < header.meshCount; i++) {
+    CookedMesh entry{};
+    std::memcpy(&entry,
+                data.data() + sizeof(header) + i * sizeof(CookedMesh),
+                sizeof(entry));
+    if (entry.indexSize != sizeof(GLushort) &&
+        entry.indexSize != sizeof(GLuint))
+      throw ModelLoadingError("Could not load cooked model", cookedPath,
+                              "Index size is invalid");
+    if (entry.vertexFormat != static_cast<uint32_t>(VertexFormat::Float) &&
+        entry.vertexFormat != static_cast<uint32_t>(VertexFormat::Packed))
+      throw ModelLoadingError("Could not load cooked model", cookedPath,
+                              "Vertex format is invalid");
+    auto vertexFormat = static_cast<VertexFormat>(entry.vertexFormat);
+    if (!isBlobInside(entry.vertexOffset, entry.vertexCount,
+                      VertexSpan::getVertexSize(vertexFormat), data.size()) ||
+        !isBlobInside(entry.indexOffset, entry.indexCount, entry.indexSize,
+                      data.size()))
+      throw ModelLoadingError("Could not load cooked model", cookedPath,
+                              "Mesh data is out of bounds");
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh->mappedFile = file;
+    mesh->mappedVertices =
+        VertexSpan(vertexFormat, data.data() + entry.vertexOffset,
+                   entry.vertexCount,
+                   {.scale = toVector(entry.positionScale),
+                    .offset = toVector(entry.positionOffset)});
+    mesh->mappedIndices = IndexSpan(entry.indexSize == sizeof(GLushort)
+                                        ? GL_UNSIGNED_SHORT
+                                        : GL_UNSIGNED_INT,
+                                    data.data() + entry.indexOffset,
+                                    entry.indexCount);
+    mesh->bounds = {.aabb = {.min = toVector(entry.aabbMin),
+                             .max = toVector(entry.aabbMax)},
+                    .sphere = {.center = toVector(entry.sphereCenter),
+                               .radius = entry.sphereRadius}};
+    mesh->enableFaceCulling = entry.enableFaceCulling != 0;
+    model.meshes.push_back(std::move(mesh));
+  }
+  return model;
+}
+
+} // namespace SGEng
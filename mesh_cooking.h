@@ -0,0 +1,66 @@
+//===- mesh_cooking.h -------------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "mesh_optimization.h"
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+namespace SGEng {
+
+namespace fs = std::filesystem;
+
+struct Model;
+
+// Cooked meshes are stored in a binary .sgmesh file laid out the way they are
+// uploaded, so that loading maps the file and uploads straight from the
+// mapping instead of running the importer. Vertices and indices keep the
+// format and width they were cooked with. Files of another version, or cooked
+// for another vertex layout or with other mesh optimization options, are
+// rejected and cooked again.
+constexpr uint32_t cookedMeshVersion{4};
+constexpr std::string_view cookedMeshExtension{".sgmesh"};
+
+// Cooked file kept next to a source model, e.g. teapot.obj.sgmesh
+fs::path getCookedModelPath(const fs::path &sourcePath);
+// Whether the cooked file exists, has the current version and was cooked from
+// the source file as it is now, with the given optimization options
+bool isCookedModelCurrent(const fs::path &cookedPath,
+                          const fs::path &sourcePath,
+                          const MeshOptimizationOptions &options = {});
+// Writes the meshes of the model, recording the size and modification time of
+// the source file when given, and the optimization options the meshes were
+// processed with. Throws FileError.
+void cookModel(const Model &model, const fs::path &cookedPath,
+               const fs::path &sourcePath = {},
+               const MeshOptimizationOptions &options = {});
+// Maps the cooked file and returns a model with meshes referring to the
+// mapping, which stays mapped as long as any of them exists. Throws FileError
+// and ModelLoadingError.
+Model loadCookedModel(const fs::path &cookedPath);
+
+} // namespace SGEng
@@ -0,0 +1,431 @@
+//===- mesh_optimization.cpp ------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "mesh_optimization.h"
+
+#include "Mesh.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <unordered_map>
+
+namespace SGEng {
+
+namespace {
+
+constexpr uint32_t vertexCacheFlag{1u << 0};
+constexpr uint32_t overdrawFlag{1u << 1};
+constexpr uint32_t vertexFetchFlag{1u << 2};
+constexpr uint32_t weldVerticesFlag{1u << 3};
+constexpr uint32_t packVerticesFlag{1u << 4};
+
+// Position and normal snapped to the welding grid
+struct WeldKey {
+  std::array<int64_t, 6> coordinates;
+
+  bool operator==(const WeldKey &key) const = default;
+};
+
+struct WeldKeyHash {
+  size_t operator()(const WeldKey &key) const {
+    size_t hash{0};
+    for (int64_t coordinate : key.coordinates)
+      hash ^= std::hash<int64_t>{}(coordinate) + 0x9e3779b97f4a7c15ULL +
+              (hash << 6) + (hash >> 2);
+    return hash;
+  }
+};
+
+// FIFO post-transform cache, a vertex is cached while fewer than cacheSize
+// vertices were transformed after it
+class VertexCacheSimulation {
+public:
+  VertexCacheSimulation(size_t vertexCount, size_t cacheSize)
+      : cacheTimes(vertexCount, 0), cacheSize{cacheSize},
+        time{cacheSize + 1} {}
+
+  // Returns whether the vertex had to be transformed
+  bool access(GLuint vertex) {
+    if (time - cacheTimes[vertex] <= cacheSize)
+      return false;
+    cacheTimes[vertex] = time++;
+    return true;
+  }
+
+  void flush() { time += cacheSize + 1; }
+
+private:
+  std::vector<size_t> cacheTimes;
+  size_t cacheSize;
+  size_t time;
+};
+
+// Triangles using each vertex, in compressed rows
+struct VertexAdjacency {
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> triangles;
+
+  VertexAdjacency(std::span<const GLuint> indices, size_t vertexCount)
+      : offsets(vertexCount + 1, 0), triangles(indices.size()) {
+    for (GLuint index : indices)
+      offsets[index + 1]++;
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    std::vector<uint32_t> filled(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++)
+      triangles[filled[indices[i]]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  std::span<const uint32_t> of(GLuint vertex) const {
+    return std::span(triangles).subspan(offsets[vertex],
+                                        offsets[vertex + 1] - offsets[vertex]);
+  }
+
+  uint32_t countOf(GLuint vertex) const {
+    return offsets[vertex + 1] - offsets[vertex];
+  }
+};
+
+bool isTriangleList(std::span<const GLuint> indices, size_t vertexCount) {
+  return indices.size() % 3 == 0 &&
+         std::all_of(indices.begin(), indices.end(),
+                     [&](GLuint index) { return index < vertexCount; });
+}
+
+} // namespace
+
+uint32_t MeshOptimizationOptions::getFlags() const {
+  return (vertexCache ? vertexCacheFlag : 0) | (overdraw ? overdrawFlag : 0) |
+         (vertexFetch ? vertexFetchFlag : 0) |
+         (weldVertices ? weldVerticesFlag : 0) |
+         (packVertices ? packVerticesFlag : 0);
+}
+
+double VertexCacheStatistics::getACMR() const {
+  return triangleCount > 0 ? static_cast<double>(transformedVertexCount) /
+                                 static_cast<double>(triangleCount)
+                           : 0.0;
+}
+
+double VertexCacheStatistics::getATVR() const {
+  return vertexCount > 0 ? static_cast<double>(transformedVertexCount) /
+                               static_cast<double>(vertexCount)
+                         : 0.0;
+}
+
+VertexCacheStatistics &
+VertexCacheStatistics::operator+=(const VertexCacheStatistics &statistics) {
+  transformedVertexCount += statistics.transformedVertexCount;
+  triangleCount += statistics.triangleCount;
+  vertexCount += statistics.vertexCount;
+  return *this;
+}
+
+MeshOptimizationStatistics &
+MeshOptimizationStatistics::operator+=(
+    const MeshOptimizationStatistics &statistics) {
+  before += statistics.before;
+  after += statistics.after;
+  return *this;
+}
+
+// Coordinates are rounded to multiples of the epsilon, so vertices closer than
+// it on either side of a rounding boundary stay apart. A zero epsilon only
+// merges bitwise equal vertices.
+void weldVertices(std::vector<Vertex> &vertices, std::span<GLuint> indices,
+                  float epsilon) {
+  ProfileScope profileScope("weldVertices");
+  auto snap = [epsilon](float coordinate) -> int64_t {
+    if (epsilon > 0.f)
+      return std::llround(static_cast<double>(coordinate) / epsilon);
+    uint32_t bits{0};
+    coordinate += 0.f; // -0 to +0
+    std::memcpy(&bits, &coordinate, sizeof(bits));
+    return bits;
+  };
+
+  std::unordered_map<WeldKey, GLuint, WeldKeyHash> weldedIndices;
+  weldedIndices.reserve(vertices.size());
+  std::vector<GLuint> remap(vertices.size());
+  std::vector<Vertex> welded;
+  welded.reserve(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    const Vertex &vertex = vertices[i];
+    WeldKey key{{snap(vertex.position.x), snap(vertex.position.y),
+                 snap(vertex.position.z), snap(vertex.normal.x),
+                 snap(vertex.normal.y), snap(vertex.normal.z)}};
+    auto [it, isInserted] =
+        weldedIndices.try_emplace(key, static_cast<GLuint>(welded.size()));
+    if (isInserted)
+      welded.push_back(vertex);
+    remap[i] = it->second;
+  }
+  for (GLuint &index : indices)
+    index = remap[index];
+  vertices = std::move(welded);
+}
+
+VertexCacheStatistics analyzeVertexCache(std::span<const GLuint> indices,
+                                         size_t vertexCount,
+                                         size_t cacheSize) {
+  VertexCacheStatistics statistics{.triangleCount = indices.size() / 3};
+  VertexCacheSimulation cache(vertexCount, cacheSize);
+  std::vector<bool> isReferenced(vertexCount, false);
+  for (GLuint index : indices) {
+    if (cache.access(index))
+      statistics.transformedVertexCount++;
+    if (!isReferenced[index]) {
+      isReferenced[index] = true;
+      statistics.vertexCount++;
+    }
+  }
+  return statistics;
+}
+
+// Tipsify fans around one vertex at a time, emitting all of its remaining
+// triangles, then moves to the vertex emitted by these triangles that will
+// still be in the cache after its own triangles are emitted, and was there
+// the longest. Without such a vertex it falls back to the most recently
+// emitted vertex with triangles left, then to the next one in index order.
+void optimizeVertexCache(std::span<GLuint> indices, size_t vertexCount,
+                         size_t cacheSize) {
+  ProfileScope profileScope("optimizeVertexCache");
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+    return;
+
+  VertexAdjacency adjacency(indices, vertexCount);
+  std::vector<uint32_t> liveTriangles(vertexCount);
+  for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+    liveTriangles[vertex] = adjacency.countOf(vertex);
+  std::vector<size_t> cacheTimes(vertexCount, 0);
+  size_t time = cacheSize + 1;
+  std::vector<bool> isEmitted(triangleCount, false);
+  std::vector<GLuint> deadEnds;
+  std::vector<GLuint> candidates;
+  std::vector<GLuint> output;
+  output.reserve(indices.size());
+  GLuint cursor = 0;
+
+  auto skipDeadEnd = [&]() -> std::optional<GLuint> {
+    while (!deadEnds.empty()) {
+      GLuint vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveTriangles[vertex] > 0)
+        return vertex;
+    }
+    for (; cursor < vertexCount; cursor++)
+      if (liveTriangles[cursor] > 0)
+        return cursor;
+    return std::nullopt;
+  };
+
+  auto nextVertex = [&]() -> std::optional<GLuint> {
+    std::optional<GLuint> best;
+    size_t bestPriority{0};
+    for (GLuint vertex : candidates) {
+      if (liveTriangles[vertex] == 0)
+        continue;
+      size_t priority{0};
+      if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+        priority = time - cacheTimes[vertex];
+      if (!best || priority > bestPriority) {
+        best = vertex;
+        bestPriority = priority;
+      }
+    }
+    return best ? best : skipDeadEnd();
+  };
+
+  std::optional<GLuint> fanningVertex = skipDeadEnd();
+  while (fanningVertex) {
+    candidates.clear();
+    for (uint32_t triangle : adjacency.of(*fanningVertex)) {
+      if (isEmitted[triangle])
+        continue;
+      isEmitted[triangle] = true;
+      for (size_t corner = 0; corner < 3; corner++) {
+        GLuint vertex = indices[3 * triangle + corner];
+        output.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        liveTriangles[vertex]--;
+        if (time - cacheTimes[vertex] > cacheSize)
+          cacheTimes[vertex] = time++;
+      }
+    }
+    fanningVertex = nextVertex();
+  }
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+// Triangles are split into clusters at the points where the order jumps to
+// another part of the mesh, which the cache cannot hide, and further where
+// the cluster so far is about as cache efficient as the whole mesh. Clusters
+// are then sorted by how far out they face from the center of the mesh, as
+// those usually occlude the others (Sander et al. 2007).
+void optimizeOverdraw(std::span<GLuint> indices,
+                      std::span<const Vertex> vertices, float threshold,
+                      size_t cacheSize) {
+  ProfileScope profileScope("optimizeOverdraw");
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+    return;
+
+  std::vector<size_t> hardBoundaries;
+  VertexCacheSimulation cache(vertices.size(), cacheSize);
+  for (size_t triangle = 0; triangle < triangleCount; triangle++) {
+    size_t misses{0};
+    for (size_t corner = 0; corner < 3; corner++)
+      misses += cache.access(indices[3 * triangle + corner]) ? 1 : 0;
+    if (triangle == 0 || misses == 3)
+      hardBoundaries.push_back(triangle);
+  }
+  hardBoundaries.push_back(triangleCount);
+
+  double meshACMR = analyzeVertexCache(indices, vertices.size(), cacheSize)
+                        .getACMR();
+  std::vector<size_t> clusterStarts;
+  for (size_t i = 0; i + 1 < hardBoundaries.size(); i++) {
+    size_t first = hardBoundaries[i];
+    size_t last = hardBoundaries[i + 1];
+    cache.flush();
+    size_t clusterStart = first;
+    size_t misses{0};
+    clusterStarts.push_back(first);
+    for (size_t triangle = first; triangle + 1 < last; triangle++) {
+      for (size_t corner = 0; corner < 3; corner++)
+        misses += cache.access(indices[3 * triangle + corner]) ? 1 : 0;
+      double clusterACMR = static_cast<double>(misses) /
+                           static_cast<double>(triangle + 1 - clusterStart);
+      if (clusterACMR <= meshACMR * threshold) {
+        clusterStart = triangle + 1;
+        misses = 0;
+        cache.flush();
+        clusterStarts.push_back(clusterStart);
+      }
+    }
+  }
+  clusterStarts.push_back(triangleCount);
+
+  auto getPosition = [&](size_t triangle, size_t corner) {
+    return vertices[indices[3 * triangle + corner]].position;
+  };
+  glm::vec3 meshCentroid{0.f};
+  for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    meshCentroid += getPosition(triangle, 0) + getPosition(triangle, 1) +
+                    getPosition(triangle, 2);
+  meshCentroid /= static_cast<float>(3 * triangleCount);
+
+  struct Cluster {
+    size_t first;
+    size_t last;
+    float sortKey;
+  };
+  std::vector<Cluster> clusters;
+  for (size_t i = 0; i + 1 < clusterStarts.size(); i++) {
+    // Clusters without a facing direction are drawn last
+    Cluster cluster{.first = clusterStarts[i],
+                    .last = clusterStarts[i + 1],
+                    .sortKey = -std::numeric_limits<float>::max()};
+    // Weighted by area, as the cross products are twice the triangle areas
+    glm::vec3 centroid{0.f};
+    glm::vec3 normal{0.f};
+    float area{0.f};
+    for (size_t triangle = cluster.first; triangle < cluster.last;
+         triangle++) {
+      glm::vec3 a = getPosition(triangle, 0);
+      glm::vec3 b = getPosition(triangle, 1);
+      glm::vec3 c = getPosition(triangle, 2);
+      glm::vec3 cross = glm::cross(b - a, c - a);
+      float triangleArea = glm::length(cross);
+      centroid += (a + b + c) * (triangleArea / 3.f);
+      normal += cross;
+      area += triangleArea;
+    }
+    if (area > 0.f && glm::length(normal) > 0.f)
+      cluster.sortKey =
+          glm::dot(centroid / area - meshCentroid, glm::normalize(normal));
+    clusters.push_back(cluster);
+  }
+  std::stable_sort(clusters.begin(), clusters.end(),
+                   [](const Cluster &a, const Cluster &b) {
+                     return a.sortKey > b.sortKey;
+                   });
+
+  std::vector<GLuint> output;
+  output.reserve(indices.size());
+  for (const Cluster &cluster : clusters)
+    output.insert(output.end(), indices.begin() + 3 * cluster.first,
+                  indices.begin() + 3 * cluster.last);
+  std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimizeVertexFetch(std::vector<Vertex> &vertices,
+                         std::span<GLuint> indices) {
+  ProfileScope profileScope("optimizeVertexFetch");
+  constexpr GLuint unused = std::numeric_limits<GLuint>::max();
+  std::vector<GLuint> remap(vertices.size(), unused);
+  std::vector<Vertex> reordered;
+  reordered.reserve(vertices.size());
+  for (GLuint &index : indices) {
+    if (remap[index] == unused) {
+      remap[index] = static_cast<GLuint>(reordered.size());
+      reordered.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+  vertices = std::move(reordered);
+}
+
+MeshOptimizationStatistics
+optimizeMesh(Mesh &mesh, const MeshOptimizationOptions &options) {
+  MeshOptimizationStatistics statistics;
+  if (mesh.mappedFile || mesh.indices.empty() ||
+      !isTriangleList(mesh.indices, mesh.vertices.size()))
+    return statistics;
+
+  statistics.before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+  if (options.weldVertices)
+    weldVertices(mesh.vertices, mesh.indices, options.weldEpsilon);
+  if (options.vertexCache)
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+  if (options.overdraw)
+    optimizeOverdraw(mesh.indices, mesh.vertices);
+  if (options.vertexFetch) {
+    optimizeVertexFetch(mesh.vertices, mesh.indices);
+    mesh.computeBounds();
+  }
+  statistics.after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+  return statistics;
+}
+
+} // namespace SGEng
@@ -0,0 +1,108 @@
+//===- mesh_optimization.h --------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "Vertex.h"
+#include "constants.h"
+#include <cstddef>
+#include <cstdint>
+#include <glad/gl.h>
+#include <span>
+#include <vector>
+
+namespace SGEng {
+
+struct Mesh;
+
+// Passes over the vertices and triangles of indexed triangle meshes, applied
+// in this order. Apart from welding and packing only the order changes, so the
+// rendered image stays the same.
+struct MeshOptimizationOptions {
+  // Merges vertices whose positions and normals are equal within weldEpsilon,
+  // as importers emit separate vertices for every face corner
+  bool weldVertices{true};
+  float weldEpsilon{defaultWeldEpsilon};
+  // Orders triangles to reuse the vertices in the post-transform cache
+  // (Tipsify, Sander et al. 2007)
+  bool vertexCache{true};
+  // Orders clusters of triangles so that those facing outwards are drawn
+  // first and occlude the rest, keeping the cache efficiency within a
+  // factor of overdrawThreshold
+  bool overdraw{true};
+  // Orders vertices by first use, so that vertex fetches are sequential, and
+  // drops unused vertices
+  bool vertexFetch{true};
+  // Stores the vertices as PackedVertex, halving the vertex memory and
+  // bandwidth at the cost of quantized positions and normals. Done by the
+  // model loader after the other passes, see Mesh::packVertices().
+  bool packVertices{true};
+
+  // Identifies the enabled passes, cooked meshes record it together with the
+  // epsilon
+  uint32_t getFlags() const;
+};
+
+// Transformed vertices counted by simulating a FIFO post-transform cache
+struct VertexCacheStatistics {
+  size_t transformedVertexCount{0};
+  size_t triangleCount{0};
+  size_t vertexCount{0}; // Referenced by at least one triangle
+
+  // Average cache miss ratio, transformed vertices per triangle, 0.5 at best
+  // on large regular meshes and 3 at worst
+  double getACMR() const;
+  // Average transform to vertex ratio, 1 at best
+  double getATVR() const;
+  VertexCacheStatistics &operator+=(const VertexCacheStatistics &statistics);
+};
+
+struct MeshOptimizationStatistics {
+  VertexCacheStatistics before;
+  VertexCacheStatistics after;
+
+  MeshOptimizationStatistics &
+  operator+=(const MeshOptimizationStatistics &statistics);
+};
+
+void weldVertices(std::vector<Vertex> &vertices, std::span<GLuint> indices,
+                  float epsilon = defaultWeldEpsilon);
+VertexCacheStatistics
+analyzeVertexCache(std::span<const GLuint> indices, size_t vertexCount,
+                   size_t cacheSize = defaultVertexCacheSize);
+void optimizeVertexCache(std::span<GLuint> indices, size_t vertexCount,
+                         size_t cacheSize = defaultVertexCacheSize);
+void optimizeOverdraw(std::span<GLuint> indices,
+                      std::span<const Vertex> vertices,
+                      float threshold = defaultOverdrawThreshold,
+                      size_t cacheSize = defaultVertexCacheSize);
+void optimizeVertexFetch(std::vector<Vertex> &vertices,
+                         std::span<GLuint> indices);
+// Runs the enabled passes on the 32-bit vertices and indices of a mesh that is
+// not uploaded yet, meshes that are not triangle lists are left as they are
+MeshOptimizationStatistics optimizeMesh(Mesh &mesh,
+                                        const MeshOptimizationOptions &options);
+
+} // namespace SGEng
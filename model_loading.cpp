@@ -25,17 +25,26 @@
 //===----------------------------------------------------------------------===//
 #include "model_loading.h"
 
+#include "JobSystem.h"
 #include "Mesh.h"
 #include "Model.h"
+#include "Profiler.h"
 #include "exceptions.h"
+#include "mesh_cooking.h"
+#include "mesh_optimization.h"
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <memory>
+#include <optional>
+#include <plog/Log.h>
 #include <span>
 
 namespace SGEng {
 
-Model loadModel(const fs::path &path) {
-  Assimp::Importer importer;
+namespace {
+
+// The scene is owned by the importer
+const aiScene &importScene(Assimp::Importer &importer, const fs::path &path) {
   const aiScene *scene = importer.ReadFile(
       path.string(), aiProcess_Triangulate | aiProcess_FlipUVs);
 
@@ -44,9 +53,114 @@ Model loadModel(const fs::path &path) {
     throw ModelLoadingError("Could not load model", path,
                             importer.GetErrorString());
   }
+  return *scene;
+}
+
+// Loads a .sgmesh file directly, or the cooked file of a source model when it
+// is up to date. Other cooked files are ignored, so that the source is
+// imported and cooked again.
+std::optional<Model>
+tryLoadCookedModel(const fs::path &path,
+                   const MeshOptimizationOptions &optimizationOptions) {
+  if (path.extension() == cookedMeshExtension)
+    return loadCookedModel(path);
+
+  fs::path cookedPath = getCookedModelPath(path);
+  if (!isCookedModelCurrent(cookedPath, path, optimizationOptions))
+    return std::nullopt;
+  try {
+    return loadCookedModel(cookedPath);
+  } catch (const FileError &err) {
+    PLOGW << err.what() << " [" << err.getPath() << "]";
+  } catch (const ModelLoadingError &err) {
+    PLOGW << err.what() << " [" << err.getPath() << "]: " << err.getInfo();
+  }
+  return std::nullopt;
+}
+
+// A model that cannot be cooked is only imported again on the next load
+void tryCookModel(const Model &model, const fs::path &sourcePath,
+                  const MeshOptimizationOptions &optimizationOptions) {
+  try {
+    cookModel(model, getCookedModelPath(sourcePath), sourcePath,
+              optimizationOptions);
+  } catch (const FileError &err) {
+    PLOGW << "Could not cook model: " << err.what() << " [" << err.getPath()
+          << "]";
+  }
+}
+
+void logOptimizationStatistics(const fs::path &path,
+                               const MeshOptimizationStatistics &statistics) {
+  if (statistics.before.triangleCount == 0)
+    return;
+  PLOGI << "Model optimized [" << path << "]: ACMR "
+        << statistics.before.getACMR() << " -> " << statistics.after.getACMR()
+        << ", ATVR " << statistics.before.getATVR() << " -> "
+        << statistics.after.getATVR() << ", vertices "
+        << statistics.before.vertexCount << " -> "
+        << statistics.after.vertexCount;
+}
+
+} // namespace
+
+Model loadModel(const fs::path &path,
+                const MeshOptimizationOptions &optimizationOptions) {
+  ProfileScope profileScope("loadModel");
+  if (auto cookedModel = tryLoadCookedModel(path, optimizationOptions))
+    return std::move(*cookedModel);
+
+  Assimp::Importer importer;
+  const aiScene &scene = importScene(importer, path);
+
+  Model model;
+  loadNode(*scene.mRootNode, scene, model);
+  MeshOptimizationStatistics statistics;
+  for (auto &mesh : model.meshes) {
+    statistics += optimizeMesh(*mesh, optimizationOptions);
+    if (optimizationOptions.packVertices)
+      mesh->packVertices();
+    mesh->compactIndices();
+  }
+  logOptimizationStatistics(path, statistics);
+  tryCookModel(model, path, optimizationOptions);
+
+  return model;
+}
+
+Model loadModel(const fs::path &path, JobSystem &jobSystem,
+                const MeshOptimizationOptions &optimizationOptions) {
+  ProfileScope profileScope("loadModel");
+  if (auto cookedModel = tryLoadCookedModel(path, optimizationOptions))
+    return std::move(*cookedModel);
+
+  Assimp::Importer importer;
+  const aiScene &scene = importScene(importer, path);
+
+  std::vector<aiMesh *> rawMeshes;
+  collectMeshes(*scene.mRootNode, scene, rawMeshes);
 
+  // Conversion does not touch OpenGL, so it is safe outside of the GL thread
   Model model;
-  loadNode(*scene->mRootNode, *scene, model);
+  model.meshes.resize(rawMeshes.size());
+  std::vector<MeshOptimizationStatistics> meshStatistics(rawMeshes.size());
+  jobSystem.parallelFor(
+      0, rawMeshes.size(), 1, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++) {
+          model.meshes[i] =
+              std::make_shared<Mesh>(loadMesh(*rawMeshes[i], scene));
+          meshStatistics[i] =
+              optimizeMesh(*model.meshes[i], optimizationOptions);
+          if (optimizationOptions.packVertices)
+            model.meshes[i]->packVertices();
+          model.meshes[i]->compactIndices();
+        }
+      });
+  MeshOptimizationStatistics statistics;
+  for (const auto &entry : meshStatistics)
+    statistics += entry;
+  logOptimizationStatistics(path, statistics);
+  tryCookModel(model, path, optimizationOptions);
 
   return model;
 }
@@ -55,7 +169,7 @@ void loadNode(aiNode &node, const aiScene &scene, Model &model) {
   auto meshIds = std::span(node.mMeshes, node.mNumMeshes);
   for (auto meshId : meshIds) {
     auto rawMesh = scene.mMeshes[meshId];
-    model.meshes.push_back(loadMesh(*rawMesh, scene));
+    model.meshes.push_back(std::make_shared<Mesh>(loadMesh(*rawMesh, scene)));
   }
 
   auto childrenNodes = std::span(node.mChildren, node.mNumChildren);
@@ -64,6 +178,18 @@ void loadNode(aiNode &node, const aiScene &scene, Model &model) {
   }
 }
 
+// Gathers meshes in the same order in which loadNode() adds them to a model
+void collectMeshes(aiNode &node, const aiScene &scene,
+                   std::vector<aiMesh *> &rawMeshes) {
+  auto meshIds = std::span(node.mMeshes, node.mNumMeshes);
+  for (auto meshId : meshIds)
+    rawMeshes.push_back(scene.mMeshes[meshId]);
+
+  auto childrenNodes = std::span(node.mChildren, node.mNumChildren);
+  for (auto childNode : childrenNodes)
+    collectMeshes(*childNode, scene, rawMeshes);
+}
+
 Mesh loadMesh(aiMesh &rawMesh, const aiScene &scene) {
   Mesh mesh;
 
@@ -92,6 +218,7 @@ Mesh loadMesh(aiMesh &rawMesh, const aiScene &scene) {
                    [](auto index) { return index; });
   }
 
+  mesh.computeBounds();
   return mesh;
 }
 
@@ -25,8 +25,10 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include "mesh_optimization.h"
 #include <assimp/scene.h>
 #include <filesystem>
+#include <vector>
 
 namespace SGEng {
 
@@ -34,9 +36,19 @@ namespace fs = std::filesystem;
 
 struct Model;
 struct Mesh;
+class JobSystem;
 
-Model loadModel(const fs::path &path);
+// Loads the cooked file of the model when it is up to date, and otherwise
+// imports the model, optimizes its meshes and cooks it for the next time.
+// Paths of .sgmesh files are loaded directly.
+Model loadModel(const fs::path &path,
+                const MeshOptimizationOptions &optimizationOptions = {});
+// Converts and optimizes the meshes of an imported model in parallel
+Model loadModel(const fs::path &path, JobSystem &jobSystem,
+                const MeshOptimizationOptions &optimizationOptions = {});
 void loadNode(aiNode &node, const aiScene &scene, Model &model);
+void collectMeshes(aiNode &node, const aiScene &scene,
+                   std::vector<aiMesh *> &rawMeshes);
 Mesh loadMesh(aiMesh &rawMesh, const aiScene &scene);
 
 } // namespace SGEng
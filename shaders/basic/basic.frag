@@ -1,7 +1,9 @@
-#version 460 core
+#version 450 core
 
 in vec3 position;
 in vec3 normal;
+flat in vec3 material_color;
+flat in uint material_shininess;
 
 out vec4 fragColor;
 
@@ -9,22 +11,24 @@ struct Light {
     vec3 position;
     float strength; // light strength affects diffuse and specular light intensity
 
-    float diffuse_coefficient;
     vec3 diffuse_color;
+    float diffuse_coefficient;
 
-    float specular_coefficient;
     vec3 specular_color;
+    float specular_coefficient;
 
-    float ambient_coefficient;
     vec3 ambient_color;
+    float ambient_coefficient;
 };
 
-uniform vec3 camera_pos;
-
-uniform vec3 color;
-uniform unsigned int shininess;
-
-uniform Light light;
+// Scene state shared by all programs, must match FrameData in FrameData.h
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 camera_pos;
+    Light light;
+};
 
 
 void main() {
@@ -37,7 +41,7 @@ void main() {
     vec3 view_dir = normalize(camera_pos - position);
     vec3 halfway_dir = normalize(light_dir + view_dir);
     // Specular factor depending on the angle between view direction and reflection
-    float spec = light.strength * light.specular_coefficient * pow(max(dot(normal_, halfway_dir), 0.f), shininess);
+    float spec = light.strength * light.specular_coefficient * pow(max(dot(normal_, halfway_dir), 0.f), material_shininess);
     vec3 specular = spec * light.specular_color;
 
     // Squared distance between light position and fragment position
@@ -48,5 +52,5 @@ void main() {
 
     vec3 ambient = light.ambient_coefficient * light.ambient_color;
 
-    fragColor = vec4(color * (ambient + diffuse + specular), 1.f);
+    fragColor = vec4(material_color * (ambient + diffuse + specular), 1.f);
 }
@@ -1,16 +1,51 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 
 out vec3 position;
 out vec3 normal;
+flat out vec3 material_color;
+flat out uint material_shininess;
+
+struct Light {
+    vec3 position;
+    float strength; // light strength affects diffuse and specular light intensity
+
+    vec3 diffuse_color;
+    float diffuse_coefficient;
+
+    vec3 specular_color;
+    float specular_coefficient;
+
+    vec3 ambient_color;
+    float ambient_coefficient;
+};
+
+// Scene state shared by all programs, must match FrameData in FrameData.h
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 camera_pos;
+    Light light;
+};
 
 uniform mat4 model;
-uniform mat4 mvp;
+uniform mat3 normal_matrix; // transpose(inverse(model)), computed on the CPU
+
+uniform vec3 color;
+uniform uint shininess;
+
+// Maps packed positions to model space, the identity for float vertices
+layout (location = 0) uniform vec3 position_scale = vec3(1.f);
+layout (location = 1) uniform vec3 position_offset = vec3(0.f);
 
 void main() {
-	position = vec3(model * vec4(aPos, 1.f));
-	normal = mat3(transpose(inverse(model))) * aNormal;
-	gl_Position = mvp * vec4(aPos, 1.f);
+	vec4 world_position = model * vec4(position_offset + position_scale * aPos, 1.f);
+	position = vec3(world_position);
+	normal = normal_matrix * aNormal;
+	material_color = color;
+	material_shininess = shininess;
+	gl_Position = view_projection * world_position;
 }
@@ -0,0 +1,57 @@
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+out vec3 position;
+out vec3 normal;
+flat out vec3 material_color;
+flat out uint material_shininess;
+
+struct Instance {
+    mat4 model;
+    mat3 normal_matrix; // transpose(inverse(model)), computed on the CPU
+    vec3 color;
+    uint shininess;
+    // Maps packed positions to model space, the identity for float vertices
+    vec3 position_scale;
+    vec3 position_offset;
+};
+
+layout (std430, binding = 0) readonly buffer InstanceData {
+    Instance instances[];
+};
+
+struct Light {
+    vec3 position;
+    float strength; // light strength affects diffuse and specular light intensity
+
+    vec3 diffuse_color;
+    float diffuse_coefficient;
+
+    vec3 specular_color;
+    float specular_coefficient;
+
+    vec3 ambient_color;
+    float ambient_coefficient;
+};
+
+// Scene state shared by all programs, must match FrameData in FrameData.h
+layout (std140, binding = 0) uniform FrameData {
+    mat4 view;
+    mat4 projection;
+    mat4 view_projection;
+    vec3 camera_pos;
+    Light light;
+};
+
+void main() {
+	Instance instance = instances[gl_BaseInstanceARB + gl_InstanceID];
+	vec4 world_position = instance.model * vec4(instance.position_offset + instance.position_scale * aPos, 1.f);
+	position = vec3(world_position);
+	normal = instance.normal_matrix * aNormal;
+	material_color = instance.color;
+	material_shininess = instance.shininess;
+	gl_Position = view_projection * world_position;
+}
@@ -50,5 +50,6 @@ using uvec4gl = glm::vec<4, GLuint>;
 using mat2gl = glm::mat<2, 2, GLfloat>;
 using mat3gl = glm::mat<3, 3, GLfloat>;
 using mat4gl = glm::mat<4, 4, GLfloat>;
+using mat3x4gl = glm::mat<3, 4, GLfloat>;
 
 } // namespace SGEng
\ No newline at end of file
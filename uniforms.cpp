@@ -25,6 +25,7 @@
 //===----------------------------------------------------------------------===//
 #include "uniforms.h"
 
+#include "GLState.h"
 #include "Shader.h"
 #include <glm/gtc/type_ptr.hpp>
 
@@ -35,12 +36,16 @@ Uniform1f::Uniform1f(const Shader &shader, std::string_view name)
 
 GLfloat Uniform1f::get() const { return value; }
 
-void Uniform1f::use() const { glUniform1f(location, value); }
+void Uniform1f::use() const {
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniform1f(location, value);
+}
 
 void Uniform1f::set(GLfloat value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform1f(location, value);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform1f(location, value);
   }
 }
 
@@ -79,7 +84,8 @@ GLint Uniform1i::get() const { return value; }
 void Uniform1i::set(GLint value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform1i(location, value);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform1i(location, value);
   }
 }
 
@@ -115,12 +121,16 @@ Uniform1u::Uniform1u(const Shader &shader, std::string_view name)
 
 GLuint Uniform1u::get() const { return value; }
 
-void Uniform1u::use() const { glUniform1ui(location, value); }
+void Uniform1u::use() const {
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniform1ui(location, value);
+}
 
 void Uniform1u::set(GLuint value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform1ui(location, value);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform1ui(location, value);
   }
 }
 
@@ -156,14 +166,18 @@ Uniform2f::Uniform2f(const Shader &shader, std::string_view name)
 
 vec2gl Uniform2f::get() const { return value; }
 
-void Uniform2f::use() const { glUniform2f(location, value.x, value.y); }
+void Uniform2f::use() const {
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniform2f(location, value.x, value.y);
+}
 
 void Uniform2f::set(GLfloat value1, GLfloat value2) { set({value1, value2}); }
 
 void Uniform2f::set(vec2gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform2f(location, value.x, value.y);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform2f(location, value.x, value.y);
   }
 }
 
@@ -196,7 +210,8 @@ Uniform2f &Uniform2f::synced(const Shader &shader) {
 vec3gl Uniform3f::get() const { return value; }
 
 void Uniform3f::use() const {
-  glUniform3f(location, value.x, value.y, value.z);
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniform3f(location, value.x, value.y, value.z);
 }
 
 void Uniform3f::set(GLfloat value1, GLfloat value2, GLfloat value3) {
@@ -206,7 +221,8 @@ void Uniform3f::set(GLfloat value1, GLfloat value2, GLfloat value3) {
 void Uniform3f::set(vec3gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform3f(location, value.x, value.y, value.z);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform3f(location, value.x, value.y, value.z);
   }
 }
 
@@ -245,7 +261,8 @@ Uniform4f::Uniform4f(const Shader &shader, std::string_view name)
 vec4gl Uniform4f::get() const { return value; }
 
 void Uniform4f::use() const {
-  glUniform4f(location, value.x, value.y, value.z, value.w);
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniform4f(location, value.x, value.y, value.z, value.w);
 }
 
 void Uniform4f::set(GLfloat value1, GLfloat value2, GLfloat value3,
@@ -256,7 +273,8 @@ void Uniform4f::set(GLfloat value1, GLfloat value2, GLfloat value3,
 void Uniform4f::set(vec4gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform4f(location, value.x, value.y, value.z, value.w);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform4f(location, value.x, value.y, value.z, value.w);
   }
 }
 
@@ -297,7 +315,8 @@ void Uniform2i::set(GLint value1, GLint value2) { set({value1, value2}); }
 void Uniform2i::set(ivec2gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform2i(location, value.x, value.y);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform2i(location, value.x, value.y);
   }
 }
 
@@ -339,7 +358,8 @@ void Uniform3i::set(GLint value1, GLint value2, GLint value3) {
 void Uniform3i::set(ivec3gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform3i(location, value.x, value.y, value.z);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform3i(location, value.x, value.y, value.z);
   }
 }
 
@@ -381,7 +401,8 @@ void Uniform4i::set(GLint value1, GLint value2, GLint value3, GLint value4) {
 void Uniform4i::set(ivec4gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform4i(location, value.x, value.y, value.z, value.w);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform4i(location, value.x, value.y, value.z, value.w);
   }
 }
 
@@ -422,7 +443,8 @@ void Uniform2u::set(GLuint value1, GLuint value2) { set({value1, value2}); }
 void Uniform2u::set(uvec2gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform2ui(location, value.x, value.y);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform2ui(location, value.x, value.y);
   }
 }
 
@@ -464,7 +486,8 @@ void Uniform3u::set(GLuint value1, GLuint value2, GLuint value3) {
 void Uniform3u::set(uvec3gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform3ui(location, value.x, value.y, value.z);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform3ui(location, value.x, value.y, value.z);
   }
 }
 
@@ -507,7 +530,8 @@ void Uniform4u::set(GLuint value1, GLuint value2, GLuint value3,
 void Uniform4u::set(uvec4gl value) {
   if (isInitialized()) {
     this->value = value;
-    glUniform4ui(location, value.x, value.y, value.z, value.w);
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniform4ui(location, value.x, value.y, value.z, value.w);
   }
 }
 
@@ -549,7 +573,8 @@ void UniformMat2::set(const mat2gl &value, bool transpose) {
       this->value = glm::transpose(value);
     else
       this->value = value;
-    glUniformMatrix2fv(location, 1, transpose, glm::value_ptr(value));
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniformMatrix2fv(location, 1, transpose, glm::value_ptr(value));
   }
 }
 
@@ -580,13 +605,19 @@ UniformMat3::UniformMat3(const Shader &shader, std::string_view name)
 
 mat3gl UniformMat3::get() const { return value; }
 
+void UniformMat3::use() const {
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
 void UniformMat3::set(const mat3gl &value, bool transpose) {
   if (isInitialized()) {
     if (transpose)
       this->value = glm::transpose(value);
     else
       this->value = value;
-    glUniformMatrix3fv(location, 1, transpose, glm::value_ptr(value));
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniformMatrix3fv(location, 1, transpose, glm::value_ptr(value));
   }
 }
 
@@ -618,7 +649,8 @@ UniformMat4::UniformMat4(const Shader &shader, std::string_view name)
 mat4gl UniformMat4::get() const { return value; }
 
 void UniformMat4::use() const {
-  glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+  if (GLState::current().needsUniformUpload(location, value))
+    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
 }
 
 void UniformMat4::set(const mat4gl &value, bool transpose) {
@@ -627,7 +659,8 @@ void UniformMat4::set(const mat4gl &value, bool transpose) {
       this->value = glm::transpose(value);
     else
       this->value = value;
-    glUniformMatrix4fv(location, 1, transpose, glm::value_ptr(value));
+    if (GLState::current().needsUniformUpload(location, this->value))
+      glUniformMatrix4fv(location, 1, transpose, glm::value_ptr(value));
   }
 }
 
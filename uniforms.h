@@ -289,6 +289,7 @@ public:
   UniformMat3(const Shader &shader, std::string_view name);
 
   mat3gl get() const;
+  void use() const;
   void set(const mat3gl &value, bool transpose = false);
   UniformMat3 with(const mat3gl &value, bool transpose = false);
 
@@ -29,9 +29,34 @@
 
 namespace SGEng {
 
+// Vertex attribute of length components of the given type, packed types
+// such as GL_INT_2_10_10_10_REV hold all of them. Normalized integers are
+// converted to floats in [0, 1] or [-1, 1], integer attributes are read by
+// the shader as integers.
 struct SubDataLayout {
   size_t offset;
   size_t length;
+  GLenum type{GL_FLOAT};
+  GLboolean normalized{GL_FALSE};
+  bool isInteger{false};
+
+  size_t getSize() const {
+    switch (type) {
+    case GL_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_10F_11F_11F_REV:
+      return sizeof(GLuint);
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+      return length * sizeof(GLubyte);
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+      return length * sizeof(GLushort);
+    default:
+      return length * sizeof(GLfloat);
+    }
+  }
 };
 
 template <typename TMember, typename TObject>
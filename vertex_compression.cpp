@@ -0,0 +1,134 @@
+//===- vertex_compression.cpp -----------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#include "vertex_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/common.hpp>
+#include <limits>
+
+namespace SGEng {
+
+namespace {
+
+constexpr float maxPackedPosition{std::numeric_limits<GLushort>::max()};
+constexpr float maxPackedNormal{511.f}; // Of a signed 10-bit component
+
+GLushort packPositionComponent(float position, float offset, float scale) {
+  if (scale <= 0.f)
+    return 0;
+  float normalized = std::clamp((position - offset) / scale, 0.f, 1.f);
+  return static_cast<GLushort>(std::lround(normalized * maxPackedPosition));
+}
+
+GLuint packNormalComponent(float normal) {
+  auto component = static_cast<int32_t>(
+      std::lround(std::clamp(normal, -1.f, 1.f) * maxPackedNormal));
+  return static_cast<GLuint>(component) & 0x3ffu;
+}
+
+float unpackNormalComponent(GLuint normal, unsigned int shift) {
+  // Sign extended from 10 bits
+  auto component = static_cast<int32_t>(normal << (22 - shift)) >> 22;
+  return std::max(static_cast<float>(component) / maxPackedNormal, -1.f);
+}
+
+} // namespace
+
+PositionQuantization
+getPositionQuantization(std::span<const Vertex> vertices) {
+  PositionQuantization quantization;
+  if (vertices.empty())
+    return quantization;
+  glm::vec3 min = vertices.front().position;
+  glm::vec3 max = min;
+  for (const Vertex &vertex : vertices) {
+    min = glm::min(min, vertex.position);
+    max = glm::max(max, vertex.position);
+  }
+  quantization.scale = max - min;
+  quantization.offset = min;
+  return quantization;
+}
+
+std::vector<PackedVertex>
+packVertices(std::span<const Vertex> vertices,
+             const PositionQuantization &quantization) {
+  std::vector<PackedVertex> packedVertices;
+  packedVertices.reserve(vertices.size());
+  for (const Vertex &vertex : vertices)
+    packedVertices.push_back(packVertex(vertex, quantization));
+  return packedVertices;
+}
+
+PackedVertex packVertex(const Vertex &vertex,
+                        const PositionQuantization &quantization) {
+  PackedVertex packedVertex{};
+  for (glm::length_t i = 0; i < 3; i++)
+    packedVertex.position[static_cast<size_t>(i)] = packPositionComponent(
+        vertex.position[i], quantization.offset[i], quantization.scale[i]);
+  packedVertex.normal = packNormal(vertex.normal);
+  return packedVertex;
+}
+
+Vertex unpackVertex(const PackedVertex &vertex,
+                    const PositionQuantization &quantization) {
+  glm::vec3 normalized{vertex.position[0], vertex.position[1],
+                       vertex.position[2]};
+  return {quantization.offset +
+              quantization.scale * (normalized / maxPackedPosition),
+          unpackNormal(vertex.normal)};
+}
+
+GLuint packNormal(const glm::vec3 &normal) {
+  return packNormalComponent(normal.x) | packNormalComponent(normal.y) << 10 |
+         packNormalComponent(normal.z) << 20;
+}
+
+glm::vec3 unpackNormal(GLuint normal) {
+  return {unpackNormalComponent(normal, 0), unpackNormalComponent(normal, 10),
+          unpackNormalComponent(normal, 20)};
+}
+
+DataLayout getVertexLayout(VertexFormat format) {
+  if (format == VertexFormat::Float)
+    return {{0, memberLayout(&Vertex::position)},
+            {1, memberLayout(&Vertex::normal)}};
+  return {{0,
+           {.offset = offsetOf(&PackedVertex::position),
+            .length = 3,
+            .type = GL_UNSIGNED_SHORT,
+            .normalized = GL_TRUE,
+            .isInteger = false}},
+          {1,
+           {.offset = offsetOf(&PackedVertex::normal),
+            .length = 4,
+            .type = GL_INT_2_10_10_10_REV,
+            .normalized = GL_TRUE,
+            .isInteger = false}}};
+}
+
+} // namespace SGEng
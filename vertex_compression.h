@@ -0,0 +1,54 @@
+//===- vertex_compression.h -------------------------------------*- C++ -*-===//
+//
+// MIT License
+//
+// Copyright (c) [2022] [Krzysztof Grajda]
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include "VAO.h"
+#include "Vertex.h"
+#include <glad/gl.h>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+namespace SGEng {
+
+// Quantization spanning the bounding box of the vertices
+PositionQuantization getPositionQuantization(std::span<const Vertex> vertices);
+std::vector<PackedVertex>
+packVertices(std::span<const Vertex> vertices,
+             const PositionQuantization &quantization);
+PackedVertex packVertex(const Vertex &vertex,
+                        const PositionQuantization &quantization);
+// The vertex as the vertex fetch converts it back
+Vertex unpackVertex(const PackedVertex &vertex,
+                    const PositionQuantization &quantization);
+// Signed normalized GL_INT_2_10_10_10_REV with w = 0
+GLuint packNormal(const glm::vec3 &normal);
+glm::vec3 unpackNormal(GLuint normal);
+// Attributes of the format as the vertex shaders read them, the position at
+// location 0 and the normal at location 1
+DataLayout getVertexLayout(VertexFormat format);
+
+} // namespace SGEng